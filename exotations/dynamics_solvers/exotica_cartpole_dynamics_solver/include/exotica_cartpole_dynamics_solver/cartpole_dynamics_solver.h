@@ -30,7 +30,7 @@
 #ifndef EXOTICA_CARTPOLE_DYNAMICS_SOLVER_CARTPOLE_DYNAMICS_SOLVER_H_
 #define EXOTICA_CARTPOLE_DYNAMICS_SOLVER_CARTPOLE_DYNAMICS_SOLVER_H_
 
-#include <exotica_core/dynamics_solver.h>
+#include <exotica_core/autodiff_dynamics_solver.h>
 #include <exotica_core/scene.h>
 
 #include <exotica_cartpole_dynamics_solver/cartpole_dynamics_solver_initializer.h>
@@ -40,32 +40,40 @@ namespace exotica
 /// StateVector X ∈ R^4 = [x, theta, x_dot, theta_dot]
 /// Refer to http://underactuated.mit.edu/underactuated.html?chapter=acrobot
 ///     for a derivation of the cartpole dynamics.
-class CartpoleDynamicsSolver : public DynamicsSolver, public Instantiable<CartpoleDynamicsSolverInitializer>
+/// The derivatives are obtained by automatic differentiation of Dynamics.
+class CartpoleDynamicsSolver : public AutoDiffDynamicsSolver<CartpoleDynamicsSolver, 4, 1>, public Instantiable<CartpoleDynamicsSolverInitializer>
 {
 public:
     CartpoleDynamicsSolver();
     void AssignScene(ScenePtr scene_in) override;
 
-    /// \brief Computes the forward dynamics of the system.
+    /// \brief Computes the forward dynamics of the system for any scalar type, e.g. for automatic differentiation.
     /// @param x The state vector.
     /// @param u The control input.
     /// @return The dynamics transition function.
-    StateVector f(const StateVector& x, const ControlVector& u) override;
+    template <typename T>
+    Eigen::Matrix<T, 4, 1> Dynamics(const Eigen::Matrix<T, 4, 1>& x, const Eigen::Matrix<T, 1, 1>& u) const
+    {
+        using std::cos;
+        using std::sin;
 
-    /// \brief Computes the dynamics derivative w.r.t .the state x.
-    /// @param x The state vector.
-    /// @param u The control input.
-    /// @return The derivative of the dynamics function w.r.t. x evaluated at (x, u).
-    Eigen::MatrixXd fx(const StateVector& x, const ControlVector& u) override;
-    /// \brief Computes the dynamics derivative w.r.t .the control input u.
-    /// @param x The state vector.
-    /// @param u The control input
-    /// @return The derivative of the dynamics function w.r.t. u evaluated at (x, u).
-    Eigen::MatrixXd fu(const StateVector& x, const ControlVector& u) override;
+        const T theta = x(1);
+        const T xdot = x(2);
+        const T thetadot = x(3);
+
+        const T sin_theta = sin(theta);
+        const T cos_theta = cos(theta);
+        const T theta_dot_squared = thetadot * thetadot;
 
-    // NOTE: fuu is always zero, so we don't override it
-    Eigen::Tensor<double, 3> fxx(const StateVector& x, const ControlVector& u) override;
-    Eigen::Tensor<double, 3> fxu(const StateVector& x, const ControlVector& u) override;
+        Eigen::Matrix<T, 4, 1> x_dot;
+        x_dot << xdot, thetadot,
+            (u(0) + m_p_ * sin_theta * (l_ * theta_dot_squared + g_ * cos_theta)) /
+                (m_c_ + m_p_ * sin_theta * sin_theta),
+            -(l_ * m_p_ * cos_theta * sin_theta * theta_dot_squared + u(0) * cos_theta +
+              (m_c_ + m_p_) * g_ * sin_theta) /
+                (l_ * m_c_ + l_ * m_p_ * sin_theta * sin_theta);
+        return x_dot;
+    }
 
 private:
     Eigen::Matrix3d M;      ///!< Inertia (mass) matrix
@@ -92,6 +92,16 @@ class TestCartpoleDiff(unittest.TestCase):
             fu_solver = self.dynamics_solver.fu(x, u)
             nptest.assert_allclose(fu_fd, fu_solver, err_msg="Derivative w.r.t. controls test failed")
 
+    def test_fused_derivatives(self):
+        np.random.seed(42)
+        for i in range(100):
+            x = np.random.uniform(size=(1, 4))[0]
+            u = np.array([np.random.uniform()])
+            self.dynamics_solver.compute_derivatives(x, u)
+            nptest.assert_allclose(self.dynamics_solver.get_state_derivative(), TestCartpoleDiff.dynamics(x, u), err_msg="Fused dynamics test failed")
+            nptest.assert_allclose(self.dynamics_solver.get_fx(), self.dynamics_solver.fx(x, u), err_msg="Fused derivative w.r.t. state test failed")
+            nptest.assert_allclose(self.dynamics_solver.get_fu(), self.dynamics_solver.fu(x, u), err_msg="Fused derivative w.r.t. controls test failed")
+
 
 if __name__ == '__main__':
     unittest.main()
\ No newline at end of file
@@ -65,6 +65,10 @@ public:
     ControlDerivative fu(const StateVector& x, const ControlVector& u) override;
     ControlVector InverseDynamics(const StateVector& x) override;
 
+protected:
+    /// \brief Computes f, fx and fu from a single call to pinocchio::computeABADerivatives.
+    void ComputeDerivativesInternal(const StateVector& x, const ControlVector& u, StateVector& xdot, StateDerivative& fx_out, ControlDerivative& fu_out) override;
+
 private:
     pinocchio::Model model_;
     std::unique_ptr<pinocchio::Data> pinocchio_data_;
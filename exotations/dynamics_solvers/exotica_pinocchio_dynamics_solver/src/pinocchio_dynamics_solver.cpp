@@ -72,32 +72,36 @@ Eigen::VectorXd PinocchioDynamicsSolver::f(const StateVector& x, const ControlVe
 
 Eigen::MatrixXd PinocchioDynamicsSolver::fx(const StateVector& x, const ControlVector& u)
 {
-    const int NQ = num_positions_;
-    const int NV = num_velocities_;
-    const int NX = NQ + NV;
-
-    pinocchio::computeABADerivatives(model_, *pinocchio_data_, x.head(num_positions_).eval(), x.tail(num_velocities_).eval(), u.eval());
-
-    Eigen::MatrixXd fx_symb = Eigen::MatrixXd::Zero(NX, NX);
-    fx_symb.topRightCorner(NV, NV) = Eigen::MatrixXd::Identity(NV, NV);
-    fx_symb.bottomLeftCorner(NQ, NV) = pinocchio_data_->ddq_dq;
-
-    return fx_symb;
+    ComputeDerivatives(x, u);
+    return get_fx();
 }
 
 Eigen::MatrixXd PinocchioDynamicsSolver::fu(const StateVector& x, const ControlVector& u)
+{
+    ComputeDerivatives(x, u);
+    return get_fu();
+}
+
+void PinocchioDynamicsSolver::ComputeDerivativesInternal(const StateVector& x, const ControlVector& u, StateVector& xdot, StateDerivative& fx_out, ControlDerivative& fu_out)
 {
     const int NQ = num_positions_;
     const int NV = num_velocities_;
     const int NX = NQ + NV;
     const int NU = num_controls_;
 
+    // Also computes the forward dynamics (ddq) and the inverse of the joint space inertia matrix (Minv).
     pinocchio::computeABADerivatives(model_, *pinocchio_data_, x.head(num_positions_).eval(), x.tail(num_velocities_).eval(), u.eval());
 
-    Eigen::MatrixXd fu_symb = Eigen::MatrixXd::Zero(NX, NU);
-    fu_symb.bottomRightCorner(NV, NU) = pinocchio_data_->Minv;
+    xdot.resize(NX);
+    xdot.head(NQ) = x.tail(NQ);
+    xdot.tail(NV) = pinocchio_data_->ddq;
+
+    fx_out.setZero(NX, NX);
+    fx_out.topRightCorner(NV, NV).setIdentity();
+    fx_out.bottomLeftCorner(NQ, NV) = pinocchio_data_->ddq_dq;
 
-    return fu_symb;
+    fu_out.setZero(NX, NU);
+    fu_out.bottomRightCorner(NV, NU) = pinocchio_data_->Minv;
 }
 
 Eigen::VectorXd PinocchioDynamicsSolver::InverseDynamics(const StateVector& x)
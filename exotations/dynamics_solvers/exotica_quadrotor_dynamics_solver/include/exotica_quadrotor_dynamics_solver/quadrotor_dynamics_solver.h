@@ -30,7 +30,7 @@
 #ifndef EXOTICA_QUADROTOR_DYNAMICS_SOLVER_QUADROTOR_DYNAMICS_SOLVER_H_
 #define EXOTICA_QUADROTOR_DYNAMICS_SOLVER_QUADROTOR_DYNAMICS_SOLVER_H_
 
-#include <exotica_core/dynamics_solver.h>
+#include <exotica_core/autodiff_dynamics_solver.h>
 #include <exotica_core/scene.h>
 
 #include <exotica_quadrotor_dynamics_solver/quadrotor_dynamics_solver_initializer.h>
@@ -44,16 +44,17 @@ namespace exotica
 /// Cf. https://journals.sagepub.com/doi/abs/10.1177/0278364911434236
 ///
 /// StateVector X ∈ R^12 = [x, y, z, r, p, y, xdot, ydot, zdot, omega1, omega2, omega3]
-class QuadrotorDynamicsSolver : public DynamicsSolver, public Instantiable<QuadrotorDynamicsSolverInitializer>
+/// The derivatives are obtained by automatic differentiation of Dynamics.
+class QuadrotorDynamicsSolver : public AutoDiffDynamicsSolver<QuadrotorDynamicsSolver, 12, 4>, public Instantiable<QuadrotorDynamicsSolverInitializer>
 {
 public:
     QuadrotorDynamicsSolver();
 
     void AssignScene(ScenePtr scene_in) override;
 
-    StateVector f(const StateVector& x, const ControlVector& u) override;
-    Eigen::MatrixXd fx(const StateVector& x, const ControlVector& u) override;
-    Eigen::MatrixXd fu(const StateVector& x, const ControlVector& u) override;
+    /// \brief Computes the forward dynamics of the system for any scalar type, e.g. for automatic differentiation.
+    template <typename T>
+    Eigen::Matrix<T, 12, 1> Dynamics(const Eigen::Matrix<T, 12, 1>& x, const Eigen::Matrix<T, 4, 1>& u) const;
 
     // Eigen::VectorXd GetPosition(Eigen::VectorXdRefConst x_in) override;
 
@@ -75,6 +76,75 @@ private:
 
     // double b_ = 0.0245;  ///< Drag
 };
+
+template <typename T>
+Eigen::Matrix<T, 12, 1> QuadrotorDynamicsSolver::Dynamics(const Eigen::Matrix<T, 12, 1>& x, const Eigen::Matrix<T, 4, 1>& u) const
+{
+    using std::cos;
+    using std::sin;
+
+    const T phi = x(3),
+            theta = x(4),
+            psi = x(5),
+            x_dot = x(6),
+            y_dot = x(7),
+            z_dot = x(8),
+            phi_dot = x(9),
+            theta_dot = x(10),
+            psi_dot = x(11);
+
+    const T F_1 = k_f_ * u(0);
+    const T F_2 = k_f_ * u(1);
+    const T F_3 = k_f_ * u(2);
+    const T F_4 = k_f_ * u(3);
+
+    const T M_1 = k_m_ * u(0);
+    const T M_2 = k_m_ * u(1);
+    const T M_3 = k_m_ * u(2);
+    const T M_4 = k_m_ * u(3);
+
+    // clang-format off
+    const T sin_phi = sin(phi),     cos_phi = cos(phi),
+            sin_theta = sin(theta), cos_theta = cos(theta),
+            sin_psi = sin(psi),     cos_psi = cos(psi);
+    // clang-format on
+
+    const T zero(0), one(1);
+    Eigen::Matrix<T, 3, 3> Rx, Ry, Rz;
+    Rx << one, zero, zero, zero, cos_phi, -sin_phi, zero, sin_phi, cos_phi;
+    Ry << cos_theta, zero, sin_theta, zero, one, zero, -sin_theta, zero, cos_theta;
+    Rz << cos_psi, -sin_psi, zero, sin_psi, cos_psi, zero, zero, zero, one;
+    const Eigen::Matrix<T, 3, 3> R = Rz * Rx * Ry;
+
+    // x,y,z dynamics
+    Eigen::Matrix<T, 3, 1> Ftot;
+    Ftot << zero, zero, (F_1 + F_2 + F_3 + F_4) / mass_;
+
+    const Eigen::Matrix<T, 3, 1> pos_ddot = R * Ftot - Eigen::Matrix<T, 3, 1>(zero, zero, T(g_));
+
+    // phi, theta, psi dynamics
+    Eigen::Matrix<T, 3, 1> tau, omega, I_omega;
+    tau << L_ * (F_1 - F_2),
+        L_ * (F_1 - F_3),
+        (M_1 - M_2 + M_3 - M_4);
+    omega << phi_dot, theta_dot, psi_dot;
+
+    const double radius = L_ / 2.0;
+    const double Ix = 2 * mass_ * (radius * radius) / 5.0 + 2 * radius * radius * mass_,
+                 Iy = 2 * mass_ * (radius * radius) / 5.0 + 2 * radius * radius * mass_,
+                 Iz = 2 * mass_ * (radius * radius) / 5.0 + 4 * radius * radius * mass_;
+
+    I_omega << Ix * phi_dot, Iy * theta_dot, Iz * psi_dot;
+    const Eigen::Matrix<T, 3, 1> moment = tau - omega.cross(I_omega);
+
+    Eigen::Matrix<T, 12, 1> state_dot;
+    state_dot << x_dot, y_dot, z_dot,
+        phi_dot, theta_dot, psi_dot,
+        pos_ddot(0), pos_ddot(1), pos_ddot(2),
+        moment(0) / Ix, moment(1) / Iy, moment(2) / Iz;
+
+    return state_dot;
+}
 }  // namespace exotica
 
 #endif  // EXOTICA_QUADROTOR_DYNAMICS_SOLVER_QUADROTOR_DYNAMICS_SOLVER_H_
@@ -64,6 +64,7 @@ public:
         CollisionSceneFCLLatest* scene;
         std::vector<CollisionProxy> proxies;
         double Distance = 1e300;
+        double check_margin = 0.0;  ///< Only pairs with bounding volumes closer than this are evaluated by the margin-based queries.
         bool self = true;
     };
 
@@ -74,6 +75,7 @@ public:
     static bool IsAllowedToCollide(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, bool self, CollisionSceneFCLLatest* scene);
     static bool CollisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data);
     static bool CollisionCallbackDistance(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data, double& dist);
+    static bool RobotToWorldDistanceCallback(fcl::CollisionObjectd* world_object, fcl::CollisionObjectd* robot_object, void* data, double& dist);
 
     /// \brief Check if the whole robot is valid (collision only).
     /// @param self Indicate if self collision check is required.
@@ -103,6 +105,16 @@ public:
     /// @return     ContinuousCollisionProxy.
     ContinuousCollisionProxy ContinuousCollisionCheck(const std::string& o1, const KDL::Frame& tf1_beg, const KDL::Frame& tf1_end, const std::string& o2, const KDL::Frame& tf2_beg, const KDL::Frame& tf2_end) override;
 
+    /// @brief      Performs a continuous collision check along a joint space trajectory.
+    ///             The link transforms of all waypoints are computed in one pass through the kinematic tree and
+    ///             pairs are culled using the bounding volumes swept along each segment. World objects are assumed static.
+    /// @param[in]  trajectory  Joint space trajectory, one configuration of the controlled joints per row (T x nq).
+    /// @param[in]  self        Indicate if self collision check is required.
+    /// @return     Vector of T-1 ContinuousCollisionProxy holding the earliest contact along each segment.
+    std::vector<ContinuousCollisionProxy> ContinuousCollisionCheckTrajectory(Eigen::MatrixXdRefConst trajectory, bool self = true) override;
+
+    void SetACM(const AllowedCollisionMatrix& acm) override;
+
     /// @brief      Gets the collision world links.
     /// @return     The collision world links.
     std::vector<std::string> GetCollisionWorldLinks() override;
@@ -122,13 +134,41 @@ public:
 
 private:
     std::shared_ptr<fcl::BroadPhaseCollisionManagerd> broad_phase_collision_manager_;
+    std::shared_ptr<fcl::BroadPhaseCollisionManagerd> world_broad_phase_collision_manager_;  ///< Holds only the world objects, used to query robot objects against the environment.
+
+    /// \brief Rebuilds the list of robot object pairs that are allowed to collide with each other.
+    void UpdateRobotToRobotPairs();
+
+    /// \brief Integer description of a collision object used to filter pairs without locking kinematic elements.
+    struct CollisionFilter
+    {
+        bool is_robot;
+        int parent;              ///< Id of the parent element.
+        int closest_robot_link;  ///< Id of the closest robot link, -1 if there is none.
+        int robot_link;          ///< Index into robot_link_names_, -1 for world objects.
+        int acm_link;            ///< Index into acm_link_names_, -1 if the ACM does not refer to the robot link.
+    };
+
+    /// \brief Compiles the ACM into acm_allowed_ for the robot links the ACM refers to and assigns their acm_link ids.
+    /// Links the ACM does not refer to are allowed to collide with every link and get no row.
+    void UpdateAllowedCollisionMatrix();
 
-    std::shared_ptr<fcl::CollisionObjectd> ConstructFclCollisionObject(long i, std::shared_ptr<KinematicElement> element);
+    /// \brief Describes the geometry constructed for an element by content, an empty key means the geometry is not cached.
+    std::vector<double> GetGeometryKey(std::shared_ptr<KinematicElement> element) const;
+    std::shared_ptr<fcl::CollisionGeometryd> ConstructFclCollisionGeometry(std::shared_ptr<KinematicElement> element);
     static void CheckCollision(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, CollisionData* data);
     static void ComputeDistance(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, DistanceData* data);
 
+    /// \brief Collects the world objects overlapping the swept volume, data points to a std::vector<fcl::CollisionObjectd*>.
+    static bool SweptVolumeCallback(fcl::CollisionObjectd* world_object, fcl::CollisionObjectd* swept_volume, void* data);
+    static fcl::ContinuousCollisionRequestd CreateContinuousCollisionRequest(bool primitives);
+    static void ContinuousCollide(fcl::CollisionObjectd* shape1, const fcl::Transform3d& tf1_beg_fcl, const fcl::Transform3d& tf1_end_fcl,
+                                  fcl::CollisionObjectd* shape2, const fcl::Transform3d& tf2_beg_fcl, const fcl::Transform3d& tf2_end_fcl,
+                                  const fcl::ContinuousCollisionRequestd& request, ContinuousCollisionProxy& ret);
+
     std::vector<fcl::CollisionObjectd*> fcl_objects_;
-    std::vector<std::shared_ptr<fcl::CollisionObjectd>> fcl_cache_;  // to avoid shared_ptr from going stale, to be refactored
+    std::map<std::string, std::shared_ptr<fcl::CollisionObjectd>> fcl_object_cache_;                 ///< Owns the collision objects, by frame name.
+    std::map<std::vector<double>, std::shared_ptr<fcl::CollisionGeometryd>> fcl_geometry_cache_;  ///< Geometries used by the current objects, see GetGeometryKey.
     std::vector<std::weak_ptr<KinematicElement>> kinematic_elements_;
     std::map<std::string, std::weak_ptr<KinematicElement>> kinematic_elements_map_;
 
@@ -137,6 +177,14 @@ private:
     std::map<std::string, std::vector<fcl::CollisionObjectd*>> fcl_robot_objects_map_;
     std::map<std::string, std::vector<fcl::CollisionObjectd*>> fcl_world_objects_map_;
 
+    std::vector<CollisionFilter> collision_filters_;  ///< Indexed by collision object id, i.e. the same as kinematic_elements_.
+    std::vector<std::string> robot_link_names_;       ///< Names of the robot links of the collision objects.
+    std::vector<std::string> acm_link_names_;         ///< Robot link names the ACM refers to.
+    std::vector<bool> acm_allowed_;                   ///< Dense row-major acm_link_names_ x acm_link_names_ matrix compiled from acm_.
+
+    std::vector<std::pair<fcl::CollisionObjectd*, fcl::CollisionObjectd*>> robot_to_robot_pairs_;  ///< Robot object pairs passing the ACM, each unordered pair once, rebuilt lazily.
+    bool robot_to_robot_pairs_need_update_ = true;
+
     std::shared_ptr<KinematicElement> GetKinematicElementFromMapByName(const std::string& frame_name)
     {
         auto it = kinematic_elements_map_.find(frame_name);
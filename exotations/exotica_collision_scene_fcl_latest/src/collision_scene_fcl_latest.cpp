@@ -29,6 +29,7 @@
 
 #include <exotica_collision_scene_fcl_latest/collision_scene_fcl_latest.h>
 #include <exotica_core/factory.h>
+#include <exotica_core/scene.h>
 
 REGISTER_COLLISION_SCENE_TYPE("CollisionSceneFCLLatest", exotica::CollisionSceneFCLLatest)
 
@@ -54,11 +55,29 @@ inline bool IsRobotLink(std::shared_ptr<KinematicElement> e)
     return e->is_robot_link || e->closest_robot_link.lock();
 }
 
+// Conservative bounding box of the volume swept by an object under the screw motion between two poses.
+// The object lies within its bounding sphere (centre c, radius r) at all times, and the centre travels along
+// a helix of length L <= |dc| * (1 + theta / (2 * sin(theta / 2))), so it stays within L / 2 of c_beg or c_end.
+// Pure translations sweep the union of the boxes at both poses.
+inline fcl::AABBd SweptAABB(const fcl::CollisionObjectd* o, const fcl::Transform3d& tf_beg, const fcl::Transform3d& tf_end, const fcl::AABBd& aabb_beg, const fcl::AABBd& aabb_end)
+{
+    const double theta = Eigen::AngleAxisd(tf_end.linear() * tf_beg.linear().transpose()).angle();
+    if (theta < 1e-9) return aabb_beg + aabb_end;
+
+    const fcl::CollisionGeometryd& geometry = *o->collisionGeometry();
+    const Eigen::Vector3d c_beg = tf_beg * geometry.aabb_center;
+    const Eigen::Vector3d c_end = tf_end * geometry.aabb_center;
+    const double path_length = (c_end - c_beg).norm() * (1.0 + theta / (2.0 * std::sin(theta / 2.0)));
+    const Eigen::Vector3d margin = Eigen::Vector3d::Constant(geometry.aabb_radius + 0.5 * path_length);
+    return fcl::AABBd(c_beg - margin, c_beg + margin) + fcl::AABBd(c_end - margin, c_end + margin);
+}
+
 void CollisionSceneFCLLatest::Setup()
 {
     if (debug_) HIGHLIGHT_NAMED("CollisionSceneFCLLatest", "FCL version: " << FCL_VERSION);
 
     broad_phase_collision_manager_.reset(new fcl::DynamicAABBTreeCollisionManagerd());
+    world_broad_phase_collision_manager_.reset(new fcl::DynamicAABBTreeCollisionManagerd());
 }
 
 void CollisionSceneFCLLatest::UpdateCollisionObjects(const std::map<std::string, std::weak_ptr<KinematicElement>>& objects)
@@ -68,8 +87,14 @@ void CollisionSceneFCLLatest::UpdateCollisionObjects(const std::map<std::string,
     kinematic_elements_.clear();
     kinematic_elements_.reserve(objects.size());
 
-    fcl_cache_.clear();
-    fcl_cache_.reserve(objects.size());
+    // Objects and geometries of the previous update are reused where possible; whatever is left in previous_objects afterwards was removed from the scene
+    std::map<std::string, std::shared_ptr<fcl::CollisionObjectd>> previous_objects;
+    previous_objects.swap(fcl_object_cache_);
+    std::map<std::vector<double>, std::shared_ptr<fcl::CollisionGeometryd>> previous_geometries;
+    previous_geometries.swap(fcl_geometry_cache_);
+    std::unordered_set<fcl::CollisionObjectd*> previous_world_objects;
+    for (const auto& it : fcl_world_objects_map_) previous_world_objects.insert(it.second.begin(), it.second.end());
+    std::vector<fcl::CollisionObjectd*> added_objects;
 
     fcl_objects_.clear();
     fcl_objects_.reserve(objects.size());
@@ -78,6 +103,17 @@ void CollisionSceneFCLLatest::UpdateCollisionObjects(const std::map<std::string,
     fcl_robot_objects_map_.clear();
     fcl_world_objects_map_.clear();
 
+    collision_filters_.clear();
+    collision_filters_.reserve(objects.size());
+    robot_link_names_.clear();
+
+    // Integer ids of parent elements, closest robot links and robot link names
+    std::unordered_map<const KinematicElement*, int> element_ids;
+    std::unordered_map<std::string, int> robot_link_ids;
+    auto get_element_id = [&element_ids](const std::shared_ptr<KinematicElement>& e) {
+        return element_ids.emplace(e.get(), static_cast<int>(element_ids.size())).first->second;
+    };
+
     long i = 0;
 
     for (const auto& object : objects)
@@ -89,17 +125,65 @@ void CollisionSceneFCLLatest::UpdateCollisionObjects(const std::map<std::string,
         }
         else
         {
-            if (debug_) HIGHLIGHT_NAMED("CollisionSceneFCLLatest::UpdateCollisionObject", "Creating " << object.first);
+            std::shared_ptr<KinematicElement> element = object.second.lock();
+
+            // Look up the geometry by content so that e.g. attaching or re-adding an object does not rebuild its BVH
+            const std::vector<double> key = GetGeometryKey(element);
+            std::shared_ptr<fcl::CollisionGeometryd> geometry;
+            if (!key.empty())
+            {
+                auto it = fcl_geometry_cache_.find(key);
+                if (it != fcl_geometry_cache_.end())
+                {
+                    geometry = it->second;
+                }
+                else
+                {
+                    it = previous_geometries.find(key);
+                    if (it != previous_geometries.end()) geometry = it->second;
+                }
+            }
+            if (!geometry) geometry = ConstructFclCollisionGeometry(element);
+            if (!key.empty()) fcl_geometry_cache_.emplace(key, geometry);
 
-            std::shared_ptr<fcl::CollisionObjectd> new_object = ConstructFclCollisionObject(i, object.second.lock());
+            std::shared_ptr<fcl::CollisionObjectd> new_object;
+            auto previous = previous_objects.find(object.first);
+            if (previous != previous_objects.end() && previous->second->collisionGeometry() == geometry)
+            {
+                new_object = previous->second;
+                previous_objects.erase(previous);
+            }
+            else
+            {
+                if (debug_) HIGHLIGHT_NAMED("CollisionSceneFCLLatest::UpdateCollisionObject", "Creating " << object.first);
+                new_object.reset(new fcl::CollisionObjectd(geometry));
+                added_objects.emplace_back(new_object.get());
+            }
+            new_object->setUserData(reinterpret_cast<void*>(i));
 
-            fcl_cache_.emplace_back(new_object);
+            fcl_object_cache_[object.first] = new_object;
             fcl_objects_.emplace_back(new_object.get());
             kinematic_elements_.emplace_back(object.second);
 
+            std::shared_ptr<KinematicElement> closest_robot_link = element->closest_robot_link.lock();
+            CollisionFilter filter;
+            filter.is_robot = IsRobotLink(element);
+            filter.parent = get_element_id(element->parent.lock());
+            filter.closest_robot_link = closest_robot_link ? get_element_id(closest_robot_link) : -1;
+            filter.robot_link = -1;
+            filter.acm_link = -1;
+            if (filter.is_robot)
+            {
+                const std::string& name = closest_robot_link ? closest_robot_link->segment.getName() : element->parent.lock()->segment.getName();
+                auto it = robot_link_ids.emplace(name, static_cast<int>(robot_link_names_.size()));
+                if (it.second) robot_link_names_.push_back(name);
+                filter.robot_link = it.first->second;
+            }
+            collision_filters_.emplace_back(filter);
+
             fcl_objects_map_[object.first].emplace_back(new_object.get());
             // Check whether this is a robot or environment link:
-            if (IsRobotLink(object.second.lock()))
+            if (filter.is_robot)
             {
                 fcl_robot_objects_map_[object.first].emplace_back(new_object.get());
             }
@@ -112,9 +196,82 @@ void CollisionSceneFCLLatest::UpdateCollisionObjects(const std::map<std::string,
         }
     }
 
-    // Register objects with the BroadPhaseCollisionManager
-    broad_phase_collision_manager_->clear();
-    broad_phase_collision_manager_->registerObjects(fcl_objects_);
+    // Register new objects with the BroadPhaseCollisionManager and remove the ones that are gone
+    for (const auto& it : previous_objects) broad_phase_collision_manager_->unregisterObject(it.second.get());
+    for (fcl::CollisionObjectd* o : added_objects) broad_phase_collision_manager_->registerObject(o);
+
+    // World objects are also kept in a separate manager so robot objects can be queried against the environment only.
+    // Objects can move between robot and world, e.g. when they get attached.
+    for (const auto& it : fcl_world_objects_map_)
+    {
+        for (fcl::CollisionObjectd* o : it.second)
+        {
+            if (previous_world_objects.erase(o) == 0) world_broad_phase_collision_manager_->registerObject(o);
+        }
+    }
+    for (fcl::CollisionObjectd* o : previous_world_objects) world_broad_phase_collision_manager_->unregisterObject(o);
+
+    UpdateAllowedCollisionMatrix();
+    robot_to_robot_pairs_need_update_ = true;
+}
+
+void CollisionSceneFCLLatest::SetACM(const AllowedCollisionMatrix& acm)
+{
+    CollisionScene::SetACM(acm);
+    UpdateAllowedCollisionMatrix();
+    robot_to_robot_pairs_need_update_ = true;
+}
+
+void CollisionSceneFCLLatest::UpdateAllowedCollisionMatrix()
+{
+    // A link is referred to if it has an entry or is disabled in the entry of another link
+    std::vector<std::string> entry_names;
+    acm_.getAllEntryNames(entry_names);
+    std::vector<int> acm_link_ids(robot_link_names_.size(), -1);
+    acm_link_names_.clear();
+    for (std::size_t i = 0; i < robot_link_names_.size(); ++i)
+    {
+        const std::string& name = robot_link_names_[i];
+        bool referred = false;
+        for (const std::string& entry_name : entry_names)
+        {
+            if (entry_name == name || !acm_.getAllowedCollision(entry_name, name))
+            {
+                referred = true;
+                break;
+            }
+        }
+        if (!referred) continue;
+        acm_link_ids[i] = static_cast<int>(acm_link_names_.size());
+        acm_link_names_.push_back(name);
+    }
+    for (CollisionFilter& filter : collision_filters_)
+        filter.acm_link = filter.robot_link == -1 ? -1 : acm_link_ids[filter.robot_link];
+
+    const std::size_t n = acm_link_names_.size();
+    acm_allowed_.assign(n * n, true);
+    for (std::size_t i = 0; i < n; ++i)
+        for (std::size_t j = 0; j < n; ++j)
+            acm_allowed_[i * n + j] = acm_.getAllowedCollision(acm_link_names_[i], acm_link_names_[j]);
+}
+
+void CollisionSceneFCLLatest::UpdateRobotToRobotPairs()
+{
+    robot_to_robot_pairs_.clear();
+    // Each unordered pair is stored once, objects of the same name share a parent and never collide
+    for (auto it1 = fcl_robot_objects_map_.begin(); it1 != fcl_robot_objects_map_.end(); ++it1)
+    {
+        for (auto it2 = std::next(it1); it2 != fcl_robot_objects_map_.end(); ++it2)
+        {
+            if (IsAllowedToCollide(it1->first, it2->first, true))
+            {
+                for (fcl::CollisionObjectd* o1 : it1->second)
+                    for (fcl::CollisionObjectd* o2 : it2->second)
+                        robot_to_robot_pairs_.emplace_back(o1, o2);
+            }
+        }
+    }
+    robot_to_robot_pairs_need_update_ = false;
 }
 
 void CollisionSceneFCLLatest::UpdateCollisionObjectTransforms()
@@ -133,12 +290,73 @@ void CollisionSceneFCLLatest::UpdateCollisionObjectTransforms()
         collision_object->setTransform(fcl_convert::KDL2fcl(element->frame));
         collision_object->computeAABB();
     }
+
+    // Refit the broad phase trees to the updated bounding volumes
+    broad_phase_collision_manager_->update();
+    world_broad_phase_collision_manager_->update();
+}
+
+std::vector<double> CollisionSceneFCLLatest::GetGeometryKey(std::shared_ptr<KinematicElement> element) const
+{
+    const shapes::Shape* shape = element->shape.get();
+    const bool is_robot = IsRobotLink(element);
+
+    // Everything ConstructFclCollisionGeometry depends on, followed by the shape parameters
+    std::vector<double> key = {static_cast<double>(shape->type),
+                               is_robot ? robot_link_scale_ : world_link_scale_,
+                               is_robot ? robot_link_padding_ : world_link_padding_,
+                               static_cast<double>(replace_primitive_shapes_with_meshes_),
+                               static_cast<double>(replace_cylinders_with_capsules)};
+    switch (shape->type)
+    {
+        case shapes::PLANE:
+        {
+            auto p = static_cast<const shapes::Plane*>(shape);
+            key.insert(key.end(), {p->a, p->b, p->c, p->d});
+        }
+        break;
+        case shapes::SPHERE:
+            key.push_back(static_cast<const shapes::Sphere*>(shape)->radius);
+            break;
+        case shapes::BOX:
+        {
+            const double* size = static_cast<const shapes::Box*>(shape)->size;
+            key.insert(key.end(), size, size + 3);
+        }
+        break;
+        case shapes::CYLINDER:
+        {
+            auto s = static_cast<const shapes::Cylinder*>(shape);
+            key.insert(key.end(), {s->radius, s->length});
+        }
+        break;
+        case shapes::CONE:
+        {
+            auto s = static_cast<const shapes::Cone*>(shape);
+            key.insert(key.end(), {s->radius, s->length});
+        }
+        break;
+        case shapes::MESH:
+        {
+            auto mesh = static_cast<const shapes::Mesh*>(shape);
+            key.reserve(key.size() + 2 + 3 * mesh->vertex_count + 3 * mesh->triangle_count);
+            key.push_back(mesh->vertex_count);
+            key.push_back(mesh->triangle_count);
+            key.insert(key.end(), mesh->vertices, mesh->vertices + 3 * mesh->vertex_count);
+            key.insert(key.end(), mesh->triangles, mesh->triangles + 3 * mesh->triangle_count);
+        }
+        break;
+        default:
+            // Octrees and unsupported shapes are not cached
+            return std::vector<double>();
+    }
+    return key;
 }
 
 // This function was originally copied from 'moveit_core/collision_detection_fcl/src/collision_common.cpp'
 // https://github.com/ros-planning/moveit/blob/kinetic-devel/moveit_core/collision_detection_fcl/src/collision_common.cpp#L520
 // and then modified for use in EXOTica.
-std::shared_ptr<fcl::CollisionObjectd> CollisionSceneFCLLatest::ConstructFclCollisionObject(long kinematic_element_id, std::shared_ptr<KinematicElement> element)
+std::shared_ptr<fcl::CollisionGeometryd> CollisionSceneFCLLatest::ConstructFclCollisionGeometry(std::shared_ptr<KinematicElement> element)
 {
     shapes::ShapePtr shape(element->shape->clone());
 
@@ -241,11 +459,7 @@ std::shared_ptr<fcl::CollisionObjectd> CollisionSceneFCLLatest::ConstructFclColl
             ThrowPretty("This shape type (" << ((int)shape->type) << ") is not supported using FCL yet");
     }
     geometry->computeLocalAABB();
-    geometry->setUserData(reinterpret_cast<void*>(kinematic_element_id));
-    std::shared_ptr<fcl::CollisionObjectd> ret(new fcl::CollisionObjectd(geometry));
-    ret->setUserData(reinterpret_cast<void*>(kinematic_element_id));
-
-    return ret;
+    return geometry;
 }
 
 bool CollisionSceneFCLLatest::IsAllowedToCollide(const std::string& o1, const std::string& o2, const bool& self)
@@ -275,25 +489,23 @@ bool CollisionSceneFCLLatest::IsAllowedToCollide(const std::string& o1, const st
 
 bool CollisionSceneFCLLatest::IsAllowedToCollide(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, bool self, CollisionSceneFCLLatest* scene)
 {
-    std::shared_ptr<KinematicElement> e1 = scene->kinematic_elements_[reinterpret_cast<long>(o1->getUserData())].lock();
-    std::shared_ptr<KinematicElement> e2 = scene->kinematic_elements_[reinterpret_cast<long>(o2->getUserData())].lock();
+    const CollisionFilter& f1 = scene->collision_filters_[reinterpret_cast<long>(o1->getUserData())];
+    const CollisionFilter& f2 = scene->collision_filters_[reinterpret_cast<long>(o2->getUserData())];
 
-    bool isRobot1 = IsRobotLink(e1);
-    bool isRobot2 = IsRobotLink(e2);
     // Don't check collisions between world objects
-    if (!isRobot1 && !isRobot2) return false;
+    if (!f1.is_robot && !f2.is_robot) return false;
     // Skip self collisions if requested
-    if (isRobot1 && isRobot2 && !self) return false;
+    if (f1.is_robot && f2.is_robot && !self) return false;
     // Skip collisions between shapes within the same objects
-    if (e1->parent.lock() == e2->parent.lock()) return false;
+    if (f1.parent == f2.parent) return false;
     // Skip collisions between bodies attached to the same object
-    if (e1->closest_robot_link.lock() && e2->closest_robot_link.lock() && e1->closest_robot_link.lock() == e2->closest_robot_link.lock()) return false;
+    if (f1.closest_robot_link != -1 && f1.closest_robot_link == f2.closest_robot_link) return false;
 
-    if (isRobot1 && isRobot2)
+    if (f1.is_robot && f2.is_robot)
     {
-        const std::string& name1 = e1->closest_robot_link.lock() ? e1->closest_robot_link.lock()->segment.getName() : e1->parent.lock()->segment.getName();
-        const std::string& name2 = e2->closest_robot_link.lock() ? e2->closest_robot_link.lock()->segment.getName() : e2->parent.lock()->segment.getName();
-        return scene->acm_.getAllowedCollision(name1, name2);
+        // Links the ACM does not refer to are allowed to collide with any link
+        if (f1.acm_link == -1 || f2.acm_link == -1) return true;
+        return scene->acm_allowed_[f1.acm_link * scene->acm_link_names_.size() + f2.acm_link];
     }
     return true;
 }
@@ -518,6 +730,18 @@ bool CollisionSceneFCLLatest::CollisionCallbackDistance(fcl::CollisionObjectd* o
     return false;
 }
 
+bool CollisionSceneFCLLatest::RobotToWorldDistanceCallback(fcl::CollisionObjectd* world_object, fcl::CollisionObjectd* robot_object, void* data, double& dist)
+{
+    DistanceData* data_ = reinterpret_cast<DistanceData*>(data);
+
+    // Only descend into bounding volumes within the check margin for the remainder of the traversal
+    dist = data_->check_margin;
+    if (robot_object->getAABB().distance(world_object->getAABB()) >= data_->check_margin) return false;
+    if (!IsAllowedToCollide(robot_object, world_object, false, data_->scene)) return false;
+    ComputeDistance(robot_object, world_object, data_);
+    return false;
+}
+
 bool CollisionSceneFCLLatest::IsStateValid(bool self, double safe_distance)
 {
     if (!always_externally_updated_collision_scene_) UpdateCollisionObjectTransforms();
@@ -665,28 +889,27 @@ std::vector<CollisionProxy> CollisionSceneFCLLatest::GetCollisionDistance(const
 
 std::vector<CollisionProxy> CollisionSceneFCLLatest::GetRobotToRobotCollisionDistance(double check_margin)
 {
+    if (robot_to_robot_pairs_need_update_) UpdateRobotToRobotPairs();
+
     DistanceData data(this);
     data.self = true;
 
-    // For each robot collision object to each robot collision object
-    for (auto it1 : fcl_robot_objects_map_)
+    for (const auto& pair : robot_to_robot_pairs_)
     {
-        for (auto it2 : fcl_robot_objects_map_)
+        // Check whether the AABB is less than the check_margin, if so, perform a collision distance call
+        if (pair.first->getAABB().distance(pair.second->getAABB()) < check_margin)
         {
-            if (IsAllowedToCollide(it1.first, it2.first, true))
+            const std::size_t num_proxies = data.proxies.size();
+            ComputeDistance(pair.first, pair.second, &data);
+
+            // Pairs are stored once, but the query reports every pair in both orders
+            if (data.proxies.size() > num_proxies)
             {
-                // Both it1.second and it2.second are vectors of collision objects, so we need to iterate through each:
-                for (auto o1 : it1.second)
-                {
-                    for (auto o2 : it2.second)
-                    {
-                        // Check whether the AABB is less than the check_margin, if so, perform a collision distance call
-                        if (o1->getAABB().distance(o2->getAABB()) < check_margin)
-                        {
-                            ComputeDistance(o1, o2, &data);
-                        }
-                    }
-                }
+                CollisionProxy mirrored = data.proxies.back();
+                std::swap(mirrored.e1, mirrored.e2);
+                std::swap(mirrored.contact1, mirrored.contact2);
+                std::swap(mirrored.normal1, mirrored.normal2);
+                data.proxies.push_back(mirrored);
             }
         }
     }
@@ -697,27 +920,14 @@ std::vector<CollisionProxy> CollisionSceneFCLLatest::GetRobotToWorldCollisionDis
 {
     DistanceData data(this);
     data.self = false;
+    data.check_margin = check_margin;
 
-    // For each robot collision object to each robot collision object
-    for (auto it1 : fcl_robot_objects_map_)
+    // Query each robot collision object against the world broad phase
+    for (const auto& it : fcl_robot_objects_map_)
     {
-        for (auto it2 : fcl_world_objects_map_)
+        for (fcl::CollisionObjectd* o : it.second)
         {
-            if (IsAllowedToCollide(it1.first, it2.first, false))
-            {
-                // Both it1.second and it2.second are vectors of collision objects, so we need to iterate through each:
-                for (auto o1 : it1.second)
-                {
-                    for (auto o2 : it2.second)
-                    {
-                        // Check whether the AABB is less than the check_margin, if so, perform a collision distance call
-                        if (o1->getAABB().distance(o2->getAABB()) < check_margin)
-                        {
-                            ComputeDistance(o1, o2, &data);
-                        }
-                    }
-                }
-            }
+            world_broad_phase_collision_manager_->distance(o, &data, &CollisionSceneFCLLatest::RobotToWorldDistanceCallback);
         }
     }
     return data.proxies;
@@ -831,6 +1041,140 @@ ContinuousCollisionProxy CollisionSceneFCLLatest::ContinuousCollisionCheck(
     //     HIGHLIGHT("Yeah, no motion here.");
     // }
 
+    const bool primitives = shape1->getObjectType() == fcl::OBJECT_TYPE::OT_GEOM && shape2->getObjectType() == fcl::OBJECT_TYPE::OT_GEOM;
+    ContinuousCollide(shape1, tf1_beg_fcl, tf1_end_fcl, shape2, tf2_beg_fcl, tf2_end_fcl, CreateContinuousCollisionRequest(primitives), ret);
+    return ret;
+}
+
+bool CollisionSceneFCLLatest::SweptVolumeCallback(fcl::CollisionObjectd* world_object, fcl::CollisionObjectd* /* swept_volume */, void* data)
+{
+    reinterpret_cast<std::vector<fcl::CollisionObjectd*>*>(data)->push_back(world_object);
+    return false;
+}
+
+std::vector<ContinuousCollisionProxy> CollisionSceneFCLLatest::ContinuousCollisionCheckTrajectory(Eigen::MatrixXdRefConst trajectory, bool self)
+{
+    std::shared_ptr<Scene> scene = scene_.lock();
+    if (!scene) ThrowPretty("The collision scene has not been assigned to a scene.");
+    KinematicTree& kinematica = scene->GetKinematicTree();
+    if (trajectory.cols() != kinematica.GetNumControlledJoints()) ThrowPretty("Wrong trajectory size! Got " << trajectory.cols() << " columns, expected " << kinematica.GetNumControlledJoints());
+    if (trajectory.rows() < 2) ThrowPretty("The trajectory needs at least two waypoints, got " << trajectory.rows());
+
+    if (!always_externally_updated_collision_scene_) UpdateCollisionObjectTransforms();
+    if (robot_to_robot_pairs_need_update_) UpdateRobotToRobotPairs();
+
+    // Only the robot objects move along the trajectory, the world objects keep their current poses
+    std::vector<fcl::CollisionObjectd*> robot_objects;
+    std::vector<std::shared_ptr<KinematicElement>> robot_elements;
+    std::vector<int> robot_object_index(collision_filters_.size(), -1);
+    for (fcl::CollisionObjectd* o : fcl_objects_)
+    {
+        const long id = reinterpret_cast<long>(o->getUserData());
+        if (!collision_filters_[id].is_robot) continue;
+        robot_object_index[id] = robot_objects.size();
+        robot_objects.push_back(o);
+        robot_elements.push_back(kinematic_elements_[id].lock());
+    }
+
+    // Poses and bounding volumes of the robot objects at every waypoint, stored waypoint-major
+    const int num_waypoints = trajectory.rows();
+    const int num_robot_objects = robot_objects.size();
+    std::vector<fcl::Transform3d, Eigen::aligned_allocator<fcl::Transform3d>> transforms(num_waypoints * num_robot_objects);
+    std::vector<fcl::AABBd> aabbs(num_waypoints * num_robot_objects);
+
+    // Keep the current poses so that the collision objects can be restored afterwards
+    std::vector<fcl::Transform3d, Eigen::aligned_allocator<fcl::Transform3d>> current_transforms(num_robot_objects);
+    for (int i = 0; i < num_robot_objects; ++i) current_transforms[i] = robot_objects[i]->getTransform();
+
+    const Eigen::VectorXd x_current = kinematica.GetControlledState();
+    for (int t = 0; t < num_waypoints; ++t)
+    {
+        kinematica.Update(trajectory.row(t).transpose());
+        for (int i = 0; i < num_robot_objects; ++i)
+        {
+            robot_objects[i]->setTransform(fcl_convert::KDL2fcl(robot_elements[i]->frame));
+            robot_objects[i]->computeAABB();
+            transforms[t * num_robot_objects + i] = robot_objects[i]->getTransform();
+            aabbs[t * num_robot_objects + i] = robot_objects[i]->getAABB();
+        }
+    }
+    kinematica.Update(x_current);
+
+    // The broad phase managers were not refitted, so restoring the poses leaves them consistent
+    for (int i = 0; i < num_robot_objects; ++i)
+    {
+        robot_objects[i]->setTransform(current_transforms[i]);
+        robot_objects[i]->computeAABB();
+    }
+
+    // Axis-aligned box used to query the world broad phase with the swept volume of a robot object
+    std::shared_ptr<fcl::Boxd> swept_box = std::make_shared<fcl::Boxd>(1.0, 1.0, 1.0);
+    fcl::CollisionObjectd swept_volume(swept_box);
+
+    // The requests only depend on the geometry types, so both variants are created once
+    const fcl::ContinuousCollisionRequestd primitive_request = CreateContinuousCollisionRequest(true);
+    const fcl::ContinuousCollisionRequestd request = CreateContinuousCollisionRequest(false);
+
+    std::vector<ContinuousCollisionProxy> proxies(num_waypoints - 1);
+    std::vector<fcl::CollisionObjectd*> world_candidates;
+    std::vector<fcl::AABBd> swept_aabbs(num_robot_objects);
+    for (int t = 0; t < num_waypoints - 1; ++t)
+    {
+        const int beg = t * num_robot_objects;
+        const int end = (t + 1) * num_robot_objects;
+        ContinuousCollisionProxy& earliest = proxies[t];
+
+        // Rotating objects sweep outside the boxes at the two waypoints, see SweptAABB
+        for (int i = 0; i < num_robot_objects; ++i)
+            swept_aabbs[i] = SweptAABB(robot_objects[i], transforms[beg + i], transforms[end + i], aabbs[beg + i], aabbs[end + i]);
+        earliest.time_of_contact = 1.0;
+
+        auto sweep = [&](fcl::CollisionObjectd* o1, const fcl::Transform3d& tf1_beg, const fcl::Transform3d& tf1_end,
+                         fcl::CollisionObjectd* o2, const fcl::Transform3d& tf2_beg, const fcl::Transform3d& tf2_end) {
+            const bool primitives = o1->getObjectType() == fcl::OBJECT_TYPE::OT_GEOM && o2->getObjectType() == fcl::OBJECT_TYPE::OT_GEOM;
+            ContinuousCollisionProxy proxy;
+            ContinuousCollide(o1, tf1_beg, tf1_end, o2, tf2_beg, tf2_end, primitives ? primitive_request : request, proxy);
+            if (proxy.in_collision && (!earliest.in_collision || proxy.time_of_contact < earliest.time_of_contact))
+            {
+                proxy.e1 = kinematic_elements_[reinterpret_cast<long>(o1->getUserData())].lock();
+                proxy.e2 = kinematic_elements_[reinterpret_cast<long>(o2->getUserData())].lock();
+                earliest = proxy;
+            }
+        };
+
+        if (self)
+        {
+            for (const auto& pair : robot_to_robot_pairs_)
+            {
+                const int i = robot_object_index[reinterpret_cast<long>(pair.first->getUserData())];
+                const int j = robot_object_index[reinterpret_cast<long>(pair.second->getUserData())];
+                if (!swept_aabbs[i].overlap(swept_aabbs[j])) continue;
+                sweep(pair.first, transforms[beg + i], transforms[end + i], pair.second, transforms[beg + j], transforms[end + j]);
+            }
+        }
+
+        for (int i = 0; i < num_robot_objects; ++i)
+        {
+            const fcl::AABBd& swept = swept_aabbs[i];
+            swept_box->side = swept.max_ - swept.min_;
+            swept_box->computeLocalAABB();
+            swept_volume.setTranslation(swept.center());
+            swept_volume.computeAABB();
+
+            world_candidates.clear();
+            world_broad_phase_collision_manager_->collide(&swept_volume, &world_candidates, &CollisionSceneFCLLatest::SweptVolumeCallback);
+            for (fcl::CollisionObjectd* world_object : world_candidates)
+            {
+                if (!IsAllowedToCollide(robot_objects[i], world_object, false, this)) continue;
+                sweep(robot_objects[i], transforms[beg + i], transforms[end + i], world_object, world_object->getTransform(), world_object->getTransform());
+            }
+        }
+    }
+    return proxies;
+}
+
+fcl::ContinuousCollisionRequestd CollisionSceneFCLLatest::CreateContinuousCollisionRequest(bool primitives)
+{
     fcl::ContinuousCollisionRequestd request = fcl::ContinuousCollisionRequestd();
 
 #ifdef CONTINUOUS_COLLISION_USE_ADVANCED_SETTINGS
@@ -849,12 +1193,21 @@ ContinuousCollisionProxy CollisionSceneFCLLatest::ContinuousCollisionCheck(
     request.ccd_solver_type = fcl::CCDC_NAIVE;
 
     // If both are primitives, let's use conservative advancement
-    if (shape1->getObjectType() == fcl::OBJECT_TYPE::OT_GEOM && shape2->getObjectType() == fcl::OBJECT_TYPE::OT_GEOM)
+    if (primitives)
     {
         request.ccd_solver_type = fcl::CCDC_CONSERVATIVE_ADVANCEMENT;
     }
+#else
+    (void)primitives;
 #endif
 
+    return request;
+}
+
+void CollisionSceneFCLLatest::ContinuousCollide(fcl::CollisionObjectd* shape1, const fcl::Transform3d& tf1_beg_fcl, const fcl::Transform3d& tf1_end_fcl,
+                                                fcl::CollisionObjectd* shape2, const fcl::Transform3d& tf2_beg_fcl, const fcl::Transform3d& tf2_end_fcl,
+                                                const fcl::ContinuousCollisionRequestd& request, ContinuousCollisionProxy& ret)
+{
     fcl::ContinuousCollisionResultd result;
     double time_of_contact = fcl::continuousCollide(
         shape1->collisionGeometry().get(), tf1_beg_fcl, tf1_end_fcl,
@@ -964,7 +1317,5 @@ ContinuousCollisionProxy CollisionSceneFCLLatest::ContinuousCollisionCheck(
         ThrowPretty("Contact position is not finite!");
     }
 #endif
-
-    return ret;
 }
 }  // namespace exotica
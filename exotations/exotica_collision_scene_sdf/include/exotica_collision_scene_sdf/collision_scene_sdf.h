@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2020, University of Edinburgh, University of Oxford
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef EXOTICA_COLLISION_SCENE_SDF_COLLISION_SCENE_SDF_H_
+#define EXOTICA_COLLISION_SCENE_SDF_COLLISION_SCENE_SDF_H_
+
+#include <exotica_collision_scene_sdf/signed_distance_field.h>
+#include <exotica_core/collision_scene.h>
+
+namespace exotica
+{
+/// \brief Collision scene answering robot-to-world queries from a signed distance field of the world.
+///     The world objects are voxelised once and the field is only recomputed when world objects are
+///     added, removed or moved. Robot links are approximated by capsules (swept spheres) which enclose
+///     their collision shapes, and robot-to-robot distances are computed between these capsules.
+///     Distances to the world are accurate to about a voxel; a proxy is returned per robot link
+///     against the closest world object rather than per pair of shapes.
+class CollisionSceneSDF : public CollisionScene
+{
+public:
+    bool IsAllowedToCollide(const std::string& o1, const std::string& o2, const bool& self) override;
+
+    /// \brief Check if the whole robot is valid (collision only).
+    /// @param self Indicate if self collision check is required.
+    /// @return True, if the state is collision free.
+    bool IsStateValid(bool self = true, double safe_distance = 0.0) override;
+
+    /// \brief Computes collision distances.
+    /// \param self Indicate if self collision check is required.
+    /// \return Collision proximity objects for all robot links, against the world and, if requested, against each other.
+    std::vector<CollisionProxy> GetCollisionDistance(bool self) override;
+    std::vector<CollisionProxy> GetCollisionDistance(const std::string& o1, const bool& self = true) override;
+    std::vector<CollisionProxy> GetCollisionDistance(const std::string& o1, const bool& self, const bool& disable_collision_scene_update) override;
+    std::vector<CollisionProxy> GetCollisionDistance(const std::vector<std::string>& objects, const bool& self = true) override;
+
+    std::vector<CollisionProxy> GetRobotToRobotCollisionDistance(double check_margin) override;
+    std::vector<CollisionProxy> GetRobotToWorldCollisionDistance(double check_margin) override;
+
+    void SetACM(const AllowedCollisionMatrix& acm) override;
+
+    /// @brief      Gets the collision world links.
+    /// @return     The collision world links.
+    std::vector<std::string> GetCollisionWorldLinks() override;
+
+    /// @brief      Gets the collision robot links.
+    /// @return     The collision robot links.
+    std::vector<std::string> GetCollisionRobotLinks() override;
+
+    Eigen::Vector3d GetTranslation(const std::string& name) override;
+
+    /// \brief Creates the collision scene from kinematic elements.
+    /// \param objects Vector kinematic element pointers of collision objects.
+    void UpdateCollisionObjects(const std::map<std::string, std::weak_ptr<KinematicElement>>& objects) override;
+
+    /// \brief Updates collision object transformations from the kinematic tree and recomputes the field if the world has moved.
+    void UpdateCollisionObjectTransforms() override;
+
+    double GetVoxelSize() const { return voxel_size_; }
+    void SetVoxelSize(const double voxel_size);
+
+    /// \brief Distance by which the field extends beyond the world objects.
+    double GetFieldMargin() const { return field_margin_; }
+    void SetFieldMargin(const double margin);
+
+    const SignedDistanceField& GetSignedDistanceField() const { return field_; }
+
+private:
+    /// \brief Segment swept by a sphere, in the frame of a robot link.
+    struct Capsule
+    {
+        Eigen::Vector3d a;
+        Eigen::Vector3d b;
+        double radius;
+        int num_samples;          ///< Number of points at which the field is evaluated along the segment
+        Eigen::Vector3d world_a;  ///< Segment in the world frame, see UpdateCollisionObjectTransforms
+        Eigen::Vector3d world_b;
+    };
+
+    bool IsAllowedToCollide(const std::shared_ptr<KinematicElement>& e1, const std::shared_ptr<KinematicElement>& e2, bool self) const;
+    std::vector<Capsule> ConstructCapsules(std::shared_ptr<KinematicElement> element) const;
+    void UpdateNumSamples();
+    void UpdateSignedDistanceField();
+    void UpdateSelfCollisionPairs();
+
+    /// \brief Distance between the robot element with index i and the world, returns false if there is no world.
+    bool ComputeWorldDistance(int i, CollisionProxy& proxy) const;
+    /// \brief Distance between the robot elements with indices i and j.
+    CollisionProxy ComputeSelfDistance(int i, int j) const;
+    std::vector<int> GetRobotElementsByName(const std::string& name) const;
+
+    SignedDistanceField field_;
+    double voxel_size_ = 0.02;
+    double field_margin_ = 0.5;
+    bool field_needs_update_ = true;
+    bool self_collision_pairs_need_update_ = true;
+
+    std::map<std::string, std::weak_ptr<KinematicElement>> kinematic_elements_map_;
+    std::vector<std::weak_ptr<KinematicElement>> robot_elements_;
+    std::vector<std::vector<Capsule>> capsules_;                    ///< Capsules enclosing each robot element
+    std::vector<std::pair<std::string, std::string>> robot_names_;  ///< Frame and parent name of each robot element
+    std::vector<std::pair<int, int>> self_collision_pairs_;         ///< Robot elements that are allowed to collide with each other
+
+    std::vector<std::weak_ptr<KinematicElement>> world_elements_;  ///< Indexed by the object ids of the field
+    std::vector<KDL::Frame> world_frames_;                         ///< Frames of the world elements when the field was computed
+    std::vector<std::string> world_links_;
+};
+}  // namespace exotica
+
+#endif  // EXOTICA_COLLISION_SCENE_SDF_COLLISION_SCENE_SDF_H_
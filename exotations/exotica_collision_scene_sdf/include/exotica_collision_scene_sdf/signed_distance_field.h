@@ -0,0 +1,86 @@
+//
+// Copyright (c) 2020, University of Edinburgh, University of Oxford
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef EXOTICA_COLLISION_SCENE_SDF_SIGNED_DISTANCE_FIELD_H_
+#define EXOTICA_COLLISION_SCENE_SDF_SIGNED_DISTANCE_FIELD_H_
+
+#include <functional>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+namespace exotica
+{
+/// \brief Voxelised signed distance field of a set of static objects.
+///     Objects are rasterised into an occupancy grid which is converted into exact Euclidean
+///     distances between voxel centres. Queries interpolate trilinearly between voxel centres
+///     and take constant time.
+class SignedDistanceField
+{
+public:
+    /// \brief Allocates an empty field covering bounds with cubic voxels.
+    void Initialize(const Eigen::AlignedBox3d& bounds, double voxel_size);
+
+    /// \brief Marks all voxels within bounds whose centres are contained in the object as occupied by it.
+    /// @param owner Non-negative id of the object, returned by GetClosestObject.
+    void AddObject(const Eigen::AlignedBox3d& bounds, int owner, const std::function<bool(const Eigen::Vector3d&)>& contains);
+
+    /// \brief Computes the distances from the occupancy, to be called once all objects were added.
+    void Compute();
+
+    /// \brief Signed distance to the closest object, negative inside objects.
+    ///     Outside the field, the distance to the boundary of the field is added to the boundary value.
+    /// @param[out] gradient Gradient of the distance, i.e. pointing away from the closest object.
+    double GetDistance(const Eigen::Vector3d& p, Eigen::Vector3d& gradient) const;
+    double GetDistance(const Eigen::Vector3d& p) const;
+
+    /// \brief Id of the object closest to p, -1 if the field is empty.
+    int GetClosestObject(const Eigen::Vector3d& p) const;
+
+    bool IsEmpty() const { return empty_; }
+    double GetVoxelSize() const { return voxel_size_; }
+    const Eigen::Vector3i& GetSize() const { return size_; }
+
+private:
+    std::size_t GetIndex(int x, int y, int z) const { return (static_cast<std::size_t>(z) * size_(1) + y) * size_(0) + x; }
+    Eigen::Vector3i GetClosestVoxel(const Eigen::Vector3d& p) const;
+
+    Eigen::Vector3d origin_ = Eigen::Vector3d::Zero();  ///< Centre of the first voxel
+    Eigen::Vector3i size_ = Eigen::Vector3i::Zero();    ///< Number of voxels along each axis
+    double voxel_size_ = 1.0;
+    bool empty_ = true;
+
+    std::vector<int> occupancy_;       ///< Object occupying the voxel, -1 if free
+    std::vector<int> closest_object_;  ///< Object of the closest occupied voxel
+    std::vector<double> distance_;     ///< Signed distance at the voxel centres
+};
+}  // namespace exotica
+
+#endif  // EXOTICA_COLLISION_SCENE_SDF_SIGNED_DISTANCE_FIELD_H_
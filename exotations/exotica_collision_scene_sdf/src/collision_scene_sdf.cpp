@@ -0,0 +1,580 @@
+//
+// Copyright (c) 2020, University of Edinburgh, University of Oxford
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <exotica_collision_scene_sdf/collision_scene_sdf.h>
+#include <exotica_core/factory.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <eigen_conversions/eigen_kdl.h>
+#include <geometric_shapes/bodies.h>
+#include <geometric_shapes/shape_operations.h>
+
+REGISTER_COLLISION_SCENE_TYPE("CollisionSceneSDF", exotica::CollisionSceneSDF)
+
+namespace exotica
+{
+namespace
+{
+inline bool IsRobotLink(std::shared_ptr<KinematicElement> e)
+{
+    return e->is_robot_link || e->closest_robot_link.lock();
+}
+
+// Closest points between the segments p1-q1 and p2-q2 (Ericson, Real-Time Collision Detection, Section 5.1.9)
+void ClosestPointsOnSegments(const Eigen::Vector3d& p1, const Eigen::Vector3d& q1, const Eigen::Vector3d& p2, const Eigen::Vector3d& q2, Eigen::Vector3d& c1, Eigen::Vector3d& c2)
+{
+    constexpr double eps = 1e-12;
+    const Eigen::Vector3d d1 = q1 - p1;
+    const Eigen::Vector3d d2 = q2 - p2;
+    const Eigen::Vector3d r = p1 - p2;
+    const double a = d1.squaredNorm();
+    const double e = d2.squaredNorm();
+    const double f = d2.dot(r);
+    double s = 0.0;
+    double t = 0.0;
+    if (a > eps && e <= eps)
+    {
+        s = std::min(std::max(-d1.dot(r) / a, 0.0), 1.0);
+    }
+    else if (a <= eps && e > eps)
+    {
+        t = std::min(std::max(f / e, 0.0), 1.0);
+    }
+    else if (a > eps && e > eps)
+    {
+        const double b = d1.dot(d2);
+        const double c = d1.dot(r);
+        const double denominator = a * e - b * b;
+        if (denominator > eps) s = std::min(std::max((b * f - c * e) / denominator, 0.0), 1.0);
+        t = (b * s + f) / e;
+        if (t < 0.0)
+        {
+            t = 0.0;
+            s = std::min(std::max(-c / a, 0.0), 1.0);
+        }
+        else if (t > 1.0)
+        {
+            t = 1.0;
+            s = std::min(std::max((b - c) / a, 0.0), 1.0);
+        }
+    }
+    c1 = p1 + s * d1;
+    c2 = p2 + t * d2;
+}
+
+// Capsule along the axis of a box centred at centre, split into slabs so that the capsules stay close to flat boxes
+void AddBoxCapsules(const Eigen::Vector3d& centre, const Eigen::Vector3d& size, std::vector<Eigen::Vector3d>& a, std::vector<Eigen::Vector3d>& b, std::vector<double>& radius)
+{
+    int axis[3] = {0, 1, 2};
+    std::sort(axis, axis + 3, [&size](int i, int j) { return size(i) > size(j); });
+    const int num_slabs = std::max(1, static_cast<int>(std::ceil(size(axis[1]) / std::max(size(axis[2]), 1e-6))));
+    const double slab_width = size(axis[1]) / num_slabs;
+    for (int i = 0; i < num_slabs; ++i)
+    {
+        Eigen::Vector3d slab_centre = centre;
+        slab_centre(axis[1]) += -0.5 * size(axis[1]) + (i + 0.5) * slab_width;
+        Eigen::Vector3d half_axis = Eigen::Vector3d::Zero();
+        half_axis(axis[0]) = 0.5 * size(axis[0]);
+        a.push_back(slab_centre - half_axis);
+        b.push_back(slab_centre + half_axis);
+        radius.push_back(0.5 * std::sqrt(slab_width * slab_width + size(axis[2]) * size(axis[2])));
+    }
+}
+}  // namespace
+
+void CollisionSceneSDF::SetVoxelSize(const double voxel_size)
+{
+    if (voxel_size <= 0.0) ThrowPretty("The voxel size needs to be positive, got " << voxel_size);
+    voxel_size_ = voxel_size;
+    UpdateNumSamples();
+    field_needs_update_ = true;
+}
+
+void CollisionSceneSDF::SetFieldMargin(const double margin)
+{
+    if (margin < 0.0) ThrowPretty("The field margin needs to be greater than or equal to 0, got " << margin);
+    field_margin_ = margin;
+    field_needs_update_ = true;
+}
+
+void CollisionSceneSDF::SetACM(const AllowedCollisionMatrix& acm)
+{
+    CollisionScene::SetACM(acm);
+    self_collision_pairs_need_update_ = true;
+}
+
+void CollisionSceneSDF::UpdateCollisionObjects(const std::map<std::string, std::weak_ptr<KinematicElement>>& objects)
+{
+    kinematic_elements_map_ = objects;
+
+    std::vector<std::weak_ptr<KinematicElement>> world_elements;
+    robot_elements_.clear();
+    capsules_.clear();
+    robot_names_.clear();
+    world_links_.clear();
+
+    for (const auto& object : objects)
+    {
+        // Check whether object is excluded as a world collision object:
+        if (world_links_to_exclude_from_collision_scene.count(object.first) > 0)
+        {
+            if (debug_) HIGHLIGHT_NAMED("CollisionSceneSDF::UpdateCollisionObject", object.first << " is excluded, skipping.");
+            continue;
+        }
+
+        std::shared_ptr<KinematicElement> element = object.second.lock();
+        if (IsRobotLink(element))
+        {
+            robot_elements_.emplace_back(element);
+            capsules_.emplace_back(ConstructCapsules(element));
+            robot_names_.emplace_back(element->segment.getName(), element->parent.lock()->segment.getName());
+        }
+        else
+        {
+            world_elements.emplace_back(element);
+            world_links_.emplace_back(object.first);
+        }
+    }
+
+    // Only recompute the field if the world objects have changed
+    bool world_changed = world_elements.size() != world_elements_.size();
+    for (std::size_t i = 0; !world_changed && i < world_elements.size(); ++i)
+    {
+        std::shared_ptr<KinematicElement> previous = world_elements_[i].lock();
+        world_changed = !previous || previous != world_elements[i].lock() || previous->shape != world_elements[i].lock()->shape;
+    }
+    world_elements_ = world_elements;
+    if (world_changed) field_needs_update_ = true;
+    self_collision_pairs_need_update_ = true;
+}
+
+void CollisionSceneSDF::UpdateCollisionObjectTransforms()
+{
+    for (std::size_t i = 0; i < robot_elements_.size(); ++i)
+    {
+        std::shared_ptr<KinematicElement> element = robot_elements_[i].lock();
+        if (!element) ThrowPretty("Expired pointer, this should not happen - make sure to call UpdateCollisionObjects() after UpdateSceneFrames()");
+        Eigen::Isometry3d pose;
+        tf::transformKDLToEigen(element->frame, pose);
+        for (Capsule& capsule : capsules_[i])
+        {
+            capsule.world_a = pose * capsule.a;
+            capsule.world_b = pose * capsule.b;
+        }
+    }
+
+    // The world is assumed to be static, the field is recomputed when world objects move
+    for (std::size_t i = 0; !field_needs_update_ && i < world_elements_.size(); ++i)
+    {
+        std::shared_ptr<KinematicElement> element = world_elements_[i].lock();
+        if (!element || !KDL::Equal(element->frame, world_frames_[i], 1e-9)) field_needs_update_ = true;
+    }
+    if (field_needs_update_) UpdateSignedDistanceField();
+}
+
+void CollisionSceneSDF::UpdateSignedDistanceField()
+{
+    Timer timer;
+    std::vector<std::unique_ptr<bodies::Body>> world_bodies(world_elements_.size());
+    std::vector<Eigen::AlignedBox3d> world_bounds(world_elements_.size());
+    world_frames_.resize(world_elements_.size());
+    Eigen::AlignedBox3d bounds;
+    for (std::size_t i = 0; i < world_elements_.size(); ++i)
+    {
+        std::shared_ptr<KinematicElement> element = world_elements_[i].lock();
+        if (!element) ThrowPretty("Expired pointer, this should not happen - make sure to call UpdateCollisionObjects() after UpdateSceneFrames()");
+        world_frames_[i] = element->frame;
+
+        world_bodies[i].reset(bodies::createBodyFromShape(element->shape.get()));
+        if (!world_bodies[i])
+        {
+            WARNING_NAMED("CollisionSceneSDF", "Shape type " << element->shape->type << " of '" << element->segment.getName() << "' can not be voxelised, ignoring it.");
+            continue;
+        }
+        if (world_link_scale_ != 1.0 || world_link_padding_ > 0.0)
+        {
+            world_bodies[i]->setScale(world_link_scale_);
+            world_bodies[i]->setPadding(world_link_padding_);
+        }
+        Eigen::Isometry3d pose;
+        tf::transformKDLToEigen(element->frame, pose);
+        world_bodies[i]->setPose(pose);
+
+        bodies::BoundingSphere sphere;
+        world_bodies[i]->computeBoundingSphere(sphere);
+        world_bounds[i] = Eigen::AlignedBox3d((sphere.center.array() - sphere.radius).matrix(), (sphere.center.array() + sphere.radius).matrix());
+        bounds.extend(world_bounds[i]);
+    }
+
+    field_ = SignedDistanceField();
+    if (!bounds.isEmpty())
+    {
+        field_.Initialize(Eigen::AlignedBox3d((bounds.min().array() - field_margin_).matrix(), (bounds.max().array() + field_margin_).matrix()), voxel_size_);
+        for (std::size_t i = 0; i < world_bodies.size(); ++i)
+        {
+            if (!world_bodies[i]) continue;
+            const bodies::Body* body = world_bodies[i].get();
+            field_.AddObject(world_bounds[i], static_cast<int>(i), [body](const Eigen::Vector3d& p) { return body->containsPoint(p); });
+        }
+        field_.Compute();
+    }
+    field_needs_update_ = false;
+
+    if (debug_) HIGHLIGHT_NAMED("CollisionSceneSDF", "Computed a field of " << field_.GetSize().transpose() << " voxels for " << world_elements_.size() << " world objects in " << timer.GetDuration() << "s");
+}
+
+std::vector<CollisionSceneSDF::Capsule> CollisionSceneSDF::ConstructCapsules(std::shared_ptr<KinematicElement> element) const
+{
+    shapes::ShapePtr shape(element->shape->clone());
+    if (robot_link_scale_ != 1.0 || robot_link_padding_ > 0.0)
+    {
+        shape->scaleAndPadd(robot_link_scale_, robot_link_padding_);
+    }
+
+    std::vector<Eigen::Vector3d> a, b;
+    std::vector<double> radius;
+    switch (shape->type)
+    {
+        case shapes::SPHERE:
+        {
+            a.emplace_back(Eigen::Vector3d::Zero());
+            b.emplace_back(Eigen::Vector3d::Zero());
+            radius.push_back(static_cast<const shapes::Sphere*>(shape.get())->radius);
+        }
+        break;
+        case shapes::CYLINDER:
+        {
+            auto s = static_cast<const shapes::Cylinder*>(shape.get());
+            // Capsules replacing cylinders have the same overall length, otherwise the capsule encloses the cylinder
+            const double half_length = (replace_cylinders_with_capsules && s->length > 2 * s->radius) ? 0.5 * s->length - s->radius : 0.5 * s->length;
+            a.emplace_back(0.0, 0.0, -half_length);
+            b.emplace_back(0.0, 0.0, half_length);
+            radius.push_back(s->radius);
+        }
+        break;
+        case shapes::CONE:
+        {
+            auto s = static_cast<const shapes::Cone*>(shape.get());
+            a.emplace_back(0.0, 0.0, -0.5 * s->length);
+            b.emplace_back(0.0, 0.0, 0.5 * s->length);
+            radius.push_back(s->radius);
+        }
+        break;
+        case shapes::BOX:
+        {
+            const double* size = static_cast<const shapes::Box*>(shape.get())->size;
+            AddBoxCapsules(Eigen::Vector3d::Zero(), Eigen::Vector3d(size[0], size[1], size[2]), a, b, radius);
+        }
+        break;
+        case shapes::MESH:
+        {
+            // Enclose the bounding box of the vertices
+            auto mesh = static_cast<const shapes::Mesh*>(shape.get());
+            if (mesh->vertex_count == 0) ThrowPretty("The mesh of '" << element->segment.getName() << "' has no vertices.");
+            Eigen::AlignedBox3d box;
+            for (unsigned int i = 0; i < mesh->vertex_count; ++i) box.extend(Eigen::Vector3d(mesh->vertices[3 * i], mesh->vertices[3 * i + 1], mesh->vertices[3 * i + 2]));
+            AddBoxCapsules(box.center(), box.sizes(), a, b, radius);
+        }
+        break;
+        default:
+            ThrowPretty("Shape type " << shape->type << " of robot link '" << element->segment.getName() << "' is not supported by the SDF collision scene.");
+    }
+
+    std::vector<Capsule> capsules(a.size());
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        capsules[i].a = a[i];
+        capsules[i].b = b[i];
+        capsules[i].radius = radius[i];
+        capsules[i].world_a = a[i];
+        capsules[i].world_b = b[i];
+        capsules[i].num_samples = 1 + static_cast<int>(std::ceil((b[i] - a[i]).norm() / voxel_size_));
+    }
+    return capsules;
+}
+
+void CollisionSceneSDF::UpdateNumSamples()
+{
+    for (std::vector<Capsule>& capsules : capsules_)
+        for (Capsule& capsule : capsules)
+            capsule.num_samples = 1 + static_cast<int>(std::ceil((capsule.b - capsule.a).norm() / voxel_size_));
+}
+
+bool CollisionSceneSDF::IsAllowedToCollide(const std::string& o1, const std::string& o2, const bool& self)
+{
+    auto it1 = kinematic_elements_map_.find(o1);
+    auto it2 = kinematic_elements_map_.find(o2);
+    if (it1 == kinematic_elements_map_.end()) ThrowPretty("KinematicElement is not a valid collision link:" << o1);
+    if (it2 == kinematic_elements_map_.end()) ThrowPretty("KinematicElement is not a valid collision link:" << o2);
+    return IsAllowedToCollide(it1->second.lock(), it2->second.lock(), self);
+}
+
+bool CollisionSceneSDF::IsAllowedToCollide(const std::shared_ptr<KinematicElement>& e1, const std::shared_ptr<KinematicElement>& e2, bool self) const
+{
+    bool isRobot1 = IsRobotLink(e1);
+    bool isRobot2 = IsRobotLink(e2);
+    // Don't check collisions between world objects
+    if (!isRobot1 && !isRobot2) return false;
+    // Skip self collisions if requested
+    if (isRobot1 && isRobot2 && !self) return false;
+    // Skip collisions between shapes within the same objects
+    if (e1->parent.lock() == e2->parent.lock()) return false;
+    // Skip collisions between bodies attached to the same object
+    if (e1->closest_robot_link.lock() && e2->closest_robot_link.lock() && e1->closest_robot_link.lock() == e2->closest_robot_link.lock()) return false;
+
+    if (isRobot1 && isRobot2)
+    {
+        const std::string& name1 = e1->closest_robot_link.lock() ? e1->closest_robot_link.lock()->segment.getName() : e1->parent.lock()->segment.getName();
+        const std::string& name2 = e2->closest_robot_link.lock() ? e2->closest_robot_link.lock()->segment.getName() : e2->parent.lock()->segment.getName();
+        return acm_.getAllowedCollision(name1, name2);
+    }
+    return true;
+}
+
+void CollisionSceneSDF::UpdateSelfCollisionPairs()
+{
+    self_collision_pairs_.clear();
+    for (std::size_t i = 0; i < robot_elements_.size(); ++i)
+    {
+        for (std::size_t j = i + 1; j < robot_elements_.size(); ++j)
+        {
+            if (IsAllowedToCollide(robot_elements_[i].lock(), robot_elements_[j].lock(), true) && IsAllowedToCollide(robot_elements_[j].lock(), robot_elements_[i].lock(), true))
+            {
+                self_collision_pairs_.emplace_back(static_cast<int>(i), static_cast<int>(j));
+            }
+        }
+    }
+    self_collision_pairs_need_update_ = false;
+}
+
+bool CollisionSceneSDF::ComputeWorldDistance(int i, CollisionProxy& proxy) const
+{
+    if (field_.IsEmpty()) return false;
+
+    // The field is evaluated at most a voxel apart along the segment, so the distance of the
+    // capsule is overestimated by at most half a voxel.
+    const Capsule* closest_capsule = nullptr;
+    Eigen::Vector3d closest_point, closest_gradient, gradient;
+    double distance = std::numeric_limits<double>::infinity();
+    for (const Capsule& capsule : capsules_[i])
+    {
+        for (int k = 0; k < capsule.num_samples; ++k)
+        {
+            const double t = capsule.num_samples > 1 ? static_cast<double>(k) / (capsule.num_samples - 1) : 0.0;
+            const Eigen::Vector3d p = capsule.world_a + t * (capsule.world_b - capsule.world_a);
+            const double d = field_.GetDistance(p, gradient) - capsule.radius;
+            if (d < distance)
+            {
+                distance = d;
+                closest_capsule = &capsule;
+                closest_point = p;
+                closest_gradient = gradient;
+            }
+        }
+    }
+    if (!closest_capsule) return false;
+
+    proxy.e1 = robot_elements_[i].lock();
+    proxy.e2 = world_elements_[field_.GetClosestObject(closest_point)].lock();
+    proxy.distance = distance;
+    // The gradient points away from the world, normal1 points from the robot towards the world
+    const double norm = closest_gradient.norm();
+    proxy.normal1 = norm > 0.0 ? Eigen::Vector3d(-closest_gradient / norm) : Eigen::Vector3d::Zero();
+    proxy.normal2 = -proxy.normal1;
+    proxy.contact1 = closest_point + closest_capsule->radius * proxy.normal1;
+    proxy.contact2 = closest_point + (distance + closest_capsule->radius) * proxy.normal1;
+    return true;
+}
+
+CollisionProxy CollisionSceneSDF::ComputeSelfDistance(int i, int j) const
+{
+    CollisionProxy proxy;
+    proxy.e1 = robot_elements_[i].lock();
+    proxy.e2 = robot_elements_[j].lock();
+    proxy.distance = std::numeric_limits<double>::infinity();
+    Eigen::Vector3d c1, c2;
+    for (const Capsule& capsule1 : capsules_[i])
+    {
+        for (const Capsule& capsule2 : capsules_[j])
+        {
+            ClosestPointsOnSegments(capsule1.world_a, capsule1.world_b, capsule2.world_a, capsule2.world_b, c1, c2);
+            const double d = (c2 - c1).norm() - capsule1.radius - capsule2.radius;
+            if (d < proxy.distance)
+            {
+                // On coinciding segments, the normal is taken from the link origins
+                Eigen::Vector3d normal = (c2 - c1).norm() > 1e-12 ? Eigen::Vector3d(c2 - c1) : Eigen::Vector3d(Eigen::Map<const Eigen::Vector3d>(proxy.e2->frame.p.data) - Eigen::Map<const Eigen::Vector3d>(proxy.e1->frame.p.data));
+                if (normal.norm() > 1e-12) normal.normalize();
+                proxy.distance = d;
+                proxy.normal1 = normal;
+                proxy.normal2 = -normal;
+                proxy.contact1 = c1 + capsule1.radius * normal;
+                proxy.contact2 = c2 - capsule2.radius * normal;
+            }
+        }
+    }
+    return proxy;
+}
+
+bool CollisionSceneSDF::IsStateValid(bool self, double safe_distance)
+{
+    if (!always_externally_updated_collision_scene_) UpdateCollisionObjectTransforms();
+    if (field_needs_update_) UpdateSignedDistanceField();
+
+    CollisionProxy proxy;
+    for (std::size_t i = 0; i < robot_elements_.size(); ++i)
+    {
+        if (ComputeWorldDistance(static_cast<int>(i), proxy) && proxy.distance < safe_distance) return false;
+    }
+
+    if (self)
+    {
+        if (self_collision_pairs_need_update_) UpdateSelfCollisionPairs();
+        for (const auto& pair : self_collision_pairs_)
+        {
+            if (ComputeSelfDistance(pair.first, pair.second).distance < safe_distance) return false;
+        }
+    }
+    return true;
+}
+
+std::vector<CollisionProxy> CollisionSceneSDF::GetCollisionDistance(bool self)
+{
+    if (!always_externally_updated_collision_scene_) UpdateCollisionObjectTransforms();
+
+    std::vector<CollisionProxy> proxies = GetRobotToWorldCollisionDistance(std::numeric_limits<double>::infinity());
+    if (self) AppendVector(proxies, GetRobotToRobotCollisionDistance(std::numeric_limits<double>::infinity()));
+    return proxies;
+}
+
+std::vector<CollisionProxy> CollisionSceneSDF::GetCollisionDistance(const std::string& o1, const bool& self)
+{
+    return GetCollisionDistance(o1, self, false);
+}
+
+std::vector<CollisionProxy> CollisionSceneSDF::GetCollisionDistance(const std::string& o1, const bool& self, const bool& disable_collision_scene_update)
+{
+    if (!always_externally_updated_collision_scene_ && !disable_collision_scene_update) UpdateCollisionObjectTransforms();
+    if (field_needs_update_) UpdateSignedDistanceField();
+
+    std::vector<CollisionProxy> proxies;
+    const std::vector<int> elements = GetRobotElementsByName(o1);
+    CollisionProxy proxy;
+    for (int i : elements)
+    {
+        if (ComputeWorldDistance(i, proxy)) proxies.push_back(proxy);
+    }
+
+    if (self)
+    {
+        if (self_collision_pairs_need_update_) UpdateSelfCollisionPairs();
+        for (const auto& pair : self_collision_pairs_)
+        {
+            // Proxies are ordered such that e1 belongs to o1
+            const bool first = std::find(elements.begin(), elements.end(), pair.first) != elements.end();
+            const bool second = std::find(elements.begin(), elements.end(), pair.second) != elements.end();
+            if (first)
+                proxies.push_back(ComputeSelfDistance(pair.first, pair.second));
+            else if (second)
+                proxies.push_back(ComputeSelfDistance(pair.second, pair.first));
+        }
+    }
+    return proxies;
+}
+
+std::vector<CollisionProxy> CollisionSceneSDF::GetCollisionDistance(const std::vector<std::string>& objects, const bool& self)
+{
+    if (!always_externally_updated_collision_scene_) UpdateCollisionObjectTransforms();
+
+    std::vector<CollisionProxy> proxies;
+    for (const auto& o1 : objects)
+        AppendVector(proxies, GetCollisionDistance(o1, self, true));
+
+    return proxies;
+}
+
+std::vector<CollisionProxy> CollisionSceneSDF::GetRobotToRobotCollisionDistance(double check_margin)
+{
+    if (self_collision_pairs_need_update_) UpdateSelfCollisionPairs();
+
+    std::vector<CollisionProxy> proxies;
+    for (const auto& pair : self_collision_pairs_)
+    {
+        CollisionProxy proxy = ComputeSelfDistance(pair.first, pair.second);
+        if (proxy.distance < check_margin) proxies.push_back(proxy);
+    }
+    return proxies;
+}
+
+std::vector<CollisionProxy> CollisionSceneSDF::GetRobotToWorldCollisionDistance(double check_margin)
+{
+    if (field_needs_update_) UpdateSignedDistanceField();
+
+    std::vector<CollisionProxy> proxies;
+    CollisionProxy proxy;
+    for (std::size_t i = 0; i < robot_elements_.size(); ++i)
+    {
+        if (ComputeWorldDistance(static_cast<int>(i), proxy) && proxy.distance < check_margin) proxies.push_back(proxy);
+    }
+    return proxies;
+}
+
+std::vector<int> CollisionSceneSDF::GetRobotElementsByName(const std::string& name) const
+{
+    // Either the name of the link (e.g., base_link) or the name of the collision object (e.g., base_link_collision_0)
+    std::vector<int> elements;
+    for (std::size_t i = 0; i < robot_names_.size(); ++i)
+    {
+        if (robot_names_[i].first == name || robot_names_[i].second == name) elements.push_back(static_cast<int>(i));
+    }
+    return elements;
+}
+
+std::vector<std::string> CollisionSceneSDF::GetCollisionWorldLinks()
+{
+    return world_links_;
+}
+
+std::vector<std::string> CollisionSceneSDF::GetCollisionRobotLinks()
+{
+    std::vector<std::string> links;
+    links.reserve(robot_names_.size());
+    for (const auto& names : robot_names_) links.push_back(names.first);
+    return links;
+}
+
+Eigen::Vector3d CollisionSceneSDF::GetTranslation(const std::string& name)
+{
+    auto it = kinematic_elements_map_.find(name);
+    if (it == kinematic_elements_map_.end()) ThrowPretty("KinematicElement is not a valid collision link:" << name);
+    return Eigen::Map<Eigen::Vector3d>(it->second.lock()->frame.p.data);
+}
+}  // namespace exotica
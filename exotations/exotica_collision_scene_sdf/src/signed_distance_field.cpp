@@ -0,0 +1,261 @@
+//
+// Copyright (c) 2020, University of Edinburgh, University of Oxford
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <exotica_collision_scene_sdf/signed_distance_field.h>
+#include <exotica_core/tools/exception.h>
+
+#include <cmath>
+#include <limits>
+
+namespace exotica
+{
+namespace
+{
+constexpr double kInfinity = 1e20;
+constexpr double kMaxVoxels = 5e7;
+
+// One-dimensional squared distance transform (Felzenszwalb and Huttenlocher, Distance Transforms of Sampled Functions, 2012).
+// Computes d[q] = min_p (q - p)^2 + f[p] and the minimising p for each q < n, v and z are buffers of size n and n + 1.
+void DistanceTransform1D(const std::vector<double>& f, int n, std::vector<double>& d, std::vector<int>& arg, std::vector<int>& v, std::vector<double>& z)
+{
+    int k = 0;
+    v[0] = 0;
+    z[0] = -kInfinity;
+    z[1] = kInfinity;
+    for (int q = 1; q < n; ++q)
+    {
+        double s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0 * (q - v[k]));
+        while (s <= z[k])
+        {
+            --k;
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0 * (q - v[k]));
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = kInfinity;
+    }
+    k = 0;
+    for (int q = 0; q < n; ++q)
+    {
+        while (z[k + 1] < q) ++k;
+        d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+        arg[q] = v[k];
+    }
+}
+
+// Squared distance in voxels from each voxel to the closest site, i.e. voxel with distance 0, and the index of that site.
+// The transform is separable, so it is applied along each axis in turn while carrying the closest site along.
+void DistanceTransform3D(const Eigen::Vector3i& size, std::vector<double>& distance, std::vector<int>& closest)
+{
+    const Eigen::Vector3i strides(1, size(0), size(0) * size(1));
+    const int n = size.maxCoeff();
+    std::vector<double> f(n), d(n), z(n + 1);
+    std::vector<int> arg(n), v(n), line_closest(n);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const int a1 = (axis + 1) % 3;
+        const int a2 = (axis + 2) % 3;
+        for (int i2 = 0; i2 < size(a2); ++i2)
+        {
+            for (int i1 = 0; i1 < size(a1); ++i1)
+            {
+                const std::size_t start = static_cast<std::size_t>(i1) * strides(a1) + static_cast<std::size_t>(i2) * strides(a2);
+                for (int q = 0; q < size(axis); ++q)
+                {
+                    f[q] = distance[start + static_cast<std::size_t>(q) * strides(axis)];
+                    line_closest[q] = closest[start + static_cast<std::size_t>(q) * strides(axis)];
+                }
+                DistanceTransform1D(f, size(axis), d, arg, v, z);
+                for (int q = 0; q < size(axis); ++q)
+                {
+                    distance[start + static_cast<std::size_t>(q) * strides(axis)] = d[q];
+                    closest[start + static_cast<std::size_t>(q) * strides(axis)] = line_closest[arg[q]];
+                }
+            }
+        }
+    }
+}
+}  // namespace
+
+void SignedDistanceField::Initialize(const Eigen::AlignedBox3d& bounds, double voxel_size)
+{
+    if (voxel_size <= 0.0) ThrowPretty("The voxel size needs to be positive, got " << voxel_size);
+    if (bounds.isEmpty()) ThrowPretty("The bounds of the field are empty.");
+
+    voxel_size_ = voxel_size;
+    for (int i = 0; i < 3; ++i) size_(i) = std::max(2, static_cast<int>(std::ceil(bounds.sizes()(i) / voxel_size_)) + 1);
+    const double num_voxels = size_.cast<double>().prod();
+    if (num_voxels > kMaxVoxels) ThrowPretty("The field would have " << num_voxels << " voxels, increase the voxel size or reduce the extent of the world.");
+
+    // Centre the voxels on the bounds
+    origin_ = bounds.center() - 0.5 * voxel_size_ * (size_ - Eigen::Vector3i::Ones()).cast<double>();
+    occupancy_.assign(static_cast<std::size_t>(num_voxels), -1);
+    closest_object_.clear();
+    distance_.clear();
+    empty_ = true;
+}
+
+void SignedDistanceField::AddObject(const Eigen::AlignedBox3d& bounds, int owner, const std::function<bool(const Eigen::Vector3d&)>& contains)
+{
+    if (owner < 0) ThrowPretty("Object ids need to be non-negative, got " << owner);
+    if (occupancy_.empty()) ThrowPretty("The field has not been initialized.");
+
+    const Eigen::Vector3i lower = ((bounds.min() - origin_) / voxel_size_).array().ceil().cast<int>().max(0).matrix();
+    const Eigen::Vector3i upper = ((bounds.max() - origin_) / voxel_size_).array().floor().cast<int>().min((size_ - Eigen::Vector3i::Ones()).array()).matrix();
+    bool occupies_voxel = false;
+    for (int z = lower(2); z <= upper(2); ++z)
+    {
+        for (int y = lower(1); y <= upper(1); ++y)
+        {
+            for (int x = lower(0); x <= upper(0); ++x)
+            {
+                if (contains(origin_ + voxel_size_ * Eigen::Vector3d(x, y, z)))
+                {
+                    occupancy_[GetIndex(x, y, z)] = owner;
+                    occupies_voxel = true;
+                }
+            }
+        }
+    }
+
+    // Objects that do not contain any voxel centre occupy the voxel closest to their centre
+    if (!occupies_voxel)
+    {
+        const Eigen::Vector3i voxel = GetClosestVoxel(bounds.center());
+        occupancy_[GetIndex(voxel(0), voxel(1), voxel(2))] = owner;
+    }
+}
+
+void SignedDistanceField::Compute()
+{
+    const std::size_t n = occupancy_.size();
+    std::vector<double> outside(n), inside(n);
+    std::vector<int> closest_occupied(n), closest_free(n);
+    empty_ = true;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const bool occupied = occupancy_[i] >= 0;
+        if (occupied) empty_ = false;
+        outside[i] = occupied ? 0.0 : kInfinity;
+        inside[i] = occupied ? kInfinity : 0.0;
+        closest_occupied[i] = occupied ? static_cast<int>(i) : -1;
+        closest_free[i] = occupied ? -1 : static_cast<int>(i);
+    }
+    DistanceTransform3D(size_, outside, closest_occupied);
+    DistanceTransform3D(size_, inside, closest_free);
+
+    // The surface of the objects is assumed to lie half way between occupied and free voxel centres
+    const double max_distance = voxel_size_ * size_.cast<double>().norm();
+    distance_.resize(n);
+    closest_object_.resize(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (occupancy_[i] >= 0)
+        {
+            distance_[i] = inside[i] < 0.5 * kInfinity ? -(std::sqrt(inside[i]) - 0.5) * voxel_size_ : -max_distance;
+            closest_object_[i] = occupancy_[i];
+        }
+        else
+        {
+            distance_[i] = outside[i] < 0.5 * kInfinity ? (std::sqrt(outside[i]) - 0.5) * voxel_size_ : max_distance;
+            closest_object_[i] = empty_ ? -1 : occupancy_[closest_occupied[i]];
+        }
+    }
+}
+
+double SignedDistanceField::GetDistance(const Eigen::Vector3d& p, Eigen::Vector3d& gradient) const
+{
+    gradient.setZero();
+    if (empty_) return std::numeric_limits<double>::infinity();
+
+    // Continuous voxel coordinates, clamped to the field
+    const Eigen::Vector3d u = (p - origin_) / voxel_size_;
+    const Eigen::Vector3d u_clamped = u.cwiseMax(Eigen::Vector3d::Zero()).cwiseMin((size_ - Eigen::Vector3i::Ones()).cast<double>());
+    Eigen::Vector3i i0;
+    Eigen::Vector3d t;
+    for (int i = 0; i < 3; ++i)
+    {
+        i0(i) = std::min(static_cast<int>(u_clamped(i)), size_(i) - 2);
+        t(i) = u_clamped(i) - i0(i);
+    }
+
+    // Trilinear interpolation between the surrounding voxel centres
+    const int x = i0(0), y = i0(1), z = i0(2);
+    const double c000 = distance_[GetIndex(x, y, z)];
+    const double c100 = distance_[GetIndex(x + 1, y, z)];
+    const double c010 = distance_[GetIndex(x, y + 1, z)];
+    const double c110 = distance_[GetIndex(x + 1, y + 1, z)];
+    const double c001 = distance_[GetIndex(x, y, z + 1)];
+    const double c101 = distance_[GetIndex(x + 1, y, z + 1)];
+    const double c011 = distance_[GetIndex(x, y + 1, z + 1)];
+    const double c111 = distance_[GetIndex(x + 1, y + 1, z + 1)];
+    const double c00 = c000 + t(0) * (c100 - c000);
+    const double c10 = c010 + t(0) * (c110 - c010);
+    const double c01 = c001 + t(0) * (c101 - c001);
+    const double c11 = c011 + t(0) * (c111 - c011);
+    const double c0 = c00 + t(1) * (c10 - c00);
+    const double c1 = c01 + t(1) * (c11 - c01);
+    double distance = c0 + t(2) * (c1 - c0);
+
+    gradient(0) = (1.0 - t(2)) * ((1.0 - t(1)) * (c100 - c000) + t(1) * (c110 - c010)) + t(2) * ((1.0 - t(1)) * (c101 - c001) + t(1) * (c111 - c011));
+    gradient(1) = (1.0 - t(2)) * (c10 - c00) + t(2) * (c11 - c01);
+    gradient(2) = c1 - c0;
+    gradient /= voxel_size_;
+
+    // Outside of the field, continue with the distance to its boundary
+    const Eigen::Vector3d offset = (u - u_clamped) * voxel_size_;
+    const double outside = offset.norm();
+    if (outside > 0.0)
+    {
+        distance += outside;
+        gradient = offset / outside;
+    }
+    return distance;
+}
+
+double SignedDistanceField::GetDistance(const Eigen::Vector3d& p) const
+{
+    Eigen::Vector3d gradient;
+    return GetDistance(p, gradient);
+}
+
+int SignedDistanceField::GetClosestObject(const Eigen::Vector3d& p) const
+{
+    if (empty_) return -1;
+    const Eigen::Vector3i voxel = GetClosestVoxel(p);
+    return closest_object_[GetIndex(voxel(0), voxel(1), voxel(2))];
+}
+
+Eigen::Vector3i SignedDistanceField::GetClosestVoxel(const Eigen::Vector3d& p) const
+{
+    const Eigen::Vector3d u = ((p - origin_) / voxel_size_).array().round();
+    return u.cwiseMax(Eigen::Vector3d::Zero()).cwiseMin((size_ - Eigen::Vector3i::Ones()).cast<double>()).cast<int>();
+}
+}  // namespace exotica
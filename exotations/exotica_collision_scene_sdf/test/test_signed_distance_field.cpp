@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2020, University of Edinburgh, University of Oxford
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <gtest/gtest.h>
+
+#include <exotica_collision_scene_sdf/signed_distance_field.h>
+
+#include <cmath>
+
+using namespace exotica;
+
+constexpr double kVoxelSize = 0.02;
+constexpr int kNumTrials = 10000;
+
+SignedDistanceField CreateSphereField(const Eigen::Vector3d& centre, double radius)
+{
+    SignedDistanceField field;
+    field.Initialize(Eigen::AlignedBox3d(Eigen::Vector3d::Constant(-1.0), Eigen::Vector3d::Constant(1.0)), kVoxelSize);
+    field.AddObject(Eigen::AlignedBox3d((centre.array() - radius).matrix(), (centre.array() + radius).matrix()), 0, [&](const Eigen::Vector3d& p) { return (p - centre).norm() <= radius; });
+    field.Compute();
+    return field;
+}
+
+TEST(SignedDistanceField, EmptyFieldHasInfiniteDistance)
+{
+    SignedDistanceField field;
+    field.Initialize(Eigen::AlignedBox3d(Eigen::Vector3d::Constant(-1.0), Eigen::Vector3d::Constant(1.0)), kVoxelSize);
+    field.Compute();
+    EXPECT_TRUE(field.IsEmpty());
+    EXPECT_TRUE(std::isinf(field.GetDistance(Eigen::Vector3d::Zero())));
+    EXPECT_EQ(field.GetClosestObject(Eigen::Vector3d::Zero()), -1);
+}
+
+TEST(SignedDistanceField, SphereDistanceAndGradient)
+{
+    const Eigen::Vector3d centre(0.1, -0.2, 0.05);
+    const double radius = 0.3;
+    SignedDistanceField field = CreateSphereField(centre, radius);
+    ASSERT_FALSE(field.IsEmpty());
+
+    Eigen::Vector3d gradient;
+    for (int i = 0; i < kNumTrials; ++i)
+    {
+        const Eigen::Vector3d p = 0.95 * Eigen::Vector3d::Random();
+        const double expected = (p - centre).norm() - radius;
+        EXPECT_NEAR(field.GetDistance(p, gradient), expected, kVoxelSize);
+        // Inside, the gradient of the voxelised sphere is less accurate
+        if (expected > kVoxelSize)
+        {
+            EXPECT_GT(gradient.normalized().dot((p - centre).normalized()), 0.9);
+        }
+        EXPECT_EQ(field.GetClosestObject(p), 0);
+    }
+}
+
+TEST(SignedDistanceField, DistanceOutsideOfField)
+{
+    const Eigen::Vector3d centre(0.0, 0.0, 0.0);
+    SignedDistanceField field = CreateSphereField(centre, 0.3);
+    Eigen::Vector3d gradient;
+    EXPECT_NEAR(field.GetDistance(Eigen::Vector3d(2.0, 0.0, 0.0), gradient), 1.7, kVoxelSize);
+    EXPECT_TRUE(gradient.isApprox(Eigen::Vector3d::UnitX()));
+}
+
+TEST(SignedDistanceField, ClosestObject)
+{
+    SignedDistanceField field;
+    field.Initialize(Eigen::AlignedBox3d(Eigen::Vector3d::Constant(-1.0), Eigen::Vector3d::Constant(1.0)), kVoxelSize);
+    const Eigen::Vector3d half_size(0.1, 0.1, 0.1);
+    const Eigen::Vector3d left(-0.5, 0.0, 0.0), right(0.5, 0.0, 0.0);
+    field.AddObject(Eigen::AlignedBox3d(left - half_size, left + half_size), 3, [](const Eigen::Vector3d&) { return true; });
+    field.AddObject(Eigen::AlignedBox3d(right - half_size, right + half_size), 7, [](const Eigen::Vector3d&) { return true; });
+    // Objects smaller than a voxel still occupy one
+    field.AddObject(Eigen::AlignedBox3d(Eigen::Vector3d(0.0, 0.5, 0.0), Eigen::Vector3d(0.001, 0.501, 0.001)), 9, [](const Eigen::Vector3d&) { return false; });
+    field.Compute();
+
+    EXPECT_EQ(field.GetClosestObject(Eigen::Vector3d(-0.3, 0.0, 0.0)), 3);
+    EXPECT_EQ(field.GetClosestObject(Eigen::Vector3d(0.3, 0.0, 0.0)), 7);
+    EXPECT_EQ(field.GetClosestObject(Eigen::Vector3d(0.0, 0.45, 0.0)), 9);
+    EXPECT_NEAR(field.GetDistance(Eigen::Vector3d(-0.3, 0.0, 0.0)), 0.1, kVoxelSize);
+    EXPECT_NEAR(field.GetDistance(left), -0.1, kVoxelSize);
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -43,6 +43,7 @@ public:
 
     void Update(Eigen::VectorXdRefConst x, Eigen::VectorXdRef phi) override;
     int TaskSpaceDim() override;
+    double GetRelativeCost() const override { return 100.0; }
 
 private:
     void Initialize();
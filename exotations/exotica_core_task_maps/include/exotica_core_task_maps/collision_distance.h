@@ -47,6 +47,7 @@ public:
     void Update(Eigen::VectorXdRefConst x, Eigen::VectorXdRef phi) override;
     void Update(Eigen::VectorXdRefConst x, Eigen::VectorXdRef phi, Eigen::MatrixXdRef J) override;
     int TaskSpaceDim() override;
+    double GetRelativeCost() const override { return 1000.0; }
 
     std::vector<CollisionProxy> get_collision_proxies() { return closest_proxies_; }
 private:
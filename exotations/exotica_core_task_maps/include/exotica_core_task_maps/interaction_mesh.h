@@ -60,12 +60,29 @@ public:
     void ComputeGoalLaplace(const Eigen::VectorXd& x, Eigen::VectorXd& goal);
     static void ComputeGoalLaplace(const std::vector<KDL::Frame>& nodes, Eigen::VectorXd& goal, Eigen::MatrixXdRefConst weights);
 
+    /// \brief Returns the indices of the markers connected to each marker by a non-zero weight.
+    static std::vector<std::vector<int>> ComputeNeighbours(Eigen::MatrixXdRefConst weights);
+
+    /// \brief Computes the Laplace coordinates of the markers and their Jacobian, visiting only connected markers.
+    /// @param eff_Phi Stacked marker positions (3M).
+    /// @param eff_jacobian Stacked positional Jacobians of the markers (3M x N).
+    /// @param weights Mesh weights (M x M).
+    /// @param neighbours Neighbour lists of the weights, see ComputeNeighbours.
+    /// @param phi Laplace coordinates (3M).
+    /// @param jacobian Jacobian of the Laplace coordinates (3M x N).
+    static void ComputeLaplaceJacobian(Eigen::VectorXdRefConst eff_Phi, Eigen::MatrixXdRefConst eff_jacobian, Eigen::MatrixXdRefConst weights, const std::vector<std::vector<int>>& neighbours, Eigen::VectorXdRef phi, Eigen::MatrixXdRef jacobian);
+
 protected:
     void Debug(Eigen::VectorXdRefConst phi);
     void InitializeDebug(std::string ref);
     void DestroyDebug();
 
+    /// \brief Returns the stacked positions of the markers.
+    Eigen::VectorXd GetMarkerPositions() const;
+
     Eigen::MatrixXd weights_;
+    std::vector<std::vector<int>> neighbours_;  ///< Markers connected by a non-zero weight, updated with the weights.
+    Eigen::MatrixXd eff_jacobian_;              ///< Stacked positional Jacobians of the markers.
     int eff_size_ = 0;
 
     ros::Publisher imesh_mark_pub_;
@@ -48,6 +48,7 @@ public:
     void Update(Eigen::VectorXdRefConst x, Eigen::VectorXdRef phi, Eigen::MatrixXdRef J) override;
 
     int TaskSpaceDim() override;
+    double GetRelativeCost() const override { return 1000.0; }
 
 private:
     void Initialize();
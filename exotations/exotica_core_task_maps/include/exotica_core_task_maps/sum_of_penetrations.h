@@ -46,6 +46,7 @@ public:
 
     void Update(Eigen::VectorXdRefConst x, Eigen::VectorXdRef phi) override;
     int TaskSpaceDim() override;
+    double GetRelativeCost() const override { return 1000.0; }
 
 private:
     void Initialize();
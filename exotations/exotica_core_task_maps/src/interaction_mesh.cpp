@@ -27,6 +27,8 @@
 // POSSIBILITY OF SUCH DAMAGE.
 //
 
+#include <algorithm>
+
 #include <exotica_core/server.h>
 #include <exotica_core_task_maps/interaction_mesh.h>
 
@@ -37,20 +39,54 @@ namespace exotica
 InteractionMesh::InteractionMesh() = default;
 InteractionMesh::~InteractionMesh() = default;
 
+namespace
+{
+// Distances from marker j to its neighbours, returns the weight normaliser
+double ComputeNeighbourDistances(Eigen::VectorXdRefConst eff_Phi, Eigen::MatrixXdRefConst weights, int j, const std::vector<int>& neighbours, std::vector<double>& dist)
+{
+    double wsum = 0.0;
+    dist.resize(neighbours.size());
+    for (std::size_t n = 0; n < neighbours.size(); ++n)
+    {
+        const int l = neighbours[n];
+        dist[n] = (eff_Phi.segment<3>(j * 3) - eff_Phi.segment<3>(l * 3)).norm();
+        if (dist[n] > 0) wsum += weights(j, l) / dist[n];
+    }
+    return wsum;
+}
+}
+
+Eigen::VectorXd InteractionMesh::GetMarkerPositions() const
+{
+    Eigen::VectorXd eff_Phi(eff_size_ * 3);
+    for (int i = 0; i < eff_size_; ++i)
+    {
+        eff_Phi(i * 3) = kinematics[0].Phi(i).p[0];
+        eff_Phi(i * 3 + 1) = kinematics[0].Phi(i).p[1];
+        eff_Phi(i * 3 + 2) = kinematics[0].Phi(i).p[2];
+    }
+    return eff_Phi;
+}
+
 void InteractionMesh::Update(Eigen::VectorXdRefConst x, Eigen::VectorXdRef phi)
 {
     int M = eff_size_;
 
     if (phi.rows() != M * 3) ThrowNamed("Wrong size of Phi!");
 
-    Eigen::VectorXd eff_Phi;
-    for (int i = 0; i < M; ++i)
+    const Eigen::VectorXd eff_Phi = GetMarkerPositions();
+    std::vector<double> dist;
+    for (int j = 0; j < M; ++j)
     {
-        eff_Phi(i * 3) = kinematics[0].Phi(i).p[0];
-        eff_Phi(i * 3 + 1) = kinematics[0].Phi(i).p[1];
-        eff_Phi(i * 3 + 2) = kinematics[0].Phi(i).p[2];
+        const double wsum = ComputeNeighbourDistances(eff_Phi, weights_, j, neighbours_[j], dist);
+        phi.segment<3>(j * 3) = eff_Phi.segment<3>(j * 3);
+        if (wsum <= 0) continue;
+        for (std::size_t n = 0; n < neighbours_[j].size(); ++n)
+        {
+            const int l = neighbours_[j][n];
+            if (dist[n] > 0) phi.segment<3>(j * 3) -= eff_Phi.segment<3>(l * 3) * weights_(j, l) / (dist[n] * wsum);
+        }
     }
-    phi = ComputeLaplace(eff_Phi, weights_);
 
     if (debug_) Debug(phi);
 }
@@ -63,64 +99,75 @@ void InteractionMesh::Update(Eigen::VectorXdRefConst x, Eigen::VectorXdRef phi,
     if (phi.rows() != M * 3) ThrowNamed("Wrong size of Phi!");
     if (jacobian.rows() != M * 3 || jacobian.cols() != N) ThrowNamed("Wrong size of jacobian! " << N);
 
-    Eigen::MatrixXd dist;
-    Eigen::VectorXd wsum;
-    Eigen::VectorXd eff_Phi(M * 3);
-    for (int i = 0; i < M; ++i)
+    eff_jacobian_.resize(M * 3, N);
+    for (int i = 0; i < M; ++i) eff_jacobian_.middleRows<3>(i * 3) = kinematics[0].jacobian[i].data.topRows<3>();
+    ComputeLaplaceJacobian(GetMarkerPositions(), eff_jacobian_, weights_, neighbours_, phi, jacobian);
+
+    if (debug_) Debug(phi);
+}
+
+std::vector<std::vector<int>> InteractionMesh::ComputeNeighbours(Eigen::MatrixXdRefConst weights)
+{
+    std::vector<std::vector<int>> neighbours(weights.rows());
+    for (int j = 0; j < weights.rows(); ++j)
     {
-        eff_Phi(i * 3) = kinematics[0].Phi(i).p[0];
-        eff_Phi(i * 3 + 1) = kinematics[0].Phi(i).p[1];
-        eff_Phi(i * 3 + 2) = kinematics[0].Phi(i).p[2];
+        for (int l = 0; l < weights.cols(); ++l)
+        {
+            if (j != l && weights(j, l) != 0) neighbours[j].push_back(l);
+        }
     }
-    phi = ComputeLaplace(eff_Phi, weights_, &dist, &wsum);
+    return neighbours;
+}
 
-    double A, _A, Sk, Sl, w, _w;
-    int i, j, k, l;
-    Eigen::Vector3d distance, _distance = Eigen::Vector3d::Zero(3, 1);
-    for (i = 0; i < N; ++i)
+void InteractionMesh::ComputeLaplaceJacobian(Eigen::VectorXdRefConst eff_Phi, Eigen::MatrixXdRefConst eff_jacobian, Eigen::MatrixXdRefConst weights, const std::vector<std::vector<int>>& neighbours, Eigen::VectorXdRef phi, Eigen::MatrixXdRef jacobian)
+{
+    const int M = eff_Phi.rows() / 3;
+    const int N = eff_jacobian.cols();
+
+    std::size_t max_neighbours = 0;
+    for (const std::vector<int>& n : neighbours) max_neighbours = std::max(max_neighbours, n.size());
+
+    std::vector<double> dist;
+    Eigen::MatrixXd ddist(max_neighbours, N);  // Derivatives of the distances to the neighbours
+    Eigen::RowVectorXd dwsum(N);
+    Eigen::RowVectorXd dw(N);
+    Eigen::Vector3d distance;
+    for (int j = 0; j < M; ++j)
     {
-        for (j = 0; j < M; ++j)
+        const std::vector<int>& neighbours_j = neighbours[j];
+        const double wsum = ComputeNeighbourDistances(eff_Phi, weights, j, neighbours_j, dist);
+        phi.segment<3>(j * 3) = eff_Phi.segment<3>(j * 3);
+        jacobian.middleRows<3>(j * 3) = eff_jacobian.middleRows<3>(j * 3);
+        if (wsum <= 0) continue;
+
+        // Laplace coordinates and derivatives of the distances to the neighbours with positive weights
+        double wsum_positive = 0.0;
+        dwsum.setZero();
+        for (std::size_t n = 0; n < neighbours_j.size(); ++n)
         {
-            if (j < M)
-                jacobian.block(3 * j, i, 3, 1) = kinematics[0].jacobian[j].data.block(0, i, 3, 1);
-            for (l = 0; l < M; ++l)
-            {
-                if (j != l)
-                {
-                    if (dist(j, l) > 0 && wsum(j) > 0 && weights_(j, l) > 0)
-                    {
-                        A = dist(j, l) * wsum(j);
-                        w = weights_(j, l) / A;
-
-                        _A = 0;
-                        distance = eff_Phi.segment(j * 3, 3) - eff_Phi.segment(l * 3, 3);
-                        _distance = kinematics[0].jacobian[j].data.block(0, i, 3, 1) - kinematics[0].jacobian[l].data.block(0, i, 3, 1);
-
-                        Sl = distance.dot(_distance) / dist(j, l);
-                        for (k = 0; k < M; ++k)
-                        {
-                            if (j != k && dist(j, k) > 0 && weights_(j, k) > 0)
-                            {
-                                distance = eff_Phi.segment(j * 3, 3) - eff_Phi.segment(k * 3, 3);
-                                _distance = kinematics[0].jacobian[j].data.block(0, i, 3, 1) - kinematics[0].jacobian[k].data.block(0, i, 3, 1);
-                                Sk = distance.dot(_distance) / dist(j, k);
-                                _A += weights_(j, k) * (Sl * dist(j, k) - Sk * dist(j, l)) / (dist(j, k) * dist(j, k));
-                            }
-                        }
-                        _w = -weights_(j, l) * _A / (A * A);
-                    }
-                    else
-                    {
-                        _w = 0;
-                        w = 0;
-                    }
-                    jacobian.block(3 * j, i, 3, 1) -= eff_Phi.segment(l * 3, 3) * _w + kinematics[0].jacobian[l].data.block(0, i, 3, 1) * w;
-                }
-            }
+            const int l = neighbours_j[n];
+            if (dist[n] <= 0) continue;
+            phi.segment<3>(j * 3) -= eff_Phi.segment<3>(l * 3) * weights(j, l) / (dist[n] * wsum);
+            if (weights(j, l) <= 0) continue;
+
+            distance = (eff_Phi.segment<3>(j * 3) - eff_Phi.segment<3>(l * 3)) / dist[n];
+            ddist.row(n).noalias() = distance.transpose() * eff_jacobian.middleRows<3>(j * 3);
+            ddist.row(n).noalias() -= distance.transpose() * eff_jacobian.middleRows<3>(l * 3);
+            wsum_positive += weights(j, l) / dist[n];
+            dwsum += weights(j, l) / (dist[n] * dist[n]) * ddist.row(n);
         }
-    }
 
-    if (debug_) Debug(phi);
+        // Derivatives of the normalised weights w_jl / (dist_jl * wsum_j)
+        for (std::size_t n = 0; n < neighbours_j.size(); ++n)
+        {
+            const int l = neighbours_j[n];
+            if (dist[n] <= 0 || weights(j, l) <= 0) continue;
+            const double A = dist[n] * wsum;
+            dw = (-weights(j, l) / (A * A)) * (ddist.row(n) * wsum_positive - dist[n] * dwsum);
+            jacobian.middleRows<3>(j * 3).noalias() -= eff_Phi.segment<3>(l * 3) * dw;
+            jacobian.middleRows<3>(j * 3) -= (weights(j, l) / A) * eff_jacobian.middleRows<3>(l * 3);
+        }
+    }
 }
 
 Eigen::MatrixXd InteractionMesh::GetWeights()
@@ -150,6 +197,7 @@ void InteractionMesh::Instantiate(const InteractionMeshInitializer& init)
         HIGHLIGHT("Loading iMesh weights.\n"
                   << weights_);
     }
+    neighbours_ = ComputeNeighbours(weights_);
 }
 
 void InteractionMesh::AssignScene(ScenePtr scene)
@@ -306,14 +354,7 @@ void InteractionMesh::ComputeGoalLaplace(const std::vector<KDL::Frame>& nodes, E
 void InteractionMesh::ComputeGoalLaplace(const Eigen::VectorXd& x, Eigen::VectorXd& goal)
 {
     scene_->Update(x);
-    Eigen::VectorXd eff_Phi;
-    for (int i = 0; i < eff_size_; ++i)
-    {
-        eff_Phi(i * 3) = kinematics[0].Phi(i).p[0];
-        eff_Phi(i * 3 + 1) = kinematics[0].Phi(i).p[1];
-        eff_Phi(i * 3 + 2) = kinematics[0].Phi(i).p[2];
-    }
-    goal = ComputeLaplace(eff_Phi, weights_);
+    goal = ComputeLaplace(GetMarkerPositions(), weights_);
 }
 
 void InteractionMesh::SetWeight(int i, int j, double weight)
@@ -328,6 +369,7 @@ void InteractionMesh::SetWeight(int i, int j, double weight)
         ThrowNamed("Invalid weight: " << weight);
     }
     weights_(i, j) = weight;
+    neighbours_ = ComputeNeighbours(weights_);
 }
 
 void InteractionMesh::SetWeights(const Eigen::MatrixXd& weights)
@@ -338,5 +380,6 @@ void InteractionMesh::SetWeights(const Eigen::MatrixXd& weights)
         ThrowNamed("Invalid weight matrix (" << weights.rows() << "X" << weights.cols() << "). Has to be" << M << "x" << M);
     }
     weights_ = weights;
+    neighbours_ = ComputeNeighbours(weights_);
 }
 }
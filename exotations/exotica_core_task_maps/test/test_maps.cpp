@@ -30,6 +30,7 @@
 #include <gtest/gtest.h>
 
 #include <exotica_core/exotica_core.h>
+#include <exotica_core_task_maps/interaction_mesh.h>
 
 // TODO(#437): Activate once solution for pointer casting/dynamic loading is found.
 // #include <exotica_core_task_maps/JointAccelerationBackwardDifference.h>
@@ -963,6 +964,97 @@ TEST(ExoticaTaskMaps, testIMesh)
     }
 }
 
+// Interaction mesh Jacobian as computed before neighbour lists were introduced, looping over joints x markers^3.
+void ReferenceIMeshJacobian(const Eigen::VectorXd& eff_Phi, const Eigen::MatrixXd& eff_jacobian, const Eigen::MatrixXd& weights, Eigen::VectorXd& phi, Eigen::MatrixXd& jacobian)
+{
+    const int M = eff_Phi.rows() / 3;
+    const int N = eff_jacobian.cols();
+    Eigen::MatrixXd dist;
+    Eigen::VectorXd wsum;
+    phi = InteractionMesh::ComputeLaplace(eff_Phi, weights, &dist, &wsum);
+    jacobian.resize(3 * M, N);
+    for (int i = 0; i < N; ++i)
+    {
+        for (int j = 0; j < M; ++j)
+        {
+            jacobian.block(3 * j, i, 3, 1) = eff_jacobian.block(3 * j, i, 3, 1);
+            for (int l = 0; l < M; ++l)
+            {
+                if (j == l) continue;
+                double w = 0, dw = 0;
+                if (dist(j, l) > 0 && wsum(j) > 0 && weights(j, l) > 0)
+                {
+                    const double A = dist(j, l) * wsum(j);
+                    w = weights(j, l) / A;
+                    const double Sl = (eff_Phi.segment(j * 3, 3) - eff_Phi.segment(l * 3, 3)).dot(eff_jacobian.col(i).segment(3 * j, 3) - eff_jacobian.col(i).segment(3 * l, 3)) / dist(j, l);
+                    double dA = 0;
+                    for (int k = 0; k < M; ++k)
+                    {
+                        if (j != k && dist(j, k) > 0 && weights(j, k) > 0)
+                        {
+                            const double Sk = (eff_Phi.segment(j * 3, 3) - eff_Phi.segment(k * 3, 3)).dot(eff_jacobian.col(i).segment(3 * j, 3) - eff_jacobian.col(i).segment(3 * k, 3)) / dist(j, k);
+                            dA += weights(j, k) * (Sl * dist(j, k) - Sk * dist(j, l)) / (dist(j, k) * dist(j, k));
+                        }
+                    }
+                    dw = -weights(j, l) * dA / (A * A);
+                }
+                jacobian.block(3 * j, i, 3, 1) -= eff_Phi.segment(l * 3, 3) * dw + eff_jacobian.block(3 * l, i, 3, 1) * w;
+            }
+        }
+    }
+}
+
+TEST(ExoticaTaskMaps, testIMeshJacobian)
+{
+    try
+    {
+        TEST_COUT << "Comparing the interaction mesh Jacobian against the reference implementation";
+        for (int trial = 0; trial < num_trials_; ++trial)
+        {
+            const int M = 2 + trial % 20;
+            const int N = 1 + trial % 10;
+            const Eigen::VectorXd eff_Phi = Eigen::VectorXd::Random(3 * M);
+            const Eigen::MatrixXd eff_jacobian = Eigen::MatrixXd::Random(3 * M, N);
+            // Sparse weights with about half of the connections removed
+            const Eigen::MatrixXd weights = (trial % 2 == 0) ? Eigen::MatrixXd::Ones(M, M) : Eigen::MatrixXd(Eigen::MatrixXd::Random(M, M).cwiseMax(0.0));
+
+            Eigen::VectorXd phi_reference;
+            Eigen::MatrixXd jacobian_reference;
+            ReferenceIMeshJacobian(eff_Phi, eff_jacobian, weights, phi_reference, jacobian_reference);
+
+            Eigen::VectorXd phi(3 * M);
+            Eigen::MatrixXd jacobian(3 * M, N);
+            InteractionMesh::ComputeLaplaceJacobian(eff_Phi, eff_jacobian, weights, InteractionMesh::ComputeNeighbours(weights), phi, jacobian);
+
+            EXPECT_LT((phi - phi_reference).norm(), 1e-10);
+            EXPECT_LT((jacobian - jacobian_reference).norm(), 1e-10);
+        }
+
+        TEST_COUT << "Benchmarking 40 markers and 30 joints";
+        constexpr int num_iterations = 100;
+        const int M = 40;
+        const int N = 30;
+        const Eigen::VectorXd eff_Phi = Eigen::VectorXd::Random(3 * M);
+        const Eigen::MatrixXd eff_jacobian = Eigen::MatrixXd::Random(3 * M, N);
+        const Eigen::MatrixXd weights = Eigen::MatrixXd::Ones(M, M);
+        const std::vector<std::vector<int>> neighbours = InteractionMesh::ComputeNeighbours(weights);
+        Eigen::VectorXd phi(3 * M);
+        Eigen::MatrixXd jacobian(3 * M, N);
+
+        Timer timer;
+        for (int i = 0; i < num_iterations; ++i) ReferenceIMeshJacobian(eff_Phi, eff_jacobian, weights, phi, jacobian);
+        const double reference_time = timer.GetDuration();
+        timer.Reset();
+        for (int i = 0; i < num_iterations; ++i) InteractionMesh::ComputeLaplaceJacobian(eff_Phi, eff_jacobian, weights, neighbours, phi, jacobian);
+        const double time = timer.GetDuration();
+        TEST_COUT << "Reference " << reference_time / num_iterations * 1e3 << "ms, neighbour lists " << time / num_iterations * 1e3 << "ms (" << reference_time / time << "x)";
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
 TEST(ExoticaTaskMaps, testPoint2Line)
 {
     try
@@ -1259,6 +1351,50 @@ TEST(ExoticaTaskMaps, testManipulability)
     }
 }
 
+TEST(ExoticaTaskMaps, testJacobianDerivative)
+{
+    try
+    {
+        TEST_COUT << "Jacobian derivative kernel test";
+        Initializer map("exotica/EffFrame", {{"Name", std::string("MyTask")},
+                                             {"EndEffector", std::vector<Initializer>({Initializer("Frame", {{"Link", std::string("endeff")}})})}});
+        UnconstrainedEndPoseProblemPtr problem = setup_problem(map);
+        KinematicTree& tree = problem->GetScene()->GetKinematicTree();
+
+        // Compare the O(n) kernel against the pairwise sum on the test robot and on larger random Jacobians.
+        for (int i = 0; i < num_trials_; ++i)
+        {
+            problem->Update(tree.GetRandomControlledState());
+            std::vector<KDL::Jacobian> jacobians(2, KDL::Jacobian(problem->N));
+            jacobians[0].data = tree.Jacobian("endeff", KDL::Frame(), "", KDL::Frame());
+            jacobians[1].data.setRandom(6, 40);
+            for (const KDL::Jacobian& jacobian : jacobians)
+            {
+                tree.SetJacobianDerivativeMethod(JDOT_PAIRWISE);
+                const Eigen::MatrixXd jacobian_dot_pairwise = tree.Jdot(jacobian);
+                tree.SetJacobianDerivativeMethod(JDOT_PREFIX_SUM);
+                const Eigen::MatrixXd jacobian_dot_prefix_sum = tree.Jdot(jacobian);
+                ASSERT_EQ(jacobian_dot_pairwise.cols(), jacobian_dot_prefix_sum.cols());
+                double err = (jacobian_dot_pairwise - jacobian_dot_prefix_sum).norm();
+                if (err > 1e-10)
+                {
+                    TEST_COUT << "J:\n"
+                              << jacobian.data;
+                    TEST_COUT << "Jdot (pairwise):\n"
+                              << jacobian_dot_pairwise;
+                    TEST_COUT << "Jdot (prefix sum):\n"
+                              << jacobian_dot_prefix_sum;
+                    ADD_FAILURE() << "Jacobian derivative error out of bounds: " << err;
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
 int main(int argc, char** argv)
 {
     testing::InitGoogleTest(&argc, argv);
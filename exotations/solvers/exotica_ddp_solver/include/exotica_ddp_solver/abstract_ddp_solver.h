@@ -34,7 +34,10 @@
 #include <exotica_core/problems/dynamic_time_indexed_shooting_problem.h>
 #include <exotica_core/server.h>
 #include <exotica_core/tools/conversions.h>
+#include <exotica_core/tools/thread_pool.h>
+#include <exotica_core/tools/timer.h>
 #include <exotica_ddp_solver/abstract_ddp_solver_initializer.h>
+#include <exotica_ddp_solver/ddp_workspace.h>
 
 namespace exotica
 {
@@ -47,6 +50,16 @@ public:
     ///@param solution Returned solution trajectory as a vector of joint configurations.
     void Solve(Eigen::MatrixXd& solution) override;
 
+    ///\brief Re-solves the problem from a new start state in receding-horizon (MPC) fashion.
+    ///     The controls, states and gains of the previous solve are shifted by one step and rolled
+    ///     out from x0 with the shifted feedback gains. The regularisation is carried over and at most
+    ///     MaxIterations iterations are run within MPCTimeBudget. No buffers are reallocated, hence the
+    ///     horizon has to match the previous Solve. The problem is not re-initialised: goals and weights
+    ///     have to be updated in place beforehand using the setters of the problem and its cost task.
+    ///@param x0 Current state, replaces the start state of the problem.
+    ///@param solution Returned control trajectory as a vector of controls.
+    void SolveMPC(Eigen::VectorXdRefConst x0, Eigen::MatrixXd& solution);
+
     ///\brief Binds the solver to a specific problem which must be pre-initalised
     ///@param pointer Shared pointer to the motion planning problem
     ///@return        Successful if the problem is a valid DynamicTimeIndexedProblem
@@ -54,6 +67,9 @@ public:
 
     Eigen::VectorXd GetFeedbackControl(Eigen::VectorXdRefConst x, int t) const override;
 
+    const std::vector<Eigen::MatrixXd>& get_K_gains() const { return K_gains_; }  ///< Returns the feedback gains of the last solve.
+    const std::vector<Eigen::MatrixXd>& get_k_gains() const { return k_gains_; }  ///< Returns the feed-forward gains of the last solve.
+
 protected:
     DynamicTimeIndexedShootingProblemPtr prob_;       ///!< Shared pointer to the planning problem.
     DynamicsSolverPtr dynamics_solver_;               ///!< Shared pointer to the dynamics solver.
@@ -70,6 +86,22 @@ protected:
     /// @return The cost associated with the new control and state trajectory.
     double ForwardPass(const double alpha, Eigen::MatrixXdRefConst ref_x, Eigen::MatrixXdRefConst ref_u);
 
+    ///\brief Preallocated vectors of a forward pass. Concurrent rollouts use separate buffers.
+    struct ForwardPassBuffers
+    {
+        Eigen::VectorXd u_hat;    ///!< Control of the current timestep.
+        Eigen::VectorXd x_delta;  ///!< Deviation of the state from the reference trajectory.
+    };
+
+    ///\brief Forward simulates the dynamics on the given problem using the gains
+    ///     computed in the last BackwardPass;
+    /// @param problem The problem to roll out, either prob_ or one of its copies.
+    /// @param buffers The buffers of the rollout on problem.
+    /// @param alpha The learning rate.
+    /// @param ref_trajectory The reference state trajectory.
+    /// @return The cost associated with the new control and state trajectory.
+    double ForwardPass(DynamicTimeIndexedShootingProblem& problem, ForwardPassBuffers& buffers, const double alpha, Eigen::MatrixXdRefConst ref_x, Eigen::MatrixXdRefConst ref_u);
+
     AbstractDDPSolverInitializer base_parameters_;
 
     inline void IncreaseRegularization()
@@ -93,13 +125,59 @@ protected:
     double cost_prev_;   ///!< Cost during previous iteration
     double alpha_best_;  ///!< Line-search step taken
     double time_taken_forward_pass_, time_taken_backward_pass_;
-    Eigen::MatrixXd U_try_;   ///!< Updated control trajectory during iteration.
-    Eigen::MatrixXd U_prev_;  ///!< Last accepted control trajectory
-    Eigen::MatrixXd X_ref_;   ///!< Reference state trajectory for feedback control.
-    Eigen::MatrixXd U_ref_;   ///!< Reference control trajectory for feedback control.
-    Eigen::MatrixXd Qx_, Qu_, Qxx_, Quu_, Qux_, Quu_inv_, Vxx_;
-    Eigen::VectorXd Vx_;
-    Eigen::MatrixXd fx_, fu_;
+    Eigen::MatrixXd U_try_;           ///!< Updated control trajectory during iteration.
+    Eigen::MatrixXd U_prev_;          ///!< Last accepted control trajectory
+    Eigen::MatrixXd X_ref_;           ///!< Reference state trajectory for feedback control.
+    Eigen::MatrixXd U_ref_;           ///!< Reference control trajectory for feedback control.
+    Eigen::MatrixXd control_limits_;  ///!< Control limits used in the forward pass, copied at the beginning of solve.
+    DDPWorkspace workspace_;          ///!< Preallocated matrices of the backward pass for systems without a compile-time-sized workspace.
+
+    std::vector<ForwardPassBuffers> forward_pass_buffers_;  ///!< Buffers of the forward pass on prob_ (first) and on each of the line search workers.
+
+    std::unique_ptr<DDPWorkspaceT<2, 1>> workspace_2x1_;    ///!< Compile-time-sized workspace, e.g. for the pendulum.
+    std::unique_ptr<DDPWorkspaceT<4, 1>> workspace_4x1_;    ///!< Compile-time-sized workspace, e.g. for the cartpole.
+    std::unique_ptr<DDPWorkspaceT<4, 2>> workspace_4x2_;    ///!< Compile-time-sized workspace, e.g. for the planar double integrator.
+    std::unique_ptr<DDPWorkspaceT<12, 4>> workspace_12x4_;  ///!< Compile-time-sized workspace, e.g. for the quadrotor.
+
+    ///\brief Sizes the backward pass workspace for NX_ and NU_. Small systems
+    ///     with a matching compile-time-sized workspace use that one instead of workspace_.
+    void ResizeWorkspace();
+
+    ///\brief Calls solver.BackwardPass(workspace) with the compile-time-sized
+    ///     workspace set up by ResizeWorkspace, or with workspace_ if there is none.
+    /// @param solver The derived solver, which implements the backward pass as a template on the workspace type.
+    template <typename Solver>
+    void DispatchBackwardPass(Solver& solver)
+    {
+        if (workspace_2x1_)
+            solver.BackwardPass(*workspace_2x1_);
+        else if (workspace_4x1_)
+            solver.BackwardPass(*workspace_4x1_);
+        else if (workspace_4x2_)
+            solver.BackwardPass(*workspace_4x2_);
+        else if (workspace_12x4_)
+            solver.BackwardPass(*workspace_12x4_);
+        else
+            solver.BackwardPass(workspace_);
+    }
+
+private:
+    ///\brief Runs the DDP iterations starting from the reference trajectories and cost of the
+    ///     initial roll-out, and stores the best solution found.
+    /// @param solution Returned control trajectory.
+    /// @param planning_timer Timer started at the beginning of the solve.
+    /// @param time_budget Time in seconds after which no further iteration is started (unlimited if not positive).
+    void Optimize(Eigen::MatrixXd& solution, const Timer& planning_timer, double time_budget);
+
+    ///\brief Creates and synchronises the problem copies used by the parallel line search and starts a thread for each.
+    void UpdateLineSearchWorkers();
+
+    ///\brief Evaluates the step sizes in batches of NumThreadsLineSearch concurrent
+    ///     rollouts and accepts the first one in alpha_space_ that improves the cost.
+    void ParallelLineSearch();
+
+    std::vector<DynamicTimeIndexedShootingProblemPtr> line_search_workers_;  ///!< Independent problem copies for the parallel line search.
+    ThreadPool line_search_thread_pool_;                                      ///!< Persistent threads rolling out the step sizes on the problem copies.
 };
 
 }  // namespace exotica
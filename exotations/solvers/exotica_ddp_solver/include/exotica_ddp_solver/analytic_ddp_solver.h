@@ -32,7 +32,6 @@
 
 #include <exotica_ddp_solver/abstract_ddp_solver.h>
 #include <exotica_ddp_solver/analytic_ddp_solver_initializer.h>
-#include <unsupported/Eigen/CXX11/Tensor>
 
 namespace exotica
 {
@@ -43,12 +42,17 @@ class AnalyticDDPSolver : public AbstractDDPSolver, public Instantiable<Analytic
 public:
     void Instantiate(const AnalyticDDPSolverInitializer& init) override;
 
-private:
+protected:
     ///\brief Computes the control gains for a the trajectory in the associated
     ///     DynamicTimeIndexedProblem.
     void BackwardPass() override;
 
-    Eigen::LLT<Eigen::MatrixXd> Quu_llt_;
+private:
+    friend class AbstractDDPSolver;
+
+    ///\brief Runs the backward pass on a compile-time-sized or dynamic-size workspace.
+    template <typename Workspace>
+    void BackwardPass(Workspace& workspace);
 };
 }  // namespace exotica
 
@@ -33,7 +33,6 @@
 #include <exotica_core/tools/box_qp.h>
 #include <exotica_ddp_solver/abstract_ddp_solver.h>
 #include <exotica_ddp_solver/control_limited_ddp_solver_initializer.h>
-#include <unsupported/Eigen/CXX11/Tensor>
 
 namespace exotica
 {
@@ -44,10 +43,21 @@ class ControlLimitedDDPSolver : public AbstractDDPSolver, public Instantiable<Co
 public:
     void Instantiate(const ControlLimitedDDPSolverInitializer& init) override;
 
-private:
+protected:
     ///\brief Computes the control gains for a the trajectory in the associated
     ///     DynamicTimeIndexedProblem.
     void BackwardPass() override;
+
+private:
+    friend class AbstractDDPSolver;
+
+    ///\brief Runs the backward pass on a compile-time-sized or dynamic-size workspace.
+    template <typename Workspace>
+    void BackwardPass(Workspace& workspace);
+
+    Eigen::VectorXd low_limit_, high_limit_;  ///< Control limits relative to the current control, reused across timesteps.
+    BoxQPWorkspace boxqp_workspace_;          ///< Intermediate results of the box QP, reused across timesteps.
+    BoxQPSolution boxqp_solution_;            ///< Result of the box QP of the current timestep.
 };
 }  // namespace exotica
 
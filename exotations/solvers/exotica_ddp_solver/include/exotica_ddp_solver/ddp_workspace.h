@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2019, University of Edinburgh
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef EXOTICA_DDP_SOLVER_DDP_WORKSPACE_H_
+#define EXOTICA_DDP_SOLVER_DDP_WORKSPACE_H_
+
+#include <Eigen/Dense>
+#include <unsupported/Eigen/CXX11/Tensor>
+
+#include <exotica_core/tools/exception.h>
+
+namespace exotica
+{
+/// \brief Preallocated matrices of the DDP backward pass.
+///     All operations work in place on the buffers sized by Resize, so that the
+///     recursion does not allocate on the heap once the workspace has been sized.
+///     NX and NU fix the state and control dimension at compile time for small
+///     systems; the default (Eigen::Dynamic) sizes the buffers at runtime.
+template <int NX, int NU>
+struct DDPWorkspaceT
+{
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef Eigen::Matrix<double, NX, 1> StateVector;
+    typedef Eigen::Matrix<double, NU, 1> ControlVector;
+    typedef Eigen::Matrix<double, NX, NX> StateMatrix;
+    typedef Eigen::Matrix<double, NX, NU> StateControlMatrix;
+    typedef Eigen::Matrix<double, NU, NX> ControlStateMatrix;
+    typedef Eigen::Matrix<double, NU, NU> ControlMatrix;
+
+    /// \brief Sizes all buffers. Does not reallocate if the dimensions are unchanged.
+    void Resize(int num_states, int num_controls);
+
+    /// \brief Sets fx and fu to the discrete-time dynamics derivatives I + dt * fx_c and dt * fu_c.
+    void SetDynamicsDerivatives(const Eigen::MatrixXd& fx_c, const Eigen::MatrixXd& fu_c, double dt);
+
+    /// \brief Expands the Q-function around the current timestep using the value function of the next timestep.
+    /// @param lx, lu, lxx, luu, lux Derivatives of the running cost, scaled by dt.
+    /// @param state_regularization Added to the diagonal of Vxx before the expansion.
+    void ExpandQ(const Eigen::VectorXd& lx, const Eigen::VectorXd& lu, const Eigen::MatrixXd& lxx, const Eigen::MatrixXd& luu, const Eigen::MatrixXd& lux, double dt, double state_regularization = 0.0);
+
+    /// \brief Adds the second-order dynamics terms, i.e. the contractions of fxx, fuu and fxu with Vx, to the Q-function expansion.
+    void AddSecondOrderDynamics(const Eigen::Tensor<double, 3>& fxx, const Eigen::Tensor<double, 3>& fuu, const Eigen::Tensor<double, 3>& fxu, double dt);
+
+    /// \brief Adds the second-order dynamics terms already contracted with Vx (see DynamicsSolver::ContractedSecondOrderDerivatives) to the Q-function expansion.
+    void AddSecondOrderDynamics(const Eigen::MatrixXd& Vx_fxx_c, const Eigen::MatrixXd& Vx_fuu_c, const Eigen::MatrixXd& Vx_fxu_c, double dt);
+
+    /// \brief Inverts Quu into Quu_inv and computes the gains k = -Quu_inv * Qu and K = -Quu_inv * Qux.
+    void ComputeGains(Eigen::MatrixXd& K, Eigen::MatrixXd& k);
+
+    /// \brief Propagates the value function to the current timestep for arbitrary gains K and k.
+    void UpdateValueFunction(const Eigen::MatrixXd& K, const Eigen::MatrixXd& k);
+
+    /// \brief Adds scale * (f contracted with v along its second index) to out, as Eigen::Tensor::contract would.
+    ///     out is interpreted with the dimensions of the contraction (first and third dimension of f).
+    template <typename Vector, typename Matrix>
+    static void AddContraction(const Eigen::Tensor<double, 3>& f, const Vector& v, double scale, Matrix& out)
+    {
+        const Eigen::Index rows = f.dimension(0), inner = f.dimension(1), cols = f.dimension(2);
+        if (inner != v.size() || rows * cols != out.size()) ThrowPretty("Dimension mismatch! Cannot contract a " << rows << "x" << inner << "x" << cols << " tensor with a vector of size " << v.size() << " into a " << out.rows() << "x" << out.cols() << " matrix.");
+
+        // Each slice f(:, :, k) is a column-major rows x inner matrix.
+        Eigen::Map<Eigen::MatrixXd> result(out.data(), rows, cols);
+        for (Eigen::Index k = 0; k < cols; ++k)
+        {
+            result.col(k).noalias() += scale * Eigen::Map<const Eigen::MatrixXd>(f.data() + k * rows * inner, rows, inner) * v;
+        }
+    }
+
+    Eigen::VectorXd x;                          ///< State of the current timestep, sized like the arguments of the DynamicsSolver.
+    Eigen::VectorXd u;                          ///< Control of the current timestep, sized like the arguments of the DynamicsSolver.
+    Eigen::VectorXd Vx_arg;                     ///< Copy of Vx, sized like the arguments of the DynamicsSolver.
+    Eigen::VectorXd lx;                         ///< Derivative of the cost w.r.t. the state, sized like the results of the problem.
+    Eigen::VectorXd lu;                         ///< Derivative of the cost w.r.t. the control, sized like the results of the problem.
+    Eigen::MatrixXd lxx;                        ///< Second derivative of the cost w.r.t. the state, sized like the results of the problem.
+    Eigen::MatrixXd luu;                        ///< Second derivative of the cost w.r.t. the control, sized like the results of the problem.
+    Eigen::MatrixXd lux;                        ///< Mixed second derivative of the cost, sized like the results of the problem.
+    StateMatrix fx;                             ///< Discrete-time dynamics derivative w.r.t. the state.
+    StateControlMatrix fu;                      ///< Discrete-time dynamics derivative w.r.t. the control.
+    Eigen::MatrixXd Vx_fxx;                     ///< Continuous-time fxx contracted with Vx, sized like the results of the DynamicsSolver.
+    Eigen::MatrixXd Vx_fuu;                     ///< Continuous-time fuu contracted with Vx, sized like the results of the DynamicsSolver.
+    Eigen::MatrixXd Vx_fxu;                     ///< Continuous-time fxu contracted with Vx, sized like the results of the DynamicsSolver.
+    StateVector Qx;                             ///< Gradient of the Q-function w.r.t. the state.
+    ControlVector Qu;                           ///< Gradient of the Q-function w.r.t. the control.
+    StateMatrix Qxx;                            ///< Hessian of the Q-function w.r.t. the state.
+    ControlMatrix Quu;                          ///< Hessian of the Q-function w.r.t. the control.
+    ControlStateMatrix Qux;                     ///< Mixed Hessian of the Q-function (Qux = Qxu^T).
+    ControlMatrix Quu_inv;                      ///< Inverse of the control Hessian.
+    StateVector Vx;                             ///< Gradient of the value function.
+    StateMatrix Vxx;                            ///< Hessian of the value function.
+    StateMatrix Vxx_fx;                         ///< Product of Vxx with fx.
+    StateControlMatrix Vxx_fu;                  ///< Product of Vxx with fu.
+    ControlStateMatrix Quu_K;                   ///< Product of Quu with the feedback gain.
+    ControlVector Quu_k;                        ///< Product of Quu with the feedforward gain.
+    Eigen::PartialPivLU<ControlMatrix> Quu_lu;  ///< Decomposition used to invert Quu.
+};
+
+typedef DDPWorkspaceT<Eigen::Dynamic, Eigen::Dynamic> DDPWorkspace;
+
+// Fixed-size workspaces for the dimensions of the pendulum and double integrator (2 x 1), cartpole (4 x 1),
+// planar double integrator (4 x 2) and quadrotor (12 x 4), used by the analytic and control-limited DDP
+// backward passes. The dynamics solvers and the cost derivatives stay dynamic-size: fx and fu are copied
+// into the fixed-size buffers by SetDynamicsDerivatives, the cost terms enter through ExpandQ.
+extern template struct DDPWorkspaceT<Eigen::Dynamic, Eigen::Dynamic>;
+extern template struct DDPWorkspaceT<2, 1>;
+extern template struct DDPWorkspaceT<4, 1>;
+extern template struct DDPWorkspaceT<4, 2>;
+extern template struct DDPWorkspaceT<12, 4>;
+}  // namespace exotica
+
+#endif  // EXOTICA_DDP_SOLVER_DDP_WORKSPACE_H_
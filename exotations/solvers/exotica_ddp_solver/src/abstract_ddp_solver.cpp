@@ -27,14 +27,18 @@
 // POSSIBILITY OF SUCH DAMAGE.
 //
 
+#include <exotica_core/setup.h>
 #include <exotica_ddp_solver/abstract_ddp_solver.h>
 
+#include <algorithm>
+#include <exception>
+
 namespace exotica
 {
 void AbstractDDPSolver::Solve(Eigen::MatrixXd& solution)
 {
     if (!prob_) ThrowNamed("Solver has not been initialized!");
-    Timer planning_timer, backward_pass_timer, line_search_timer;
+    Timer planning_timer;
 
     T_ = prob_->get_T();
     NU_ = prob_->get_num_controls();
@@ -43,6 +47,7 @@ void AbstractDDPSolver::Solve(Eigen::MatrixXd& solution)
     lambda_ = base_parameters_.RegularizationRate;
     prob_->ResetCostEvolution(GetNumberOfMaxIterations() + 1);
     prob_->PreUpdate();
+    UpdateLineSearchWorkers();
     solution.resize(T_ - 1, NU_);
 
     // Perform initial roll-out
@@ -59,9 +64,12 @@ void AbstractDDPSolver::Solve(Eigen::MatrixXd& solution)
     cost_ += prob_->GetStateCost(T_ - 1);
     prob_->SetCostEvolution(0, cost_);
 
-    // Initialize gain matrices
-    K_gains_.assign(T_, Eigen::MatrixXd(NU_, NX_));
-    k_gains_.assign(T_, Eigen::VectorXd(NU_, 1));
+    // Initialize gain matrices, unless they can be reused from the previous solve
+    if (static_cast<int>(K_gains_.size()) != T_ || K_gains_[0].rows() != NU_ || K_gains_[0].cols() != NX_)
+    {
+        K_gains_.assign(T_, Eigen::MatrixXd(NU_, NX_));
+        k_gains_.assign(T_, Eigen::VectorXd(NU_, 1));
+    }
 
     // Allocate memory by resizing commonly reused matrices:
     X_ref_.resize(NX_, T_);
@@ -69,17 +77,64 @@ void AbstractDDPSolver::Solve(Eigen::MatrixXd& solution)
     X_ref_ = prob_->get_X();
     U_ref_ = prob_->get_U();
     U_try_ = prob_->get_U();  // to resize/allocate
-    // TODO: Resize the following:
-    // Qx_, Qu_, Qxx_, Quu_, Qux_, Quu_inv_, Vxx_;
-    // Vx_; fx_, fu_;
+    ResizeWorkspace();
+    if (base_parameters_.ClampControlsInForwardPass) control_limits_ = dynamics_solver_->get_control_limits();
 
     if (debug_) HIGHLIGHT_NAMED("DDPSolver", "Running DDP solver for max " << GetNumberOfMaxIterations() << " iterations");
 
+    Optimize(solution, planning_timer, 0.0);
+}
+
+void AbstractDDPSolver::SolveMPC(Eigen::VectorXdRefConst x0, Eigen::MatrixXd& solution)
+{
+    if (!prob_) ThrowNamed("Solver has not been initialized!");
+    if (prob_->get_T() != T_ || static_cast<int>(K_gains_.size()) != T_ || U_ref_.cols() != T_ - 1) ThrowNamed("SolveMPC requires a previous call to Solve with the same horizon.");
+    if (x0.size() != NX_) ThrowNamed("Wrong start state size: " << x0.size() << " expecting " << NX_);
+    Timer planning_timer;
+
+    prob_->ResetCostEvolution(GetNumberOfMaxIterations() + 1);
+    solution.resize(T_ - 1, NU_);
+
+    // Shift the previous solution by one step in place, repeating the last state, control and gains
+    for (int t = 0; t < T_ - 1; ++t)
+    {
+        X_ref_.col(t) = X_ref_.col(t + 1);
+        if (t < T_ - 2) U_ref_.col(t) = U_ref_.col(t + 1);
+    }
+    std::rotate(K_gains_.begin(), K_gains_.begin() + 1, K_gains_.end());
+    std::rotate(k_gains_.begin(), k_gains_.begin() + 1, k_gains_.end());
+    if (T_ > 2)
+    {
+        K_gains_[T_ - 2] = K_gains_[T_ - 3];
+        k_gains_[T_ - 2] = k_gains_[T_ - 3];
+    }
+
+    // Roll out the shifted policy from the new start state (alpha = 0 only applies the feedback gains).
+    // The shifted prediction remains the feedback reference, so that the deviation of x0 is corrected.
+    prob_->set_X(x0, 0);
+    cost_ = ForwardPass(0.0, X_ref_, U_ref_);
+    U_ref_ = prob_->get_U();
+    X_ref_ = prob_->get_X();
+    prob_->SetCostEvolution(0, cost_);
+
+    // The scene of the line search workers is left as it is, only the trajectories and goals are synced
+    for (auto& worker : line_search_workers_) worker->CopyTrajectoriesFrom(*prob_);
+
+    if (debug_) HIGHLIGHT_NAMED("DDPSolver", "Running DDP solver in receding-horizon mode for max " << GetNumberOfMaxIterations() << " iterations");
+
+    Optimize(solution, planning_timer, base_parameters_.MPCTimeBudget);
+}
+
+void AbstractDDPSolver::Optimize(Eigen::MatrixXd& solution, const Timer& planning_timer, double time_budget)
+{
+    Timer iteration_timer, backward_pass_timer, line_search_timer;
     cost_prev_ = cost_;
     int last_best_iteration = 0;
 
     for (int iteration = 1; iteration <= GetNumberOfMaxIterations(); ++iteration)
     {
+        iteration_timer.Reset();
+
         // Check whether user interrupted (Ctrl+C)
         if (Server::IsRos() && !ros::ok())
         {
@@ -96,21 +151,28 @@ void AbstractDDPSolver::Solve(Eigen::MatrixXd& solution)
         // Forward-pass to compute new control trajectory
         line_search_timer.Reset();
 
-        double rollout_cost = cost_prev_;
-        // Perform a linear search to find the best rate
-        for (int ai = 0; ai < alpha_space_.size(); ++ai)
+        if (line_search_workers_.empty())
         {
-            const double& alpha = alpha_space_(ai);
-            rollout_cost = ForwardPass(alpha, X_ref_, U_ref_);
-
-            if (rollout_cost < cost_)
+            double rollout_cost = cost_prev_;
+            // Perform a linear search to find the best rate
+            for (int ai = 0; ai < alpha_space_.size(); ++ai)
             {
-                cost_ = rollout_cost;
-                U_try_ = prob_->get_U();
-                alpha_best_ = alpha;
-                break;
+                const double& alpha = alpha_space_(ai);
+                rollout_cost = ForwardPass(alpha, X_ref_, U_ref_);
+
+                if (rollout_cost < cost_)
+                {
+                    cost_ = rollout_cost;
+                    U_try_ = prob_->get_U();
+                    alpha_best_ = alpha;
+                    break;
+                }
             }
         }
+        else
+        {
+            ParallelLineSearch();
+        }
         time_taken_forward_pass_ = line_search_timer.GetDuration();
 
         // Finiteness checks
@@ -118,13 +180,15 @@ void AbstractDDPSolver::Solve(Eigen::MatrixXd& solution)
         {
             prob_->termination_criterion = TerminationCriterion::Divergence;
             WARNING_NAMED("DDPSolver", "Divergence: Controls are non-finite");
-            return;
+            lambda_ = base_parameters_.RegularizationRate;
+            break;
         }
         if (!std::isfinite(cost_))
         {
             prob_->termination_criterion = TerminationCriterion::Divergence;
             WARNING_NAMED("DDPSolver", "Divergence: Cost is non-finite: " << cost_);
-            return;
+            lambda_ = base_parameters_.RegularizationRate;
+            break;
         }
 
         if (debug_)
@@ -168,7 +232,8 @@ void AbstractDDPSolver::Solve(Eigen::MatrixXd& solution)
         {
             prob_->termination_criterion = TerminationCriterion::Divergence;
             WARNING_NAMED("DDPSolver", "Divergence: Regularization too large (" << lambda_ << ")");
-            return;
+            lambda_ = base_parameters_.RegularizationRate;
+            break;
         }
 
         // If better than previous iteration, copy solutions for next iteration
@@ -210,9 +275,18 @@ void AbstractDDPSolver::Solve(Eigen::MatrixXd& solution)
             if (debug_) HIGHLIGHT_NAMED("DDPSolver", "Max iterations reached. Time: " << planning_timer.GetDuration());
             prob_->termination_criterion = TerminationCriterion::IterationLimit;
         }
+
+        // Time budget: stop unless another iteration of the same duration still fits
+        if (time_budget > 0.0 && planning_timer.GetDuration() + iteration_timer.GetDuration() > time_budget)
+        {
+            if (debug_) HIGHLIGHT_NAMED("DDPSolver", "Time budget reached after " << iteration << " iterations. Time: " << planning_timer.GetDuration());
+            prob_->termination_criterion = TerminationCriterion::IterationLimit;
+            break;
+        }
     }
 
-    // Store the best solution found over all iterations
+    // Store the best solution found over all iterations, which is the last accepted one also after a divergence.
+    // The regularisation is reset on divergence so that later receding-horizon solves can recover.
     for (int t = 0; t < T_ - 1; ++t)
     {
         solution.row(t) = U_ref_.col(t).transpose();
@@ -231,6 +305,12 @@ void AbstractDDPSolver::SpecifyProblem(PlanningProblemPtr pointer)
     MotionSolver::SpecifyProblem(pointer);
     prob_ = std::static_pointer_cast<DynamicTimeIndexedShootingProblem>(pointer);
     dynamics_solver_ = prob_->GetScene()->GetDynamicsSolver();
+    line_search_workers_.clear();
+
+    // Allocate the workspace for the current problem dimensions (resized in Solve if they change)
+    NU_ = prob_->get_num_controls();
+    NX_ = prob_->get_num_positions() + prob_->get_num_velocities();
+    ResizeWorkspace();
 
     // Set up backtracking line-search coefficients
     alpha_space_ = Eigen::VectorXd::LinSpaced(11, 0.0, -3.0);
@@ -242,10 +322,43 @@ void AbstractDDPSolver::SpecifyProblem(PlanningProblemPtr pointer)
     if (debug_) HIGHLIGHT_NAMED("DDPSolver", "initialized");
 }
 
+namespace
+{
+template <int NX, int NU>
+void SetUpWorkspace(int num_states, int num_controls, std::unique_ptr<DDPWorkspaceT<NX, NU>>& workspace)
+{
+    if (num_states != NX || num_controls != NU)
+    {
+        workspace.reset();
+    }
+    else
+    {
+        // Sizes the buffers which are shared with the dynamics solver and the problem, and hence not compile-time-sized
+        if (!workspace) workspace.reset(new DDPWorkspaceT<NX, NU>());
+        workspace->Resize(num_states, num_controls);
+    }
+}
+}  // namespace
+
+void AbstractDDPSolver::ResizeWorkspace()
+{
+    SetUpWorkspace(NX_, NU_, workspace_2x1_);
+    SetUpWorkspace(NX_, NU_, workspace_4x1_);
+    SetUpWorkspace(NX_, NU_, workspace_4x2_);
+    SetUpWorkspace(NX_, NU_, workspace_12x4_);
+    if (!workspace_2x1_ && !workspace_4x1_ && !workspace_4x2_ && !workspace_12x4_) workspace_.Resize(NX_, NU_);
+}
+
 double AbstractDDPSolver::ForwardPass(const double alpha, Eigen::MatrixXdRefConst X_ref, Eigen::MatrixXdRefConst U_ref)
+{
+    return ForwardPass(*prob_, forward_pass_buffers_[0], alpha, X_ref, U_ref);
+}
+
+double AbstractDDPSolver::ForwardPass(DynamicTimeIndexedShootingProblem& problem, ForwardPassBuffers& buffers, const double alpha, Eigen::MatrixXdRefConst X_ref, Eigen::MatrixXdRefConst U_ref)
 {
     double cost = 0.0;
-    Eigen::VectorXd u_hat(NU_);  // TODO: allocate outside
+    Eigen::VectorXd& u_hat = buffers.u_hat;
+    const DynamicsSolverPtr& dynamics_solver = problem.GetScene()->GetDynamicsSolver();
 
     for (int t = 0; t < T_ - 1; ++t)
     {
@@ -253,23 +366,92 @@ double AbstractDDPSolver::ForwardPass(const double alpha, Eigen::MatrixXdRefCons
 
         // eq. 12 - TODO: Which paper?
         u_hat.noalias() += alpha * k_gains_[t];
-        u_hat.noalias() += K_gains_[t] * dynamics_solver_->StateDelta(prob_->get_X(t), X_ref.col(t));
+        dynamics_solver->StateDelta(problem.get_X().col(t), X_ref.col(t), buffers.x_delta);
+        u_hat.noalias() += K_gains_[t] * buffers.x_delta;
 
         // Clamp controls, if desired:
         if (base_parameters_.ClampControlsInForwardPass)
         {
-            u_hat = u_hat.cwiseMax(dynamics_solver_->get_control_limits().col(0)).cwiseMin(dynamics_solver_->get_control_limits().col(1));
+            u_hat = u_hat.cwiseMax(control_limits_.col(0)).cwiseMin(control_limits_.col(1));
         }
 
-        prob_->Update(u_hat, t);
-        cost += dt_ * (prob_->GetControlCost(t) + prob_->GetStateCost(t));
+        problem.Update(u_hat, t);
+        cost += dt_ * (problem.GetControlCost(t) + problem.GetStateCost(t));
     }
 
     // add terminal cost
-    cost += prob_->GetStateCost(T_ - 1);
+    cost += problem.GetStateCost(T_ - 1);
     return cost;
 }
 
+void AbstractDDPSolver::UpdateLineSearchWorkers()
+{
+    if (base_parameters_.NumThreadsLineSearch < 1) ThrowNamed("NumThreadsLineSearch has to be at least 1, got " << base_parameters_.NumThreadsLineSearch);
+
+    // Noisy rollouts draw from the problem's random number generator in
+    // sequence, which the concurrent rollouts could not reproduce.
+    const int num_workers = prob_->get_stochastic_updates_enabled() ? 0 : std::min(base_parameters_.NumThreadsLineSearch, static_cast<int>(alpha_space_.size())) - 1;
+    if (static_cast<int>(line_search_workers_.size()) > num_workers) line_search_workers_.resize(num_workers);
+    while (static_cast<int>(line_search_workers_.size()) < num_workers)
+    {
+        DynamicTimeIndexedShootingProblemInitializer init(prob_->GetParameters());
+        DynamicTimeIndexedShootingProblemPtr worker = std::dynamic_pointer_cast<DynamicTimeIndexedShootingProblem>(Setup::CreateProblem(Initializer(init)));
+        if (!worker) ThrowNamed("Failed to create a copy of the problem for the parallel line search.");
+        line_search_workers_.push_back(worker);
+    }
+    line_search_thread_pool_.Resize(num_workers);
+
+    for (auto& worker : line_search_workers_) worker->CopyStateFrom(*prob_);
+
+    // Buffers of the rollouts on prob_ and on each of the workers
+    forward_pass_buffers_.resize(line_search_workers_.size() + 1);
+    for (auto& buffers : forward_pass_buffers_)
+    {
+        buffers.u_hat.resize(NU_);
+        buffers.x_delta.resize(NX_);
+    }
+}
+
+void AbstractDDPSolver::ParallelLineSearch()
+{
+    const int num_threads = static_cast<int>(line_search_workers_.size()) + 1;
+    std::vector<double> rollout_costs(num_threads);
+    std::vector<std::exception_ptr> exceptions(num_threads);
+    for (int batch_begin = 0; batch_begin < alpha_space_.size(); batch_begin += num_threads)
+    {
+        const int batch_size = std::min(num_threads, static_cast<int>(alpha_space_.size()) - batch_begin);
+
+        // The first step size of the batch is rolled out on prob_, the others on its copies on the persistent threads.
+        // Exceptions are kept per step size, since the serial line search would not reach those after an accepted one.
+        line_search_thread_pool_.Run([&](int i) {
+            if (i >= batch_size) return;
+            DynamicTimeIndexedShootingProblem& problem = i == 0 ? *prob_ : *line_search_workers_[i - 1];
+            exceptions[i] = nullptr;
+            try
+            {
+                rollout_costs[i] = ForwardPass(problem, forward_pass_buffers_[i], alpha_space_(batch_begin + i), X_ref_, U_ref_);
+            }
+            catch (...)
+            {
+                exceptions[i] = std::current_exception();
+            }
+        });
+
+        // Visit the results in order so that the outcome matches the serial line search.
+        for (int i = 0; i < batch_size; ++i)
+        {
+            if (exceptions[i]) std::rethrow_exception(exceptions[i]);
+            if (rollout_costs[i] < cost_)
+            {
+                cost_ = rollout_costs[i];
+                U_try_ = (i == 0) ? prob_->get_U() : line_search_workers_[i - 1]->get_U();
+                alpha_best_ = alpha_space_(batch_begin + i);
+                return;
+            }
+        }
+    }
+}
+
 Eigen::VectorXd AbstractDDPSolver::GetFeedbackControl(Eigen::VectorXdRefConst x, int t) const
 {
     Eigen::VectorXd u = U_ref_.col(t) + k_gains_[t] + K_gains_[t] * dynamics_solver_->StateDelta(x, X_ref_.col(t));
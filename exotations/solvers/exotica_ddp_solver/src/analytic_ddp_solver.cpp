@@ -39,88 +39,59 @@ void AnalyticDDPSolver::Instantiate(const AnalyticDDPSolverInitializer& init)
     base_parameters_ = AbstractDDPSolverInitializer(AnalyticDDPSolverInitializer(parameters_));
 }
 
-void AnalyticDDPSolver::BackwardPass()
+template <typename Workspace>
+void AnalyticDDPSolver::BackwardPass(Workspace& workspace)
 {
-    Vx_ = prob_->GetStateCostJacobian(T_ - 1);
-    Vxx_ = prob_->GetStateCostHessian(T_ - 1);
-
-    // concatenation axis for tensor products
-    //  See https://eigen.tuxfamily.org/dox-devel/unsupported/eigen_tensors.html#title14
-    Eigen::array<Eigen::IndexPair<int>, 1> dims = {Eigen::IndexPair<int>(1, 0)};
-    Eigen::Tensor<double, 1> Vx_tensor;
+    prob_->GetStateCostJacobian(T_ - 1, workspace.lx);
+    prob_->GetStateCostHessian(T_ - 1, workspace.lxx);
+    workspace.Vx = workspace.lx;
+    workspace.Vxx = workspace.lxx;
+    prob_->GetControlCostHessian(workspace.luu);
+    prob_->GetStateControlCostHessian(workspace.lux);
 
-    Eigen::VectorXd x(NX_), u(NU_);               // TODO: Replace
-    Quu_inv_.resize(NU_, NU_);                    // TODO: Allocate outside
-    Quu_llt_ = Eigen::LLT<Eigen::MatrixXd>(NU_);  // TODO: Allocate outside
     for (int t = T_ - 2; t >= 0; t--)
     {
-        x = prob_->get_X(t);
-        u = prob_->get_U(t);
+        workspace.x = prob_->get_X().col(t);
+        workspace.u = prob_->get_U().col(t);
 
-        fx_ = dt_ * dynamics_solver_->fx(x, u) + Eigen::MatrixXd::Identity(NX_, NX_);
-        fu_ = dt_ * dynamics_solver_->fu(x, u);
+        // Computes the dynamics derivatives of this timestep in a single pass.
+        dynamics_solver_->ComputeDerivatives(workspace.x, workspace.u);
+        workspace.SetDynamicsDerivatives(dynamics_solver_->get_fx(), dynamics_solver_->get_fu(), dt_);
 
         //
         // NB: We use a modified cost function to compare across different
         // time horizons - the running cost is scaled by dt_
         //
-        Qx_ = dt_ * prob_->GetStateCostJacobian(t) + fx_.transpose() * Vx_;  // lx + fx_ @ Vx_
-        Qu_ = dt_ * prob_->GetControlCostJacobian(t) + fu_.transpose() * Vx_;
-
-        // State regularization
-        Vxx_.diagonal().array() += lambda_;
-
-        // NB: Qux = Qxu^T
-        Qux_ = dt_ * prob_->GetStateControlCostHessian() + fu_.transpose() * Vxx_ * fx_;
-        Qxx_ = dt_ * prob_->GetStateCostHessian(t) + fx_.transpose() * Vxx_ * fx_;
-        Quu_ = dt_ * prob_->GetControlCostHessian() + fu_.transpose() * Vxx_ * fu_;
+        // State regularization (lambda_) is added to Vxx before the expansion.
+        prob_->GetStateCostJacobian(t, workspace.lx);
+        prob_->GetControlCostJacobian(t, workspace.lu);
+        prob_->GetStateCostHessian(t, workspace.lxx);
+        workspace.ExpandQ(workspace.lx, workspace.lu, workspace.lxx, workspace.luu, workspace.lux, dt_, lambda_);
 
         if (parameters_.UseSecondOrderDynamics)
         {
-            // clang-format off
-            Vx_tensor = Eigen::TensorMap<Eigen::Tensor<double, 1>>(Vx_.data(), NX_);
-
-            Qxx_ += 
-                Eigen::TensorToMatrix(
-                    (Eigen::Tensor<double, 2>)dynamics_solver_->fxx(x, u).contract(Vx_tensor, dims), NX_, NX_
-                ) * dt_;
-
-            Quu_ += 
-                Eigen::TensorToMatrix(
-                    (Eigen::Tensor<double, 2>)dynamics_solver_->fuu(x, u).contract(Vx_tensor, dims), NU_, NU_
-                ) * dt_;
-
-            Qux_ +=
-                Eigen::TensorToMatrix((Eigen::Tensor<double, 2>)dynamics_solver_->fxu(x, u).contract(Vx_tensor, dims), NU_, NX_
-                ) * dt_;
-            // clang-format on
+            // Contracted with Vx by the dynamics solver, which avoids forming the NX^3 tensors fxx, fuu and fxu.
+            workspace.Vx_arg = workspace.Vx;
+            dynamics_solver_->ContractedSecondOrderDerivatives(workspace.x, workspace.u, workspace.Vx_arg, workspace.Vx_fxx, workspace.Vx_fuu, workspace.Vx_fxu);
+            workspace.AddSecondOrderDynamics(workspace.Vx_fxx, workspace.Vx_fuu, workspace.Vx_fxu, dt_);
         }
 
         // Control regularization for numerical stability
-        Quu_.diagonal().array() += lambda_;
+        workspace.Quu.diagonal().array() += lambda_;
 
         // Compute gains
-        Quu_inv_ = Quu_.inverse();
-        // Quu_inv_ = Quu_.llt().solve(Eigen::MatrixXd::Identity(Quu_.rows(), Quu_.cols()));
-        k_gains_[t].noalias() = -Quu_inv_ * Qu_;
-        K_gains_[t].noalias() = -Quu_inv_ * Qux_;
-
-        // Using Cholesky decomposition:
-        // Quu_llt_.compute(Quu_);
-        // K_gains_[t] = -Qux_;
-        // Quu_llt_.solveInPlace(K_gains_[t]);
-        // k_gains_[t] = -Qu_;
-        // Quu_llt_.solveInPlace(k_gains_[t]);
-
-        // V = Q - 0.5 * (Qu_.transpose() * Quu_inv_ * Qu_)(0);
-        // Vx_ = Qx_ - K_gains_[t].transpose() * Quu_ * k_gains_[t];
-        // Vxx_ = Qxx_ - K_gains_[t].transpose() * Quu_ * K_gains_[t];
+        workspace.ComputeGains(K_gains_[t], k_gains_[t]);
 
         // With regularisation:
-        Vx_ = Qx_ + K_gains_[t].transpose() * Quu_ * k_gains_[t] + K_gains_[t].transpose() * Qu_ + Qux_.transpose() * k_gains_[t];
-        Vxx_ = Qxx_ + K_gains_[t].transpose() * Quu_ * K_gains_[t] + K_gains_[t].transpose() * Qux_ + Qux_.transpose() * K_gains_[t];
-        Vxx_ = 0.5 * (Vxx_ + Vxx_.transpose()).eval();
+        // Vx = Qx + K^T * Quu * k + K^T * Qu + Qux^T * k
+        // Vxx = Qxx + K^T * Quu * K + K^T * Qux + Qux^T * K
+        workspace.UpdateValueFunction(K_gains_[t], k_gains_[t]);
     }
 }
 
+void AnalyticDDPSolver::BackwardPass()
+{
+    DispatchBackwardPass(*this);
+}
+
 }  // namespace exotica
@@ -39,87 +39,72 @@ void ControlLimitedDDPSolver::Instantiate(const ControlLimitedDDPSolverInitializ
     base_parameters_ = AbstractDDPSolverInitializer(ControlLimitedDDPSolverInitializer(parameters_));
 }
 
-void ControlLimitedDDPSolver::BackwardPass()
+template <typename Workspace>
+void ControlLimitedDDPSolver::BackwardPass(Workspace& workspace)
 {
-    const int T = prob_->get_T();
-    const int NU = prob_->get_num_controls();
-    const int NX = prob_->get_num_positions() + prob_->get_num_velocities();
-    const double dt = dynamics_solver_->get_dt();
-    // const double dt_squared = dynamics_solver_->get_dt() * dynamics_solver_->get_dt();
-
-    Eigen::MatrixXd Qx, Qu, Qxx, Quu, Qux, Vxx;
-    Eigen::VectorXd Vx;
-    Eigen::MatrixXd Quu_inv(NU, NU);
-
-    Vx = prob_->GetStateCostJacobian(T - 1);
-    Vxx = prob_->GetStateCostHessian(T - 1);
-    const Eigen::MatrixXd control_limits = dynamics_solver_->get_control_limits();
-
-    // concatenation axis for tensor products
-    //  See https://eigen.tuxfamily.org/dox-devel/unsupported/eigen_tensors.html#title14
-    Eigen::array<Eigen::IndexPair<int>, 1> dims = {Eigen::IndexPair<int>(1, 0)};
-
-    for (int t = T - 2; t >= 0; t--)
+    prob_->GetStateCostJacobian(T_ - 1, workspace.lx);
+    prob_->GetStateCostHessian(T_ - 1, workspace.lxx);
+    workspace.Vx = workspace.lx;
+    workspace.Vxx = workspace.lxx;
+
+    // NOTE: Qux = Qxu for all robotics systems I have seen
+    //  this might need to be changed later on
+    prob_->GetControlCostHessian(workspace.luu);
+    prob_->GetStateControlCostHessian(workspace.lux);
+    const Eigen::MatrixXd& control_limits = dynamics_solver_->get_control_limits();
+
+    for (int t = T_ - 2; t >= 0; t--)
     {
-        Eigen::VectorXd x = prob_->get_X(t), u = prob_->get_U(t);
-        Eigen::MatrixXd fx = dynamics_solver_->fx(x, u),
-                        fu = dynamics_solver_->fu(x, u);
-
-        fx = fx * dynamics_solver_->get_dt() + Eigen::MatrixXd::Identity(fx.rows(), fx.cols());
-        fu = fu * dynamics_solver_->get_dt();
+        workspace.x = prob_->get_X().col(t);
+        workspace.u = prob_->get_U().col(t);
+        dynamics_solver_->ComputeDerivatives(workspace.x, workspace.u);
+        workspace.SetDynamicsDerivatives(dynamics_solver_->get_fx(), dynamics_solver_->get_fu(), dt_);
 
-        Qx = dt * prob_->GetStateCostJacobian(t) + fx.transpose() * Vx;  // lx + fx @ Vx
-        Qu = dt * prob_->GetControlCostJacobian(t) + fu.transpose() * Vx;
+        prob_->GetStateCostJacobian(t, workspace.lx);
+        prob_->GetControlCostJacobian(t, workspace.lu);
+        prob_->GetStateCostHessian(t, workspace.lxx);
+        workspace.ExpandQ(workspace.lx, workspace.lu, workspace.lxx, workspace.luu, workspace.lux, dt_);
 
         if (parameters_.UseSecondOrderDynamics)
         {
-            // clang-format off
-            Eigen::Tensor<double, 1> Vx_tensor = Eigen::TensorMap<Eigen::Tensor<double, 1>>(Vx.data(), NX_);
-            Qxx = dt * prob_->GetStateCostHessian(t) + fx.transpose() * Vxx * fx +
-                Eigen::TensorToMatrix(
-                    (Eigen::Tensor<double, 2>)dynamics_solver_->fxx(x, u).contract(Vx_tensor, dims), NX, NX
-                ) * dt;
-
-            Quu = dt * prob_->GetControlCostHessian() + fu.transpose() * Vxx * fu +
-                Eigen::TensorToMatrix(
-                    (Eigen::Tensor<double, 2>)dynamics_solver_->fuu(x, u).contract(Vx_tensor, dims), NU, NU
-                ) * dt;
-
-            Qux = dt * prob_->GetStateControlCostHessian() + fu.transpose() * Vxx * fx +
-                Eigen::TensorToMatrix((Eigen::Tensor<double, 2>)dynamics_solver_->fxu(x, u).contract(Vx_tensor, dims), NU, NX
-                ) * dt;
-            // clang-format on
-        }
-        else
-        {
-            Qxx = dt * prob_->GetStateCostHessian(t) + fx.transpose() * Vxx * fx;
-            Quu = dt * prob_->GetControlCostHessian() + fu.transpose() * Vxx * fu;
-
-            // NOTE: Qux = Qxu for all robotics systems I have seen
-            //  this might need to be changed later on
-            Qux = dt * prob_->GetStateControlCostHessian() + fu.transpose() * Vxx * fx;
+            // Contracted with Vx by the dynamics solver, which avoids forming the NX^3 tensors fxx, fuu and fxu.
+            workspace.Vx_arg = workspace.Vx;
+            dynamics_solver_->ContractedSecondOrderDerivatives(workspace.x, workspace.u, workspace.Vx_arg, workspace.Vx_fxx, workspace.Vx_fuu, workspace.Vx_fxu);
+            workspace.AddSecondOrderDynamics(workspace.Vx_fxx, workspace.Vx_fuu, workspace.Vx_fxu, dt_);
         }
 
-        Eigen::VectorXd low_limit = control_limits.col(0) - u,
-                        high_limit = control_limits.col(1) - u;
+        low_limit_ = control_limits.col(0) - workspace.u;
+        high_limit_ = control_limits.col(1) - workspace.u;
 
-        BoxQPSolution boxqp_sol = BoxQP(Quu, Qu, low_limit, high_limit, u, 0.1, 100, 1e-5, parameters_.RegularizationRate);
+        BoxQP(workspace.Quu, workspace.Qu, low_limit_, high_limit_, workspace.u, 0.1, 100, 1e-5, parameters_.RegularizationRate, boxqp_workspace_, boxqp_solution_);
 
-        Quu_inv.setZero();
-        for (unsigned int i = 0; i < boxqp_sol.free_idx.size(); ++i)
-            for (unsigned int j = 0; j < boxqp_sol.free_idx.size(); ++j)
-                Quu_inv(boxqp_sol.free_idx[i], boxqp_sol.free_idx[j]) = boxqp_sol.Hff_inv(i, j);
+        workspace.Quu_inv.setZero();
+        for (unsigned int i = 0; i < boxqp_solution_.free_idx.size(); ++i)
+            for (unsigned int j = 0; j < boxqp_solution_.free_idx.size(); ++j)
+                workspace.Quu_inv(boxqp_solution_.free_idx[i], boxqp_solution_.free_idx[j]) = boxqp_solution_.Hff_inv(i, j);
 
         // Compute controls
-        K_gains_[t] = -Quu_inv * Qux;
-        k_gains_[t] = boxqp_sol.x;
+        K_gains_[t].noalias() = -workspace.Quu_inv * workspace.Qux;
+        k_gains_[t] = boxqp_solution_.x;
 
-        for (unsigned int j = 0; j < boxqp_sol.clamped_idx.size(); ++j)
-            K_gains_[t](boxqp_sol.clamped_idx[j]) = 0;
+        for (unsigned int j = 0; j < boxqp_solution_.clamped_idx.size(); ++j)
+            K_gains_[t](boxqp_solution_.clamped_idx[j]) = 0;
 
-        Vx = Qx - K_gains_[t].transpose() * Quu * k_gains_[t];
-        Vxx = Qxx - K_gains_[t].transpose() * Quu * K_gains_[t];
+        // Vx = Qx - K^T * Quu * k
+        workspace.Quu_k.noalias() = workspace.Quu * k_gains_[t];
+        workspace.Vx = workspace.Qx;
+        workspace.Vx.noalias() -= K_gains_[t].transpose() * workspace.Quu_k;
+
+        // Vxx = Qxx - K^T * Quu * K
+        workspace.Quu_K.noalias() = workspace.Quu * K_gains_[t];
+        workspace.Vxx = workspace.Qxx;
+        workspace.Vxx.noalias() -= K_gains_[t].transpose() * workspace.Quu_K;
     }
 }
 
+void ControlLimitedDDPSolver::BackwardPass()
+{
+    DispatchBackwardPass(*this);
+}
+
 }  // namespace exotica
@@ -29,7 +29,9 @@
 
 #include <exotica_ddp_solver/analytic_ddp_solver.h>
 #include <exotica_ddp_solver/control_limited_ddp_solver.h>
+#include <pybind11/eigen.h>
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
 
 using namespace exotica;
 namespace py = pybind11;
@@ -40,7 +42,18 @@ PYBIND11_MODULE(exotica_ddp_solver_py, module)
 
     py::module::import("pyexotica");
 
-    py::class_<AnalyticDDPSolver, std::shared_ptr<AnalyticDDPSolver>, FeedbackMotionSolver> analytic_ddp_solver(module, "AnalyticDDPSolver");
+    py::class_<AbstractDDPSolver, std::shared_ptr<AbstractDDPSolver>, FeedbackMotionSolver> abstract_ddp_solver(module, "AbstractDDPSolver");
+    abstract_ddp_solver.def(
+        "solve_mpc", [](std::shared_ptr<AbstractDDPSolver> sol, Eigen::VectorXdRefConst x0) {
+            Eigen::MatrixXd ret;
+            sol->SolveMPC(x0, ret);
+            return ret;
+        },
+        "Re-solve the problem from the start state x0, warm-started with the previous solution shifted by one step");
+    abstract_ddp_solver.def_property_readonly("K_gains", &AbstractDDPSolver::get_K_gains);
+    abstract_ddp_solver.def_property_readonly("k_gains", &AbstractDDPSolver::get_k_gains);
 
-    py::class_<ControlLimitedDDPSolver, std::shared_ptr<ControlLimitedDDPSolver>, FeedbackMotionSolver> control_limited_ddp_solver(module, "ControlLimitedDDPSolver");
+    py::class_<AnalyticDDPSolver, std::shared_ptr<AnalyticDDPSolver>, AbstractDDPSolver> analytic_ddp_solver(module, "AnalyticDDPSolver");
+
+    py::class_<ControlLimitedDDPSolver, std::shared_ptr<ControlLimitedDDPSolver>, AbstractDDPSolver> control_limited_ddp_solver(module, "ControlLimitedDDPSolver");
 }
@@ -0,0 +1,159 @@
+//
+// Copyright (c) 2019, University of Edinburgh
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <exotica_ddp_solver/ddp_workspace.h>
+
+namespace exotica
+{
+template struct DDPWorkspaceT<Eigen::Dynamic, Eigen::Dynamic>;
+template struct DDPWorkspaceT<2, 1>;
+template struct DDPWorkspaceT<4, 1>;
+template struct DDPWorkspaceT<4, 2>;
+template struct DDPWorkspaceT<12, 4>;
+
+template <int NX, int NU>
+void DDPWorkspaceT<NX, NU>::Resize(int num_states, int num_controls)
+{
+    if ((NX != Eigen::Dynamic && NX != num_states) || (NU != Eigen::Dynamic && NU != num_controls)) ThrowPretty("Cannot resize a " << NX << "x" << NU << " workspace to " << num_states << "x" << num_controls << ".");
+
+    // No-ops for the compile-time-sized buffers
+    x.resize(num_states);
+    u.resize(num_controls);
+    Vx_arg.resize(num_states);
+    lx.resize(num_states);
+    lu.resize(num_controls);
+    lxx.resize(num_states, num_states);
+    luu.resize(num_controls, num_controls);
+    lux.resize(num_controls, num_states);
+    fx.resize(num_states, num_states);
+    fu.resize(num_states, num_controls);
+    Vx_fxx.resize(num_states, num_states);
+    Vx_fuu.resize(num_controls, num_controls);
+    Vx_fxu.resize(num_controls, num_states);
+    Qx.resize(num_states);
+    Qu.resize(num_controls);
+    Qxx.resize(num_states, num_states);
+    Quu.resize(num_controls, num_controls);
+    Qux.resize(num_controls, num_states);
+    Quu_inv.resize(num_controls, num_controls);
+    Vx.resize(num_states);
+    Vxx.resize(num_states, num_states);
+    Vxx_fx.resize(num_states, num_states);
+    Vxx_fu.resize(num_states, num_controls);
+    Quu_K.resize(num_controls, num_states);
+    Quu_k.resize(num_controls);
+    if (Quu_lu.rows() != num_controls) Quu_lu = Eigen::PartialPivLU<ControlMatrix>(num_controls);
+}
+
+template <int NX, int NU>
+void DDPWorkspaceT<NX, NU>::SetDynamicsDerivatives(const Eigen::MatrixXd& fx_c, const Eigen::MatrixXd& fu_c, double dt)
+{
+    fx = dt * fx_c;
+    fx.diagonal().array() += 1.0;
+    fu = dt * fu_c;
+}
+
+template <int NX, int NU>
+void DDPWorkspaceT<NX, NU>::ExpandQ(const Eigen::VectorXd& lx, const Eigen::VectorXd& lu, const Eigen::MatrixXd& lxx, const Eigen::MatrixXd& luu, const Eigen::MatrixXd& lux, double dt, double state_regularization)
+{
+    // lx + fx^T * Vx
+    Qx = dt * lx;
+    Qx.noalias() += fx.transpose() * Vx;
+    Qu = dt * lu;
+    Qu.noalias() += fu.transpose() * Vx;
+
+    Vxx.diagonal().array() += state_regularization;
+    Vxx_fx.noalias() = Vxx * fx;
+    Vxx_fu.noalias() = Vxx * fu;
+
+    Qxx = dt * lxx;
+    Qxx.noalias() += fx.transpose() * Vxx_fx;
+    Quu = dt * luu;
+    Quu.noalias() += fu.transpose() * Vxx_fu;
+    Qux = dt * lux;
+    Qux.noalias() += fu.transpose() * Vxx_fx;
+}
+
+template <int NX, int NU>
+void DDPWorkspaceT<NX, NU>::AddSecondOrderDynamics(const Eigen::Tensor<double, 3>& fxx, const Eigen::Tensor<double, 3>& fuu, const Eigen::Tensor<double, 3>& fxu, double dt)
+{
+    AddContraction(fxx, Vx, dt, Qxx);
+    AddContraction(fuu, Vx, dt, Quu);
+    AddContraction(fxu, Vx, dt, Qux);
+}
+
+template <int NX, int NU>
+void DDPWorkspaceT<NX, NU>::AddSecondOrderDynamics(const Eigen::MatrixXd& Vx_fxx_c, const Eigen::MatrixXd& Vx_fuu_c, const Eigen::MatrixXd& Vx_fxu_c, double dt)
+{
+    Qxx.noalias() += dt * Vx_fxx_c;
+    Quu.noalias() += dt * Vx_fuu_c;
+    Qux.noalias() += dt * Vx_fxu_c;
+}
+
+template <int NX, int NU>
+void DDPWorkspaceT<NX, NU>::ComputeGains(Eigen::MatrixXd& K, Eigen::MatrixXd& k)
+{
+    // Same as Quu_lu.inverse(), which would allocate a temporary: solve L * U * Quu_inv = P.
+    Quu_lu.compute(Quu);
+    Quu_inv.setZero();
+    for (Eigen::Index i = 0; i < Quu_inv.rows(); ++i) Quu_inv(Quu_lu.permutationP().indices()(i), i) = 1.0;
+    Quu_lu.matrixLU().template triangularView<Eigen::UnitLower>().solveInPlace(Quu_inv);
+    Quu_lu.matrixLU().template triangularView<Eigen::Upper>().solveInPlace(Quu_inv);
+    k.noalias() = -Quu_inv * Qu;
+    K.noalias() = -Quu_inv * Qux;
+}
+
+template <int NX, int NU>
+void DDPWorkspaceT<NX, NU>::UpdateValueFunction(const Eigen::MatrixXd& K, const Eigen::MatrixXd& k)
+{
+    // Vx = Qx + K^T * Quu * k + K^T * Qu + Qux^T * k
+    Quu_k.noalias() = Quu * k;
+    Vx = Qx;
+    Vx.noalias() += K.transpose() * Quu_k;
+    Vx.noalias() += K.transpose() * Qu;
+    Vx.noalias() += Qux.transpose() * k;
+
+    // Vxx = Qxx + K^T * Quu * K + K^T * Qux + Qux^T * K
+    Quu_K.noalias() = Quu * K;
+    Vxx = Qxx;
+    Vxx.noalias() += K.transpose() * Quu_K;
+    Vxx.noalias() += K.transpose() * Qux;
+    Vxx.noalias() += Qux.transpose() * K;
+
+    // Symmetrise in place
+    for (Eigen::Index i = 0; i < Vxx.rows(); ++i)
+    {
+        for (Eigen::Index j = 0; j < i; ++j)
+        {
+            const double mean = 0.5 * (Vxx(i, j) + Vxx(j, i));
+            Vxx(i, j) = mean;
+            Vxx(j, i) = mean;
+        }
+    }
+}
+}  // namespace exotica
@@ -0,0 +1,430 @@
+//
+// Copyright (c) 2019, University of Edinburgh
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <exotica_core/dynamics_solver.h>
+#include <exotica_core/tools/conversions.h>
+#include <exotica_core/tools/timer.h>
+#include <exotica_ddp_solver/ddp_workspace.h>
+
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#define PRINTF(...)                                                                        \
+    do                                                                                     \
+    {                                                                                      \
+        testing::internal::ColoredPrintf(testing::internal::COLOR_GREEN, "[          ] "); \
+        testing::internal::ColoredPrintf(testing::internal::COLOR_YELLOW, __VA_ARGS__);    \
+    } while (0)
+
+// C++ stream interface
+class TestCout : public std::stringstream
+{
+public:
+    ~TestCout()
+    {
+        PRINTF("%s\n", str().c_str());
+    }
+};
+
+#define TEST_COUT TestCout()
+
+// Count heap allocations by interposing the C allocator, which both Eigen and operator new use.
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t num, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+namespace
+{
+bool count_allocations = false;
+int number_of_allocations = 0;
+}  // namespace
+
+extern "C" void* malloc(size_t size)
+{
+    if (count_allocations) ++number_of_allocations;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t num, size_t size)
+{
+    if (count_allocations) ++number_of_allocations;
+    return __libc_calloc(num, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+    if (count_allocations) ++number_of_allocations;
+    return __libc_realloc(ptr, size);
+}
+
+using namespace exotica;
+
+constexpr int NX = 12;
+constexpr int NU = 6;
+constexpr int T = 10;
+constexpr double DT = 0.01;
+constexpr double LAMBDA = 1e-3;
+constexpr double THRESHOLD = 1e-9;
+constexpr double FINITE_DIFFERENCES_THRESHOLD = 1e-6;
+
+// Derivatives of one timestep, generated before the allocations are counted.
+struct Expansion
+{
+    Expansion()
+    {
+        fx = Eigen::MatrixXd::Random(NX, NX);
+        fu = Eigen::MatrixXd::Random(NX, NU);
+        lx = Eigen::VectorXd::Random(NX);
+        lu = Eigen::VectorXd::Random(NU);
+        lxx = Eigen::MatrixXd::Random(NX, NX);
+        lxx = lxx * lxx.transpose() + Eigen::MatrixXd::Identity(NX, NX);
+        luu = Eigen::MatrixXd::Random(NU, NU);
+        luu = luu * luu.transpose() + Eigen::MatrixXd::Identity(NU, NU);
+        lux = Eigen::MatrixXd::Zero(NU, NX);
+        fxx = Eigen::Tensor<double, 3>(NX, NX, NX);
+        fxx.setRandom();
+        fuu = Eigen::Tensor<double, 3>(NU, NX, NU);
+        fuu.setRandom();
+        fxu = Eigen::Tensor<double, 3>(NU, NX, NX);
+        fxu.setRandom();
+    }
+
+    Eigen::MatrixXd fx, fu, lxx, luu, lux;
+    Eigen::VectorXd lx, lu;
+    Eigen::Tensor<double, 3> fxx, fuu, fxu;
+};
+
+// Dynamics with constant second-order derivatives, f_i(x, u) = fx_i x + fu_i u + 1/2 x^T Hxx_i x + 1/2 u^T Huu_i u + u^T Hxu_i x.
+// fx and fu are analytic, so the finite differences of the default ContractedSecondOrderDerivatives are exact up to rounding.
+class QuadraticDynamicsSolver : public DynamicsSolver, public Instantiable<DynamicsSolverInitializer>
+{
+public:
+    explicit QuadraticDynamicsSolver(const Expansion& e) : fx_(e.fx), fu_(e.fu), fxx_(NX, NX, NX), fuu_(NU, NX, NU), fxu_(NU, NX, NX)
+    {
+        num_positions_ = NX;
+        num_velocities_ = 0;
+        num_controls_ = NU;
+        for (int i = 0; i < NX; ++i)
+        {
+            const Eigen::MatrixXd Hxx = Eigen::MatrixXd::Random(NX, NX), Huu = Eigen::MatrixXd::Random(NU, NU);
+            Hxx_.push_back(Hxx + Hxx.transpose());
+            Huu_.push_back(Huu + Huu.transpose());
+            Hxu_.push_back(Eigen::MatrixXd::Random(NU, NX));
+            // Tensor layout of DynamicsSolver::fxx, fuu and fxu: the output index is the second one.
+            for (int j = 0; j < NX; ++j)
+                for (int k = 0; k < NX; ++k) fxx_(k, i, j) = Hxx_[i](j, k);
+            for (int a = 0; a < NU; ++a)
+                for (int b = 0; b < NU; ++b) fuu_(a, i, b) = Huu_[i](b, a);
+            for (int a = 0; a < NU; ++a)
+                for (int j = 0; j < NX; ++j) fxu_(a, i, j) = Hxu_[i](a, j);
+        }
+    }
+
+    StateVector f(const StateVector& x, const ControlVector& u) override
+    {
+        StateVector xdot = fx_ * x + fu_ * u;
+        for (int i = 0; i < NX; ++i) xdot(i) += 0.5 * x.dot(Hxx_[i] * x) + 0.5 * u.dot(Huu_[i] * u) + u.dot(Hxu_[i] * x);
+        return xdot;
+    }
+
+    StateDerivative fx(const StateVector& x, const ControlVector& u) override
+    {
+        StateDerivative fx = fx_;
+        for (int i = 0; i < NX; ++i) fx.row(i) += (Hxx_[i] * x + Hxu_[i].transpose() * u).transpose();
+        return fx;
+    }
+
+    ControlDerivative fu(const StateVector& x, const ControlVector& u) override
+    {
+        ControlDerivative fu = fu_;
+        for (int i = 0; i < NX; ++i) fu.row(i) += (Huu_[i] * u + Hxu_[i] * x).transpose();
+        return fu;
+    }
+
+    Eigen::Tensor<double, 3> fxx(const StateVector& x, const ControlVector& u) override { return fxx_; }
+    Eigen::Tensor<double, 3> fuu(const StateVector& x, const ControlVector& u) override { return fuu_; }
+    Eigen::Tensor<double, 3> fxu(const StateVector& x, const ControlVector& u) override { return fxu_; }
+
+protected:
+    // Same as f, fx and fu, but without allocating so that the finite differences of the second-order derivatives can be counted.
+    void ComputeDerivativesInternal(const StateVector& x, const ControlVector& u, StateVector& xdot, StateDerivative& fx_out, ControlDerivative& fu_out) override
+    {
+        xdot.noalias() = fx_ * x;
+        xdot.noalias() += fu_ * u;
+        fx_out = fx_;
+        fu_out = fu_;
+        for (int i = 0; i < NX; ++i)
+        {
+            Hxx_x_.noalias() = Hxx_[i] * x;
+            Huu_u_.noalias() = Huu_[i] * u;
+            Hxu_x_.noalias() = Hxu_[i] * x;
+            HxuT_u_.noalias() = Hxu_[i].transpose() * u;
+            xdot(i) += 0.5 * x.dot(Hxx_x_) + 0.5 * u.dot(Huu_u_) + u.dot(Hxu_x_);
+            fx_out.row(i) += (Hxx_x_ + HxuT_u_).transpose();
+            fu_out.row(i) += (Huu_u_ + Hxu_x_).transpose();
+        }
+    }
+
+private:
+    Eigen::MatrixXd fx_, fu_;
+    std::vector<Eigen::MatrixXd> Hxx_, Huu_, Hxu_;
+    Eigen::Tensor<double, 3> fxx_, fuu_, fxu_;
+    Eigen::VectorXd Hxx_x_ = Eigen::VectorXd(NX), HxuT_u_ = Eigen::VectorXd(NX), Huu_u_ = Eigen::VectorXd(NU), Hxu_x_ = Eigen::VectorXd(NU);
+};
+
+TEST(ExoticaDDPSolver, WorkspaceDoesNotAllocate)
+{
+    const std::vector<Expansion> expansions(T);
+    std::vector<Eigen::MatrixXd> K_gains(T, Eigen::MatrixXd(NU, NX)), k_gains(T, Eigen::MatrixXd(NU, 1));
+
+    DDPWorkspace workspace;
+    workspace.Resize(NX, NU);
+    workspace.Vx = expansions[0].lx;
+    workspace.Vxx = expansions[0].lxx;
+
+    // The finite differences of ContractedSecondOrderDerivatives size their buffers on the first call.
+    QuadraticDynamicsSolver dynamics_solver(expansions[0]);
+    const Eigen::VectorXd x = Eigen::VectorXd::Random(NX), u = Eigen::VectorXd::Random(NU);
+    workspace.Vx_arg = workspace.Vx;
+    dynamics_solver.ContractedSecondOrderDerivatives(x, u, workspace.Vx_arg, workspace.Vx_fxx, workspace.Vx_fuu, workspace.Vx_fxu);
+
+    number_of_allocations = 0;
+    count_allocations = true;
+    workspace.Resize(NX, NU);
+    for (int t = T - 1; t >= 0; --t)
+    {
+        const Expansion& e = expansions[t];
+        workspace.SetDynamicsDerivatives(e.fx, e.fu, DT);
+        workspace.ExpandQ(e.lx, e.lu, e.lxx, e.luu, e.lux, DT, LAMBDA);
+        workspace.AddSecondOrderDynamics(e.fxx, e.fuu, e.fxu, DT);
+        workspace.Vx_arg = workspace.Vx;
+        dynamics_solver.ContractedSecondOrderDerivatives(x, u, workspace.Vx_arg, workspace.Vx_fxx, workspace.Vx_fuu, workspace.Vx_fxu);
+        workspace.AddSecondOrderDynamics(workspace.Vx_fxx, workspace.Vx_fuu, workspace.Vx_fxu, DT);
+        workspace.Quu.diagonal().array() += LAMBDA;
+        workspace.ComputeGains(K_gains[t], k_gains[t]);
+        workspace.UpdateValueFunction(K_gains[t], k_gains[t]);
+    }
+    count_allocations = false;
+
+    EXPECT_EQ(number_of_allocations, 0);
+    EXPECT_TRUE(workspace.Vxx.allFinite());
+}
+
+TEST(ExoticaDDPSolver, WorkspaceMatchesReferenceExpressions)
+{
+    const Expansion e;
+    const Eigen::VectorXd Vx = Eigen::VectorXd::Random(NX);
+    Eigen::MatrixXd Vxx = Eigen::MatrixXd::Random(NX, NX);
+    Vxx = Vxx * Vxx.transpose();
+
+    DDPWorkspace workspace;
+    workspace.Resize(NX, NU);
+    workspace.Vx = Vx;
+    workspace.Vxx = Vxx;
+    Eigen::MatrixXd K(NU, NX), k(NU, 1);
+    workspace.SetDynamicsDerivatives(e.fx, e.fu, DT);
+    workspace.ExpandQ(e.lx, e.lu, e.lxx, e.luu, e.lux, DT, LAMBDA);
+    workspace.AddSecondOrderDynamics(e.fxx, e.fuu, e.fxu, DT);
+    workspace.Quu.diagonal().array() += LAMBDA;
+    workspace.ComputeGains(K, k);
+    workspace.UpdateValueFunction(K, k);
+
+    // Reference: the expressions of the analytic DDP backward pass.
+    const Eigen::MatrixXd fx = e.fx * DT + Eigen::MatrixXd::Identity(NX, NX);
+    const Eigen::MatrixXd fu = e.fu * DT;
+    Eigen::VectorXd Vx_copy = Vx;
+    Eigen::Tensor<double, 1> Vx_tensor = Eigen::TensorMap<Eigen::Tensor<double, 1>>(Vx_copy.data(), NX);
+    Eigen::array<Eigen::IndexPair<int>, 1> dims = {Eigen::IndexPair<int>(1, 0)};
+    Vxx.diagonal().array() += LAMBDA;
+    const Eigen::VectorXd Qx = DT * e.lx + fx.transpose() * Vx;
+    const Eigen::VectorXd Qu = DT * e.lu + fu.transpose() * Vx;
+    const Eigen::MatrixXd Qxx = DT * e.lxx + fx.transpose() * Vxx * fx + Eigen::TensorToMatrix((Eigen::Tensor<double, 2>)e.fxx.contract(Vx_tensor, dims), NX, NX) * DT;
+    Eigen::MatrixXd Quu = DT * e.luu + fu.transpose() * Vxx * fu + Eigen::TensorToMatrix((Eigen::Tensor<double, 2>)e.fuu.contract(Vx_tensor, dims), NU, NU) * DT;
+    const Eigen::MatrixXd Qux = DT * e.lux + fu.transpose() * Vxx * fx + Eigen::TensorToMatrix((Eigen::Tensor<double, 2>)e.fxu.contract(Vx_tensor, dims), NU, NX) * DT;
+    Quu.diagonal().array() += LAMBDA;
+    const Eigen::MatrixXd Quu_inv = Quu.inverse();
+    const Eigen::MatrixXd k_reference = -Quu_inv * Qu;
+    const Eigen::MatrixXd K_reference = -Quu_inv * Qux;
+    const Eigen::VectorXd Vx_reference = Qx + K_reference.transpose() * Quu * k_reference + K_reference.transpose() * Qu + Qux.transpose() * k_reference;
+    Eigen::MatrixXd Vxx_reference = Qxx + K_reference.transpose() * Quu * K_reference + K_reference.transpose() * Qux + Qux.transpose() * K_reference;
+    Vxx_reference = 0.5 * (Vxx_reference + Vxx_reference.transpose()).eval();
+
+    EXPECT_TRUE(workspace.Qxx.isApprox(Qxx, THRESHOLD));
+    EXPECT_TRUE(workspace.Quu.isApprox(Quu, THRESHOLD));
+    EXPECT_TRUE(workspace.Qux.isApprox(Qux, THRESHOLD));
+    EXPECT_TRUE(k.isApprox(k_reference, THRESHOLD));
+    EXPECT_TRUE(K.isApprox(K_reference, THRESHOLD));
+    EXPECT_TRUE(workspace.Vx.isApprox(Vx_reference, THRESHOLD));
+    EXPECT_TRUE(workspace.Vxx.isApprox(Vxx_reference, THRESHOLD));
+}
+
+TEST(ExoticaDDPSolver, ContractedSecondOrderDynamicsMatchTensors)
+{
+    const Expansion e;
+    QuadraticDynamicsSolver dynamics_solver(e);
+    const Eigen::VectorXd x = Eigen::VectorXd::Random(NX), u = Eigen::VectorXd::Random(NU);
+
+    DDPWorkspace tensor_workspace, contracted_workspace;
+    for (DDPWorkspace* workspace : {&tensor_workspace, &contracted_workspace})
+    {
+        workspace->Resize(NX, NU);
+        workspace->Qxx.setZero();
+        workspace->Quu.setZero();
+        workspace->Qux.setZero();
+        workspace->Vx = e.lx;
+    }
+
+    tensor_workspace.AddSecondOrderDynamics(dynamics_solver.fxx(x, u), dynamics_solver.fuu(x, u), dynamics_solver.fxu(x, u), DT);
+
+    dynamics_solver.ContractedSecondOrderDerivatives(x, u, contracted_workspace.Vx, contracted_workspace.Vx_fxx, contracted_workspace.Vx_fuu, contracted_workspace.Vx_fxu);
+    contracted_workspace.AddSecondOrderDynamics(contracted_workspace.Vx_fxx, contracted_workspace.Vx_fuu, contracted_workspace.Vx_fxu, DT);
+
+    EXPECT_TRUE(contracted_workspace.Qxx.isApprox(tensor_workspace.Qxx, FINITE_DIFFERENCES_THRESHOLD));
+    EXPECT_TRUE(contracted_workspace.Quu.isApprox(tensor_workspace.Quu, FINITE_DIFFERENCES_THRESHOLD));
+    EXPECT_TRUE(contracted_workspace.Qux.isApprox(tensor_workspace.Qux, FINITE_DIFFERENCES_THRESHOLD));
+}
+
+// Runs one step of the backward pass on a compile-time-sized workspace and its dynamic-size counterpart.
+template <int NX_FIXED, int NU_FIXED>
+void CompareFixedSizeWorkspace()
+{
+    const Eigen::MatrixXd fx = Eigen::MatrixXd::Random(NX_FIXED, NX_FIXED), fu = Eigen::MatrixXd::Random(NX_FIXED, NU_FIXED);
+    const Eigen::VectorXd lx = Eigen::VectorXd::Random(NX_FIXED), lu = Eigen::VectorXd::Random(NU_FIXED);
+    Eigen::MatrixXd lxx = Eigen::MatrixXd::Random(NX_FIXED, NX_FIXED), luu = Eigen::MatrixXd::Random(NU_FIXED, NU_FIXED);
+    lxx = lxx * lxx.transpose() + Eigen::MatrixXd::Identity(NX_FIXED, NX_FIXED);
+    luu = luu * luu.transpose() + Eigen::MatrixXd::Identity(NU_FIXED, NU_FIXED);
+    const Eigen::MatrixXd lux = Eigen::MatrixXd::Random(NU_FIXED, NX_FIXED);
+    Eigen::Tensor<double, 3> fxx(NX_FIXED, NX_FIXED, NX_FIXED), fuu(NU_FIXED, NX_FIXED, NU_FIXED), fxu(NU_FIXED, NX_FIXED, NX_FIXED);
+    fxx.setRandom();
+    fuu.setRandom();
+    fxu.setRandom();
+
+    DDPWorkspace workspace;
+    std::unique_ptr<DDPWorkspaceT<NX_FIXED, NU_FIXED>> fixed_workspace(new DDPWorkspaceT<NX_FIXED, NU_FIXED>());
+    workspace.Resize(NX_FIXED, NU_FIXED);
+    fixed_workspace->Resize(NX_FIXED, NU_FIXED);
+    workspace.Vx = fixed_workspace->Vx = lx;
+    workspace.Vxx = fixed_workspace->Vxx = lxx;
+    Eigen::MatrixXd K(NU_FIXED, NX_FIXED), k(NU_FIXED, 1), K_fixed(NU_FIXED, NX_FIXED), k_fixed(NU_FIXED, 1);
+
+    workspace.SetDynamicsDerivatives(fx, fu, DT);
+    workspace.ExpandQ(lx, lu, lxx, luu, lux, DT, LAMBDA);
+    workspace.AddSecondOrderDynamics(fxx, fuu, fxu, DT);
+    workspace.Quu.diagonal().array() += LAMBDA;
+    workspace.ComputeGains(K, k);
+    workspace.UpdateValueFunction(K, k);
+
+    number_of_allocations = 0;
+    count_allocations = true;
+    fixed_workspace->SetDynamicsDerivatives(fx, fu, DT);
+    fixed_workspace->ExpandQ(lx, lu, lxx, luu, lux, DT, LAMBDA);
+    fixed_workspace->AddSecondOrderDynamics(fxx, fuu, fxu, DT);
+    fixed_workspace->Quu.diagonal().array() += LAMBDA;
+    fixed_workspace->ComputeGains(K_fixed, k_fixed);
+    fixed_workspace->UpdateValueFunction(K_fixed, k_fixed);
+    count_allocations = false;
+
+    EXPECT_EQ(number_of_allocations, 0);
+    EXPECT_TRUE(K_fixed.isApprox(K, THRESHOLD));
+    EXPECT_TRUE(k_fixed.isApprox(k, THRESHOLD));
+    EXPECT_TRUE(fixed_workspace->Vx.isApprox(workspace.Vx, THRESHOLD));
+    EXPECT_TRUE(fixed_workspace->Vxx.isApprox(workspace.Vxx, THRESHOLD));
+}
+
+TEST(ExoticaDDPSolver, FixedSizeWorkspaceMatchesDynamicSize)
+{
+    CompareFixedSizeWorkspace<2, 1>();
+    CompareFixedSizeWorkspace<4, 1>();
+    CompareFixedSizeWorkspace<4, 2>();
+    CompareFixedSizeWorkspace<12, 4>();
+}
+
+// Times NUM_BENCHMARK_STEPS steps of the backward pass, as run by the analytic DDP solver, on the given workspace.
+template <typename Workspace>
+double TimeBackwardPassSteps(Workspace& workspace, const Eigen::MatrixXd& fx, const Eigen::MatrixXd& fu, const Eigen::VectorXd& lx, const Eigen::VectorXd& lu, const Eigen::MatrixXd& lxx, const Eigen::MatrixXd& luu, const Eigen::MatrixXd& lux, const Eigen::MatrixXd& Vx_fxx, const Eigen::MatrixXd& Vx_fuu, const Eigen::MatrixXd& Vx_fxu, Eigen::MatrixXd& K, Eigen::MatrixXd& k)
+{
+    constexpr int NUM_BENCHMARK_STEPS = 100000;
+    Timer timer;
+    for (int t = 0; t < NUM_BENCHMARK_STEPS; ++t)
+    {
+        // Restart from the same value function so that every step does the same work.
+        workspace.Vx = lx;
+        workspace.Vxx = lxx;
+        workspace.SetDynamicsDerivatives(fx, fu, DT);
+        workspace.ExpandQ(lx, lu, lxx, luu, lux, DT, LAMBDA);
+        workspace.AddSecondOrderDynamics(Vx_fxx, Vx_fuu, Vx_fxu, DT);
+        workspace.Quu.diagonal().array() += LAMBDA;
+        workspace.ComputeGains(K, k);
+        workspace.UpdateValueFunction(K, k);
+    }
+    return timer.GetDuration() / NUM_BENCHMARK_STEPS;
+}
+
+template <int NX_FIXED, int NU_FIXED>
+void BenchmarkFixedSizeWorkspace()
+{
+    const Eigen::MatrixXd fx = Eigen::MatrixXd::Random(NX_FIXED, NX_FIXED), fu = Eigen::MatrixXd::Random(NX_FIXED, NU_FIXED);
+    const Eigen::VectorXd lx = Eigen::VectorXd::Random(NX_FIXED), lu = Eigen::VectorXd::Random(NU_FIXED);
+    Eigen::MatrixXd lxx = Eigen::MatrixXd::Random(NX_FIXED, NX_FIXED), luu = Eigen::MatrixXd::Random(NU_FIXED, NU_FIXED);
+    lxx = lxx * lxx.transpose() + Eigen::MatrixXd::Identity(NX_FIXED, NX_FIXED);
+    luu = luu * luu.transpose() + Eigen::MatrixXd::Identity(NU_FIXED, NU_FIXED);
+    const Eigen::MatrixXd lux = Eigen::MatrixXd::Random(NU_FIXED, NX_FIXED);
+    Eigen::MatrixXd Vx_fxx = Eigen::MatrixXd::Random(NX_FIXED, NX_FIXED), Vx_fuu = Eigen::MatrixXd::Random(NU_FIXED, NU_FIXED);
+    Vx_fxx = 0.5 * (Vx_fxx + Vx_fxx.transpose()).eval();
+    Vx_fuu = 0.5 * (Vx_fuu + Vx_fuu.transpose()).eval();
+    const Eigen::MatrixXd Vx_fxu = Eigen::MatrixXd::Random(NU_FIXED, NX_FIXED);
+
+    DDPWorkspace workspace;
+    std::unique_ptr<DDPWorkspaceT<NX_FIXED, NU_FIXED>> fixed_workspace(new DDPWorkspaceT<NX_FIXED, NU_FIXED>());
+    workspace.Resize(NX_FIXED, NU_FIXED);
+    fixed_workspace->Resize(NX_FIXED, NU_FIXED);
+    Eigen::MatrixXd K(NU_FIXED, NX_FIXED), k(NU_FIXED, 1);
+
+    const double time_dynamic = TimeBackwardPassSteps(workspace, fx, fu, lx, lu, lxx, luu, lux, Vx_fxx, Vx_fuu, Vx_fxu, K, k);
+    const double time_fixed = TimeBackwardPassSteps(*fixed_workspace, fx, fu, lx, lu, lxx, luu, lux, Vx_fxx, Vx_fuu, Vx_fxu, K, k);
+    TEST_COUT << NX_FIXED << "x" << NU_FIXED << ": " << time_dynamic * 1e6 << " us per backward pass step with the dynamic-size workspace, " << time_fixed * 1e6 << " us with the compile-time-sized workspace";
+    EXPECT_LE(time_fixed, time_dynamic) << NX_FIXED << "x" << NU_FIXED;
+}
+
+TEST(ExoticaDDPSolver, FixedSizeWorkspaceIsFaster)
+{
+    BenchmarkFixedSizeWorkspace<2, 1>();
+    BenchmarkFixedSizeWorkspace<4, 1>();
+    BenchmarkFixedSizeWorkspace<4, 2>();
+    BenchmarkFixedSizeWorkspace<12, 4>();
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
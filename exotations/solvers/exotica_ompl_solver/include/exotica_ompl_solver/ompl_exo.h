@@ -30,6 +30,9 @@
 #ifndef EXOTICA_OMPL_SOLVER_OMPL_EXO_H_
 #define EXOTICA_OMPL_SOLVER_OMPL_EXO_H_
 
+#include <condition_variable>
+#include <mutex>
+
 #include <exotica_core/problems/sampling_problem.h>
 
 #include <ompl/base/SpaceInformation.h>
@@ -71,14 +74,30 @@ protected:
 class OMPLStateValidityChecker : public ompl::base::StateValidityChecker
 {
 public:
-    OMPLStateValidityChecker(const ompl::base::SpaceInformationPtr &si, const SamplingProblemPtr &prob);
+    /// \brief Creates a validity checker which can be called from num_threads threads concurrently.
+    /// With more than one thread, states are checked on a pool of problem replicas, see SamplingProblem::CreateReplica.
+    OMPLStateValidityChecker(const ompl::base::SpaceInformationPtr &si, const SamplingProblemPtr &prob, int num_threads = 1);
 
     bool isValid(const ompl::base::State *state) const override;
 
     bool isValid(const ompl::base::State *state, double &dist) const override;
 
+    /// \brief Creates the problem replicas or synchronises them with the problem. Needs to be called after the problem or its scene changed.
+    void UpdateReplicas();
+
 protected:
     SamplingProblemPtr prob_;
+
+private:
+    /// \brief Takes a problem from the pool, blocks until one is available.
+    SamplingProblemPtr AcquireProblem() const;
+    void ReleaseProblem(const SamplingProblemPtr &problem) const;
+
+    int num_threads_;
+    std::vector<SamplingProblemPtr> replicas_;                 ///< Copies of prob_ used by the additional threads.
+    mutable std::vector<SamplingProblemPtr> available_problems_;  ///< Problems of the pool (prob_ and its replicas) not in use.
+    mutable std::mutex pool_mutex_;
+    mutable std::condition_variable problem_released_;
 };
 
 class OMPLRNStateSpace : public OMPLStateSpace
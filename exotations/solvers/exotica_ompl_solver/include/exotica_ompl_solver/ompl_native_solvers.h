@@ -50,6 +50,20 @@ public:
     double GetRange();
 };
 
+class ParallelRRTSolver : public OMPLSolver<SamplingProblem>, Instantiable<ParallelRRTSolverInitializer>
+{
+public:
+    ParallelRRTSolver();
+    void Instantiate(const ParallelRRTSolverInitializer& init) override;
+};
+
+class ParallelSBLSolver : public OMPLSolver<SamplingProblem>, Instantiable<ParallelSBLSolverInitializer>
+{
+public:
+    ParallelSBLSolver();
+    void Instantiate(const ParallelSBLSolverInitializer& init) override;
+};
+
 class ESTSolver : public OMPLSolver<SamplingProblem>, Instantiable<ESTSolverInitializer>
 {
 public:
@@ -85,6 +99,14 @@ public:
     int MilestoneCount();
     bool IsMultiQuery() const;
     void SetMultiQuery(bool val);
+
+    /// \brief Saves the roadmap to a binary file which can be loaded with LoadRoadmap.
+    void SaveRoadmap(const std::string& file_name);
+
+    /// \brief Replaces the roadmap with one loaded from file_name and enables multi-query mode.
+    /// Vertices and edges in collision with world objects which were added or changed after saving are dropped.
+    /// @return Number of dropped vertices and edges.
+    int LoadRoadmap(const std::string& file_name);
 };
 
 class LazyPRMSolver : public OMPLSolver<SamplingProblem>, Instantiable<LazyPRMSolverInitializer>
@@ -99,6 +121,14 @@ public:
     int MilestoneCount();
     bool IsMultiQuery() const;
     void SetMultiQuery(bool val);
+
+    /// \brief Saves the roadmap to a binary file which can be loaded with LoadRoadmap.
+    void SaveRoadmap(const std::string& file_name);
+
+    /// \brief Replaces the roadmap with one loaded from file_name and enables multi-query mode.
+    /// Vertices and edges in collision with world objects which were added or changed after saving are dropped.
+    /// @return Number of dropped vertices and edges.
+    int LoadRoadmap(const std::string& file_name);
 };
 
 class RRTStarSolver : public OMPLSolver<SamplingProblem>, Instantiable<RRTStarSolverInitializer>
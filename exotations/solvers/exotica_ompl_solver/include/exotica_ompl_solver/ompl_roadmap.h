@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2018, University of Edinburgh
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef EXOTICA_OMPL_SOLVER_OMPL_ROADMAP_H_
+#define EXOTICA_OMPL_SOLVER_OMPL_ROADMAP_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <exotica_core/scene.h>
+
+#include <ompl/base/PlannerData.h>
+
+namespace exotica
+{
+/// \brief Binary roadmap files store the vertices and edges of a PRM-type roadmap in native byte order.
+/// The layout is: RoadmapFileHeader, bounds (2 * dimension doubles, lower then upper), vertex states
+/// (num_vertices * dimension doubles), RoadmapFileEdge[num_edges], RoadmapFileWorldObject[num_world_objects]
+/// and RoadmapFileVertex[num_vertices]. Every section is 8-byte aligned so the file can be read in place from a memory mapping.
+struct RoadmapFileHeader
+{
+    char magic[8];                ///< "EXOPRM" padded with zeros
+    uint32_t version;             ///< Format version, see kRoadmapFileVersion
+    uint32_t dimension;           ///< Number of controlled joints
+    uint64_t num_vertices;        ///< Number of roadmap vertices
+    uint64_t num_edges;           ///< Number of undirected roadmap edges
+    uint64_t num_world_objects;   ///< Number of world collision objects the roadmap was built around
+    uint64_t robot_fingerprint;   ///< Hash of the robot model, controlled joints and robot collision geometry
+};
+
+struct RoadmapFileEdge
+{
+    uint32_t from;   ///< Index of the first vertex
+    uint32_t to;     ///< Index of the second vertex
+    uint32_t flags;  ///< RoadmapFlags
+    uint32_t reserved;
+    double weight;  ///< Edge cost
+};
+
+struct RoadmapFileWorldObject
+{
+    uint64_t name_hash;     ///< Hash of the collision object name
+    uint64_t content_hash;  ///< Hash of the shape and pose of the collision object
+};
+
+struct RoadmapFileVertex
+{
+    int32_t tag;     ///< PlannerData vertex tag
+    uint32_t flags;  ///< RoadmapFlags
+};
+
+enum RoadmapFlags : uint32_t
+{
+    ROADMAP_VALIDATED = 1  ///< The vertex/edge has been collision checked (PRM), otherwise its validity is unknown (LazyPRM).
+};
+
+constexpr uint32_t kRoadmapFileVersion = 2;
+
+/// \brief Writes the roadmap stored in data into file_name.
+/// @param data Planner data of a PRM-type planner. Directed edge pairs are stored once.
+/// @param validated Whether the planner has collision checked all vertices and edges.
+/// @param scene Scene the roadmap was built in, used to fingerprint the robot and the world objects.
+/// @param bounds Joint limits of the state space (lower bounds followed by upper bounds).
+void SaveRoadmap(const std::string& file_name, const ompl::base::PlannerData& data, bool validated, ScenePtr scene, const std::vector<double>& bounds);
+
+/// \brief Reads a roadmap written by SaveRoadmap into data via a read-only memory mapping of file_name.
+/// Throws if the file was written for a different robot or different joint limits. The robot includes the shapes of its
+/// collision links, attached objects and the robot link padding and scale of the collision scene. World objects which
+/// have been added or changed (including the world link padding and scale) since the roadmap was saved are collision checked against the validated vertices
+/// and (interpolated) edges, and those in collision are dropped. Vertices and edges of unknown validity are
+/// loaded as they are and left to the lazy planner. Removed world objects do not restore previously pruned edges.
+/// @param data Empty planner data holding the space information of the solver. The states are owned by data.
+/// @return Number of vertices and edges dropped due to changed world objects.
+int LoadRoadmap(const std::string& file_name, ompl::base::PlannerData& data, ScenePtr scene, const std::vector<double>& bounds);
+}
+
+#endif  // EXOTICA_OMPL_SOLVER_OMPL_ROADMAP_H_
@@ -83,6 +83,17 @@ protected:
         return planner;
     }
 
+    /// \brief Allocates a planner which runs num_threads threads, e.g., ompl::geometric::pRRT.
+    template <typename T>
+    static ompl::base::PlannerPtr AllocateParallelPlanner(const ompl::base::SpaceInformationPtr &si, const std::string &new_name, unsigned int num_threads)
+    {
+        ompl::base::PlannerPtr planner = AllocatePlanner<T>(si, new_name);
+        ompl_cast<T>(planner)->setThreadCount(num_threads);
+        return planner;
+    }
+
+    /// \brief Sets the bounds of the state space from the problem unless it has been locked already.
+    void SetupStateSpace();
     void SetGoalState(Eigen::VectorXdRefConst qT, const double eps = 0);
     void PreSolve();
     void PostSolve();
@@ -91,6 +102,7 @@ protected:
     std::shared_ptr<ProblemType> prob_;
     ompl::geometric::SimpleSetupPtr ompl_simple_setup_;
     ompl::base::StateSpacePtr state_space_;
+    ompl_ptr<OMPLStateValidityChecker> validity_checker_;
     ConfiguredPlannerAllocator planner_allocator_;
     std::string algorithm_;
     bool multi_query_ = false;
@@ -31,8 +31,41 @@
 
 namespace exotica
 {
-OMPLStateValidityChecker::OMPLStateValidityChecker(const ompl::base::SpaceInformationPtr &si, const SamplingProblemPtr &prob) : ompl::base::StateValidityChecker(si), prob_(prob)
+OMPLStateValidityChecker::OMPLStateValidityChecker(const ompl::base::SpaceInformationPtr &si, const SamplingProblemPtr &prob, int num_threads) : ompl::base::StateValidityChecker(si), prob_(prob), num_threads_(num_threads)
 {
+    if (num_threads_ < 1) ThrowPretty("Invalid number of threads: " << num_threads_);
+    available_problems_.push_back(prob_);
+}
+
+void OMPLStateValidityChecker::UpdateReplicas()
+{
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (static_cast<int>(available_problems_.size()) != static_cast<int>(replicas_.size()) + 1) ThrowPretty("Cannot update the problem replicas while states are being checked.");
+
+    for (auto &replica : replicas_) replica->CopyStateFrom(*prob_);
+    while (static_cast<int>(replicas_.size()) < num_threads_ - 1)
+    {
+        replicas_.push_back(prob_->CreateReplica());
+        available_problems_.push_back(replicas_.back());
+    }
+}
+
+SamplingProblemPtr OMPLStateValidityChecker::AcquireProblem() const
+{
+    std::unique_lock<std::mutex> lock(pool_mutex_);
+    problem_released_.wait(lock, [this] { return !available_problems_.empty(); });
+    SamplingProblemPtr problem = available_problems_.back();
+    available_problems_.pop_back();
+    return problem;
+}
+
+void OMPLStateValidityChecker::ReleaseProblem(const SamplingProblemPtr &problem) const
+{
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        available_problems_.push_back(problem);
+    }
+    problem_released_.notify_one();
 }
 
 bool OMPLStateValidityChecker::isValid(const ompl::base::State *state) const
@@ -51,7 +84,27 @@ bool OMPLStateValidityChecker::isValid(const ompl::base::State *state, double &d
     boost::static_pointer_cast<OMPLStateSpace>(si_->getStateSpace())->OMPLToExoticaState(state, q);
 #endif
 
-    if (!prob_->IsValid(q))
+    bool is_valid;
+    if (replicas_.empty())
+    {
+        is_valid = prob_->IsValid(q);
+    }
+    else
+    {
+        SamplingProblemPtr problem = AcquireProblem();
+        try
+        {
+            is_valid = problem->IsValid(q);
+        }
+        catch (...)
+        {
+            ReleaseProblem(problem);
+            throw;
+        }
+        ReleaseProblem(problem);
+    }
+
+    if (!is_valid)
     {
         dist = -1;
         return false;
@@ -38,11 +38,16 @@
 #include <ompl/geometric/planners/rrt/RRT.h>
 #include <ompl/geometric/planners/rrt/RRTConnect.h>
 #include <ompl/geometric/planners/rrt/RRTstar.h>
+#include <ompl/geometric/planners/rrt/pRRT.h>
+#include <ompl/geometric/planners/sbl/pSBL.h>
 
 #include <exotica_ompl_solver/ompl_native_solvers.h>
+#include <exotica_ompl_solver/ompl_roadmap.h>
 
 REGISTER_MOTIONSOLVER_TYPE("RRTSolver", exotica::RRTSolver)
 REGISTER_MOTIONSOLVER_TYPE("RRTConnectSolver", exotica::RRTConnectSolver)
+REGISTER_MOTIONSOLVER_TYPE("ParallelRRTSolver", exotica::ParallelRRTSolver)
+REGISTER_MOTIONSOLVER_TYPE("ParallelSBLSolver", exotica::ParallelSBLSolver)
 REGISTER_MOTIONSOLVER_TYPE("PRMSolver", exotica::PRMSolver)
 REGISTER_MOTIONSOLVER_TYPE("LazyPRMSolver", exotica::LazyPRMSolver)
 REGISTER_MOTIONSOLVER_TYPE("ESTSolver", exotica::ESTSolver)
@@ -101,6 +106,24 @@ double RRTConnectSolver::GetRange()
     return rrtcon->getRange();
 }
 
+ParallelRRTSolver::ParallelRRTSolver() = default;
+
+void ParallelRRTSolver::Instantiate(const ParallelRRTSolverInitializer &init)
+{
+    init_ = OMPLSolverInitializer(ParallelRRTSolverInitializer(init));
+    algorithm_ = "Exotica_pRRT";
+    planner_allocator_ = boost::bind(&AllocateParallelPlanner<ompl::geometric::pRRT>, _1, _2, init.NumThreads);
+}
+
+ParallelSBLSolver::ParallelSBLSolver() = default;
+
+void ParallelSBLSolver::Instantiate(const ParallelSBLSolverInitializer &init)
+{
+    init_ = OMPLSolverInitializer(ParallelSBLSolverInitializer(init));
+    algorithm_ = "Exotica_pSBL";
+    planner_allocator_ = boost::bind(&AllocateParallelPlanner<ompl::geometric::pSBL>, _1, _2, init.NumThreads);
+}
+
 ESTSolver::ESTSolver() = default;
 
 void ESTSolver::Instantiate(const ESTSolverInitializer &init)
@@ -191,6 +214,27 @@ void PRMSolver::SetMultiQuery(bool val)
     multi_query_ = val;
 }
 
+void PRMSolver::SaveRoadmap(const std::string &file_name)
+{
+    if (!ompl_simple_setup_->getPlanner()) ThrowNamed("No roadmap to save!");
+    ompl::base::PlannerData data(ompl_simple_setup_->getSpaceInformation());
+    ompl_simple_setup_->getPlanner()->getPlannerData(data);
+    exotica::SaveRoadmap(file_name, data, true, prob_->GetScene(), bounds_);
+}
+
+int PRMSolver::LoadRoadmap(const std::string &file_name)
+{
+    SetupStateSpace();
+    ompl::base::PlannerData data(ompl_simple_setup_->getSpaceInformation());
+    const int num_dropped = exotica::LoadRoadmap(file_name, data, prob_->GetScene(), bounds_);
+    ompl::base::PlannerPtr planner(new ompl::geometric::PRM(data));
+    planner->setName(algorithm_);
+    ompl_simple_setup_->setPlanner(planner);
+    multi_query_ = true;
+    if (debug_) HIGHLIGHT_NAMED(algorithm_, "Loaded roadmap with " << data.numVertices() << " vertices, dropped " << num_dropped << " vertices and edges.");
+    return num_dropped;
+}
+
 LazyPRMSolver::LazyPRMSolver() = default;
 
 void LazyPRMSolver::Instantiate(const LazyPRMSolverInitializer &init)
@@ -240,4 +284,25 @@ void LazyPRMSolver::SetMultiQuery(bool val)
 {
     multi_query_ = val;
 }
+
+void LazyPRMSolver::SaveRoadmap(const std::string &file_name)
+{
+    if (!ompl_simple_setup_->getPlanner()) ThrowNamed("No roadmap to save!");
+    ompl::base::PlannerData data(ompl_simple_setup_->getSpaceInformation());
+    ompl_simple_setup_->getPlanner()->getPlannerData(data);
+    exotica::SaveRoadmap(file_name, data, false, prob_->GetScene(), bounds_);
+}
+
+int LazyPRMSolver::LoadRoadmap(const std::string &file_name)
+{
+    SetupStateSpace();
+    ompl::base::PlannerData data(ompl_simple_setup_->getSpaceInformation());
+    const int num_dropped = exotica::LoadRoadmap(file_name, data, prob_->GetScene(), bounds_);
+    ompl::base::PlannerPtr planner(new ompl::geometric::LazyPRM(data));
+    planner->setName(algorithm_);
+    ompl_simple_setup_->setPlanner(planner);
+    multi_query_ = true;
+    if (debug_) HIGHLIGHT_NAMED(algorithm_, "Loaded roadmap with " << data.numVertices() << " vertices, dropped " << num_dropped << " vertices and edges.");
+    return num_dropped;
+}
 }
@@ -56,6 +56,10 @@ PYBIND11_MODULE(exotica_ompl_solver_py, module)
     py::class_<RRTConnectSolver, std::shared_ptr<RRTConnectSolver>, OMPLSolver<SamplingProblem>> rrtcon(module, "RRTConnectSolver");
     rrtcon.def_property("range", &RRTConnectSolver::GetRange, &RRTConnectSolver::SetRange);
 
+    py::class_<ParallelRRTSolver, std::shared_ptr<ParallelRRTSolver>, OMPLSolver<SamplingProblem>> prrt(module, "ParallelRRTSolver");
+
+    py::class_<ParallelSBLSolver, std::shared_ptr<ParallelSBLSolver>, OMPLSolver<SamplingProblem>> psbl(module, "ParallelSBLSolver");
+
     py::class_<ESTSolver, std::shared_ptr<ESTSolver>, OMPLSolver<SamplingProblem>> est(module, "ESTSolver");
 
     py::class_<KPIECESolver, std::shared_ptr<KPIECESolver>, OMPLSolver<SamplingProblem>> kpiece(module, "KPIECESolver");
@@ -71,6 +75,8 @@ PYBIND11_MODULE(exotica_ompl_solver_py, module)
     prm.def("setup", &PRMSolver::Setup);
     prm.def("edge_count", &PRMSolver::EdgeCount);
     prm.def("milestone_count", &PRMSolver::MilestoneCount);
+    prm.def("save_roadmap", &PRMSolver::SaveRoadmap);
+    prm.def("load_roadmap", &PRMSolver::LoadRoadmap);
 
     py::class_<LazyPRMSolver, std::shared_ptr<LazyPRMSolver>, OMPLSolver<SamplingProblem>> lprm(module, "LazyPRMSolver");
     lprm.def_property("multi_query", &LazyPRMSolver::IsMultiQuery, &LazyPRMSolver::SetMultiQuery);
@@ -79,4 +85,6 @@ PYBIND11_MODULE(exotica_ompl_solver_py, module)
     lprm.def("setup", &LazyPRMSolver::Setup);
     lprm.def("edge_count", &LazyPRMSolver::EdgeCount);
     lprm.def("milestone_count", &LazyPRMSolver::MilestoneCount);
+    lprm.def("save_roadmap", &LazyPRMSolver::SaveRoadmap);
+    lprm.def("load_roadmap", &LazyPRMSolver::LoadRoadmap);
 }
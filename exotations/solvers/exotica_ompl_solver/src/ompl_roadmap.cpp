@@ -0,0 +1,366 @@
+//
+// Copyright (c) 2018, University of Edinburgh
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+#include <geometric_shapes/shape_operations.h>
+
+#include <exotica_ompl_solver/ompl_exo.h>
+#include <exotica_ompl_solver/ompl_roadmap.h>
+
+namespace exotica
+{
+namespace
+{
+constexpr char kRoadmapFileMagic[8] = {'E', 'X', 'O', 'P', 'R', 'M', '\0', '\0'};
+
+// FNV-1a, stable across platforms and standard library implementations
+class Hasher
+{
+public:
+    void Add(const void* data, size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash_ ^= bytes[i];
+            hash_ *= 1099511628211ull;
+        }
+    }
+    void Add(const std::string& value) { Add(value.data(), value.size() + 1); }
+    uint64_t Get() const { return hash_; }
+
+private:
+    uint64_t hash_ = 14695981039346656037ull;
+};
+
+uint64_t HashString(const std::string& value)
+{
+    Hasher hasher;
+    hasher.Add(value);
+    return hasher.Get();
+}
+
+void AddFrame(Hasher& hasher, const KDL::Frame& frame)
+{
+    hasher.Add(frame.p.data, 3 * sizeof(double));
+    hasher.Add(frame.M.data, 9 * sizeof(double));
+}
+
+void AddShape(Hasher& hasher, const KinematicElement& element)
+{
+    if (element.shape)
+    {
+        const int type = static_cast<int>(element.shape->type);
+        hasher.Add(&type, sizeof(int));
+        const Eigen::Vector3d extents = shapes::computeShapeExtents(element.shape.get());
+        hasher.Add(extents.data(), 3 * sizeof(double));
+    }
+    hasher.Add(element.scale.data(), 3 * sizeof(double));
+}
+
+std::shared_ptr<KinematicElement> GetElement(ScenePtr scene, const std::string& name)
+{
+    const std::map<std::string, std::weak_ptr<KinematicElement>>& tree_map = scene->GetKinematicTree().GetTreeMap();
+    const auto it = tree_map.find(name);
+    return it != tree_map.end() ? it->second.lock() : nullptr;
+}
+
+uint64_t GetRobotFingerprint(ScenePtr scene)
+{
+    Hasher hasher;
+    hasher.Add(scene->GetKinematicTree().GetRootFrameName());
+    for (const std::string& joint : scene->GetKinematicTree().GetModelJointNames()) hasher.Add(joint);
+    for (const std::string& joint : scene->GetKinematicTree().GetControlledJointNames()) hasher.Add(joint);
+
+    // Collision geometry of the robot. Attached objects are robot links and are hashed with their pose relative to the new parent.
+    const CollisionScenePtr& collision_scene = scene->GetCollisionScene();
+    for (const std::string& link : collision_scene->GetCollisionRobotLinks())
+    {
+        hasher.Add(link);
+        const std::shared_ptr<KinematicElement> element = GetElement(scene, link);
+        if (!element) continue;
+        AddShape(hasher, *element);
+        const std::shared_ptr<KinematicElement> parent = element->parent.lock();
+        if (parent) hasher.Add(parent->segment.getName());
+        AddFrame(hasher, element->segment.getFrameToTip());
+    }
+    const double robot_link_padding = collision_scene->GetRobotLinkPadding();
+    const double robot_link_scale = collision_scene->GetRobotLinkScale();
+    hasher.Add(&robot_link_padding, sizeof(double));
+    hasher.Add(&robot_link_scale, sizeof(double));
+    return hasher.Get();
+}
+
+// Name and content hashes of the world collision objects, keyed by name hash.
+// Objects attached to the robot are not world objects, they are part of the robot fingerprint.
+std::map<uint64_t, uint64_t> GetWorldObjectHashes(ScenePtr scene, std::map<uint64_t, std::string>* names = nullptr)
+{
+    std::map<uint64_t, uint64_t> hashes;
+    const CollisionScenePtr& collision_scene = scene->GetCollisionScene();
+    const double world_link_padding = collision_scene->GetWorldLinkPadding();
+    const double world_link_scale = collision_scene->GetWorldLinkScale();
+    for (const std::string& object : collision_scene->GetCollisionWorldLinks())
+    {
+        Hasher hasher;
+        const std::shared_ptr<KinematicElement> element = GetElement(scene, object);
+        if (element)
+        {
+            AddShape(hasher, *element);
+            AddFrame(hasher, element->frame);
+        }
+        hasher.Add(&world_link_padding, sizeof(double));
+        hasher.Add(&world_link_scale, sizeof(double));
+        const uint64_t name_hash = HashString(object);
+        hashes[name_hash] = hasher.Get();
+        if (names) (*names)[name_hash] = object;
+    }
+    return hashes;
+}
+
+size_t GetFileSize(const RoadmapFileHeader& header)
+{
+    return sizeof(RoadmapFileHeader) +
+           sizeof(double) * 2 * header.dimension +
+           sizeof(double) * header.num_vertices * header.dimension +
+           sizeof(RoadmapFileEdge) * header.num_edges +
+           sizeof(RoadmapFileWorldObject) * header.num_world_objects +
+           sizeof(RoadmapFileVertex) * header.num_vertices;
+}
+
+// Read-only memory mapping which is released when going out of scope
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& file_name)
+    {
+        const int fd = open(file_name.c_str(), O_RDONLY);
+        if (fd < 0) ThrowPretty("Can't open roadmap file '" << file_name << "'!");
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            ThrowPretty("Can't read roadmap file '" << file_name << "'!");
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data_ == MAP_FAILED) ThrowPretty("Can't map roadmap file '" << file_name << "'!");
+    }
+    ~MappedFile()
+    {
+        if (data_ != nullptr && data_ != MAP_FAILED) munmap(data_, size_);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return static_cast<const char*>(data_); }
+    size_t size() const { return size_; }
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Returns true if the robot is not in collision with any of the objects in configuration q
+bool IsFreeOfObjects(ScenePtr scene, Eigen::VectorXdRefConst q, const std::vector<std::string>& objects)
+{
+    scene->Update(q);
+    for (const std::string& link : scene->GetCollisionScene()->GetCollisionRobotLinks())
+    {
+        for (const std::string& object : objects)
+        {
+            if (!scene->GetCollisionScene()->IsCollisionFree(link, object)) return false;
+        }
+    }
+    return true;
+}
+}
+
+void SaveRoadmap(const std::string& file_name, const ompl::base::PlannerData& data, bool validated, ScenePtr scene, const std::vector<double>& bounds)
+{
+    const OMPLStateSpace* space = data.getSpaceInformation()->getStateSpace()->as<OMPLStateSpace>();
+    const uint32_t dimension = static_cast<uint32_t>(scene->GetKinematicTree().GetNumControlledJoints());
+    if (bounds.size() != 2 * dimension) ThrowPretty("Invalid bounds size " << bounds.size() << ", expected " << 2 * dimension << "!");
+
+    // PRM-type planners report every undirected edge in both directions, store each one only once
+    std::vector<RoadmapFileEdge> edges;
+    std::vector<unsigned int> neighbors;
+    for (unsigned int i = 0; i < data.numVertices(); ++i)
+    {
+        data.getEdges(i, neighbors);
+        for (const unsigned int j : neighbors)
+        {
+            if (j <= i && data.edgeExists(j, i)) continue;
+            RoadmapFileEdge edge;
+            edge.from = i;
+            edge.to = j;
+            edge.flags = validated ? ROADMAP_VALIDATED : 0;
+            edge.reserved = 0;
+            // PRM and LazyPRM do not export their edge weights, they use the path length objective
+            edge.weight = data.getSpaceInformation()->distance(data.getVertex(i).getState(), data.getVertex(j).getState());
+            edges.push_back(edge);
+        }
+    }
+
+    const std::map<uint64_t, uint64_t> world_objects = GetWorldObjectHashes(scene);
+
+    RoadmapFileHeader header;
+    std::memcpy(header.magic, kRoadmapFileMagic, sizeof(header.magic));
+    header.version = kRoadmapFileVersion;
+    header.dimension = dimension;
+    header.num_vertices = data.numVertices();
+    header.num_edges = edges.size();
+    header.num_world_objects = world_objects.size();
+    header.robot_fingerprint = GetRobotFingerprint(scene);
+
+    std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) ThrowPretty("Can't write roadmap file '" << file_name << "'!");
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(bounds.data()), sizeof(double) * bounds.size());
+
+    Eigen::VectorXd q(dimension);
+    for (unsigned int i = 0; i < data.numVertices(); ++i)
+    {
+        space->OMPLToExoticaState(data.getVertex(i).getState(), q);
+        file.write(reinterpret_cast<const char*>(q.data()), sizeof(double) * dimension);
+    }
+    file.write(reinterpret_cast<const char*>(edges.data()), sizeof(RoadmapFileEdge) * edges.size());
+    for (const auto& it : world_objects)
+    {
+        const RoadmapFileWorldObject object = {it.first, it.second};
+        file.write(reinterpret_cast<const char*>(&object), sizeof(object));
+    }
+    for (unsigned int i = 0; i < data.numVertices(); ++i)
+    {
+        const RoadmapFileVertex vertex = {data.getVertex(i).getTag(), validated ? ROADMAP_VALIDATED : 0u};
+        file.write(reinterpret_cast<const char*>(&vertex), sizeof(vertex));
+    }
+    if (!file.good()) ThrowPretty("Failed writing roadmap file '" << file_name << "'!");
+}
+
+int LoadRoadmap(const std::string& file_name, ompl::base::PlannerData& data, ScenePtr scene, const std::vector<double>& bounds)
+{
+    if (data.numVertices() > 0) ThrowPretty("Roadmaps can only be loaded into empty planner data!");
+
+    MappedFile file(file_name);
+    if (file.size() < sizeof(RoadmapFileHeader)) ThrowPretty("Invalid roadmap file '" << file_name << "'!");
+    const RoadmapFileHeader& header = *reinterpret_cast<const RoadmapFileHeader*>(file.data());
+    if (std::memcmp(header.magic, kRoadmapFileMagic, sizeof(header.magic)) != 0) ThrowPretty("Invalid roadmap file '" << file_name << "'!");
+    if (header.version != kRoadmapFileVersion) ThrowPretty("Unsupported roadmap file version " << header.version << "!");
+    if (file.size() != GetFileSize(header)) ThrowPretty("Roadmap file '" << file_name << "' is truncated!");
+    if (header.robot_fingerprint != GetRobotFingerprint(scene)) ThrowPretty("Roadmap '" << file_name << "' was created for a different robot!");
+
+    const unsigned int dimension = header.dimension;
+    if (bounds.size() != 2 * dimension) ThrowPretty("Roadmap dimension " << dimension << " does not match the state space!");
+    const double* file_bounds = reinterpret_cast<const double*>(file.data() + sizeof(RoadmapFileHeader));
+    if (!std::equal(bounds.begin(), bounds.end(), file_bounds)) ThrowPretty("Roadmap '" << file_name << "' was created with different joint limits!");
+
+    const double* states = file_bounds + 2 * dimension;
+    const RoadmapFileEdge* edges = reinterpret_cast<const RoadmapFileEdge*>(states + header.num_vertices * dimension);
+    const RoadmapFileWorldObject* saved_objects = reinterpret_cast<const RoadmapFileWorldObject*>(edges + header.num_edges);
+    const RoadmapFileVertex* vertices = reinterpret_cast<const RoadmapFileVertex*>(saved_objects + header.num_world_objects);
+    for (uint64_t i = 0; i < header.num_edges; ++i)
+    {
+        if (edges[i].from >= header.num_vertices || edges[i].to >= header.num_vertices) ThrowPretty("Invalid edge in roadmap file '" << file_name << "'!");
+    }
+
+    // World objects which were added or changed since the roadmap was created
+    std::map<uint64_t, std::string> names;
+    std::map<uint64_t, uint64_t> world_objects = GetWorldObjectHashes(scene, &names);
+    for (uint64_t i = 0; i < header.num_world_objects; ++i)
+    {
+        const auto it = world_objects.find(saved_objects[i].name_hash);
+        if (it != world_objects.end() && it->second == saved_objects[i].content_hash) world_objects.erase(it);
+    }
+    std::vector<std::string> changed_objects;
+    for (const auto& it : world_objects) changed_objects.push_back(names[it.first]);
+
+    const ompl::base::SpaceInformationPtr& si = data.getSpaceInformation();
+    const OMPLStateSpace* space = si->getStateSpace()->as<OMPLStateSpace>();
+    const Eigen::VectorXd q_restore = scene->GetKinematicTree().GetControlledState();
+    int num_dropped = 0;
+
+    // Vertices
+    std::vector<ompl::base::State*> ompl_states(header.num_vertices);
+    std::vector<int> vertex_index(header.num_vertices, -1);
+    for (uint64_t i = 0; i < header.num_vertices; ++i)
+    {
+        Eigen::Map<const Eigen::VectorXd> q(states + i * dimension, dimension);
+        ompl_states[i] = si->allocState();
+        space->ExoticaToOMPLState(q, ompl_states[i]);
+        if (!changed_objects.empty() && (vertices[i].flags & ROADMAP_VALIDATED) && !IsFreeOfObjects(scene, q, changed_objects))
+        {
+            ++num_dropped;
+            continue;
+        }
+        vertex_index[i] = data.addVertex(ompl::base::PlannerDataVertex(ompl_states[i], vertices[i].tag));
+    }
+
+    // Edges
+    ompl::base::State* interpolated = si->allocState();
+    Eigen::VectorXd q(dimension);
+    for (uint64_t i = 0; i < header.num_edges; ++i)
+    {
+        const RoadmapFileEdge& edge = edges[i];
+        if (vertex_index[edge.from] < 0 || vertex_index[edge.to] < 0) continue;
+
+        bool valid = true;
+        if (!changed_objects.empty() && (edge.flags & ROADMAP_VALIDATED))
+        {
+            const unsigned int segments = si->getStateSpace()->validSegmentCount(ompl_states[edge.from], ompl_states[edge.to]);
+            for (unsigned int j = 1; j < segments && valid; ++j)
+            {
+                si->getStateSpace()->interpolate(ompl_states[edge.from], ompl_states[edge.to], static_cast<double>(j) / static_cast<double>(segments), interpolated);
+                space->OMPLToExoticaState(interpolated, q);
+                valid = IsFreeOfObjects(scene, q, changed_objects);
+            }
+        }
+        if (!valid)
+        {
+            ++num_dropped;
+            continue;
+        }
+        data.addEdge(vertex_index[edge.from], vertex_index[edge.to], ompl::base::PlannerDataEdge(), ompl::base::Cost(edge.weight));
+    }
+
+    // Copy the states into the planner data so that they outlive the mapped file
+    data.decoupleFromPlanner();
+    si->freeState(interpolated);
+    for (ompl::base::State* state : ompl_states) si->freeState(state);
+
+    if (!changed_objects.empty()) scene->Update(q_restore);
+    return num_dropped;
+}
+}
@@ -54,7 +54,8 @@ void OMPLSolver<ProblemType>::SpecifyProblem(PlanningProblemPtr pointer)
     else
         ThrowNamed("Unsupported base type " << prob_->GetScene()->GetKinematicTree().GetControlledBaseType());
     ompl_simple_setup_.reset(new ompl::geometric::SimpleSetup(state_space_));
-    ompl_simple_setup_->setStateValidityChecker(ompl::base::StateValidityCheckerPtr(new OMPLStateValidityChecker(ompl_simple_setup_->getSpaceInformation(), prob_)));
+    validity_checker_.reset(new OMPLStateValidityChecker(ompl_simple_setup_->getSpaceInformation(), prob_, init_.NumThreads));
+    ompl_simple_setup_->setStateValidityChecker(validity_checker_);
     ompl_simple_setup_->setPlannerAllocator(boost::bind(planner_allocator_, _1, algorithm_));
 
     if (init_.Projection.rows() > 0)
@@ -102,6 +103,8 @@ void OMPLSolver<ProblemType>::PostSolve()
     int v = ompl_simple_setup_->getSpaceInformation()->getMotionValidator()->getValidMotionCount();
     int iv = ompl_simple_setup_->getSpaceInformation()->getMotionValidator()->getInvalidMotionCount();
     if (debug_) CONSOLE_BRIDGE_logDebug("There were %d valid motions and %d invalid motions.", v, iv);
+    if (debug_ && prob_->GetValidityCache().IsEnabled())
+        CONSOLE_BRIDGE_logDebug("Validity cache hit rate: %.1f%% (%zu hits, %zu misses).", 100.0 * prob_->GetValidityCache().GetHitRate(), prob_->GetValidityCache().GetNumberOfHits(), prob_->GetValidityCache().GetNumberOfMisses());
 
     if (ompl_simple_setup_->getProblemDefinition()->hasApproximateSolution())
         CONSOLE_BRIDGE_logWarn("Computed solution is approximate");
@@ -186,6 +189,22 @@ void OMPLSolver<ProblemType>::GetPath(Eigen::MatrixXd &traj, ompl::base::Planner
     }
 }
 
+template <class ProblemType>
+void OMPLSolver<ProblemType>::SetupStateSpace()
+{
+    if (!state_space_->as<OMPLStateSpace>()->isLocked())
+    {
+        state_space_->as<OMPLStateSpace>()->SetBounds(prob_);
+        bounds_ = prob_->GetBounds();
+    }
+    else if (!bounds_.empty() && bounds_ != prob_->GetBounds())
+    {
+        ThrowPretty("Cannot set new bounds on locked state space!");
+    }
+
+    ompl_simple_setup_->getSpaceInformation()->setup();
+}
+
 template <class ProblemType>
 void OMPLSolver<ProblemType>::Solve(Eigen::MatrixXd &solution)
 {
@@ -210,17 +229,7 @@ void OMPLSolver<ProblemType>::Solve(Eigen::MatrixXd &solution)
         }
     }
 
-    if (!state_space_->as<OMPLStateSpace>()->isLocked())
-    {
-        state_space_->as<OMPLStateSpace>()->SetBounds(prob_);
-        bounds_ = prob_->GetBounds();
-    }
-    else if (!bounds_.empty() && bounds_ != prob_->GetBounds())
-    {
-        ThrowPretty("Cannot set new bounds on locked state space!");
-    }
-
-    ompl_simple_setup_->getSpaceInformation()->setup();
+    SetupStateSpace();
 
     ompl_simple_setup_->setup();
 
@@ -235,6 +244,9 @@ void OMPLSolver<ProblemType>::Solve(Eigen::MatrixXd &solution)
         ompl::RNG::setSeed(static_cast<long unsigned int>(init_.RandomSeed));
     }
 
+    // Synchronise the problem replicas used for concurrent validity checks with the current scene
+    validity_checker_->UpdateReplicas();
+
     SetGoalState(prob_->GetGoalState(), init_.Epsilon);
 
     ompl::base::ScopedState<> ompl_start_state(state_space_);
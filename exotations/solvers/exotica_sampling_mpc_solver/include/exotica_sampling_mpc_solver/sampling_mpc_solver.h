@@ -0,0 +1,116 @@
+//
+// Copyright (c) 2020, University of Edinburgh
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef EXOTICA_SAMPLING_MPC_SOLVER_SAMPLING_MPC_SOLVER_H_
+#define EXOTICA_SAMPLING_MPC_SOLVER_SAMPLING_MPC_SOLVER_H_
+
+#include <exotica_core/feedback_motion_solver.h>
+#include <exotica_core/problems/dynamic_time_indexed_shooting_problem.h>
+#include <exotica_core/server.h>
+#include <exotica_core/tools/thread_pool.h>
+
+#include <exotica_sampling_mpc_solver/sampling_mpc_solver_initializer.h>
+
+namespace exotica
+{
+// Sampling-based model predictive control. Every iteration rolls out NumSamples noisy
+// copies of the current control sequence and updates the sampling distribution from their costs:
+//  MPPI: G. Williams et al., Information Theoretic MPC for Model-Based Reinforcement Learning, ICRA 2017
+//  CEM:  R. Rubinstein, The Cross-Entropy Method for Combinatorial and Continuous Optimization, 1999
+// Neither requires derivatives of the dynamics or the cost, which makes them suitable for
+// non-smooth costs (e.g., contacts or collisions) where DDP stalls.
+class SamplingMPCSolver : public FeedbackMotionSolver, public Instantiable<SamplingMPCSolverInitializer>
+{
+public:
+    void Instantiate(const SamplingMPCSolverInitializer& init) override;
+
+    ///\brief Solves the problem, starting from the control trajectory of the problem as the mean of the sampling distribution.
+    ///@param solution Returned solution trajectory as a vector of controls.
+    void Solve(Eigen::MatrixXd& solution) override;
+
+    ///\brief Binds the solver to a specific problem which must be pre-initalised
+    ///@param pointer Shared pointer to the motion planning problem
+    ///@return        Successful if the problem is a valid DynamicTimeIndexedProblem
+    void SpecifyProblem(PlanningProblemPtr pointer) override;
+
+    ///\brief Returns the control of the best trajectory found at timestep t.
+    ///     Sampling-based MPC has no local feedback gains: feedback is obtained by re-solving from the measured state.
+    Eigen::VectorXd GetFeedbackControl(Eigen::VectorXdRefConst x, int t) const override;
+
+    ///\brief Returns the wall-clock duration of each iteration of the last call to Solve in seconds.
+    const std::vector<double>& get_iteration_times() const;
+
+    ///\brief Restarts the noise sequence from the given seed.
+    void set_seed(int seed_in);
+
+private:
+    enum class Method
+    {
+        MPPI,
+        CEM
+    };
+
+    DynamicTimeIndexedShootingProblemPtr prob_;                  ///!< Shared pointer to the planning problem.
+    DynamicsSolverPtr dynamics_solver_;                          ///!< Shared pointer to the dynamics solver.
+    std::vector<DynamicTimeIndexedShootingProblemPtr> workers_;  ///!< Independent problem copies for the concurrent rollouts.
+    ThreadPool thread_pool_;                                     ///!< Persistent threads rolling out samples on the problem copies.
+
+    Method method_ = Method::MPPI;
+    int seed_ = 0;         ///!< Seed of the control noise.
+    int solve_count_ = 0;  ///!< Number of calls to Solve since the seed was set, part of the noise seed.
+
+    Eigen::MatrixXd U_mean_;                ///!< Mean of the sampling distribution.
+    Eigen::MatrixXd U_sigma_;               ///!< Standard deviation of the sampling distribution, per control and timestep.
+    Eigen::MatrixXd U_best_;                ///!< Lowest-cost control trajectory found.
+    Eigen::MatrixXd control_limits_;        ///!< Control limits used to clamp the samples, copied at the beginning of solve.
+    std::vector<Eigen::MatrixXd> samples_;  ///!< Control trajectories of the samples of the current iteration.
+    Eigen::VectorXd sample_costs_;          ///!< Costs of the samples of the current iteration.
+    std::vector<double> iteration_times_;   ///!< Duration of each iteration of the last Solve.
+
+    ///\brief Creates and synchronises the problem copies used by the concurrent rollouts and starts a thread for each.
+    void UpdateWorkers();
+
+    ///\brief Draws the samples of the given iteration and rolls them out, NumThreads at a time.
+    void RolloutSamples(int iteration);
+
+    ///\brief Draws sample i of the given iteration from the sampling distribution into samples_[i].
+    void DrawSample(int iteration, int i);
+
+    ///\brief Updates U_mean_ (and for CEM U_sigma_) from the samples and their costs.
+    void UpdateDistribution();
+
+    ///\brief Simulates the control trajectory U on the given problem.
+    /// @param problem The problem to roll out, either prob_ or one of its copies.
+    /// @param U The control trajectory.
+    /// @return The cost of the resulting state and control trajectory.
+    double Rollout(DynamicTimeIndexedShootingProblem& problem, Eigen::MatrixXdRefConst U) const;
+};
+}  // namespace exotica
+
+#endif  // EXOTICA_SAMPLING_MPC_SOLVER_SAMPLING_MPC_SOLVER_H_
@@ -0,0 +1,310 @@
+//
+// Copyright (c) 2020, University of Edinburgh
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <exotica_core/setup.h>
+#include <exotica_sampling_mpc_solver/sampling_mpc_solver.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+
+REGISTER_MOTIONSOLVER_TYPE("SamplingMPCSolver", exotica::SamplingMPCSolver)
+
+namespace exotica
+{
+namespace
+{
+// Mixes v into the hash h with the SplitMix64 finaliser. Seeding a generator from a single
+// hashed value is much cheaper than from a std::seed_seq, which matters as every sample is seeded.
+uint64_t HashCombine(uint64_t h, uint64_t v)
+{
+    h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+}  // namespace
+
+void SamplingMPCSolver::Instantiate(const SamplingMPCSolverInitializer& init)
+{
+    parameters_ = init;
+
+    if (parameters_.Method == "MPPI")
+        method_ = Method::MPPI;
+    else if (parameters_.Method == "CEM")
+        method_ = Method::CEM;
+    else
+        ThrowNamed("Unknown method '" << parameters_.Method << "', expected 'MPPI' or 'CEM'.");
+
+    if (parameters_.NumSamples < 1) ThrowNamed("NumSamples has to be at least 1, got " << parameters_.NumSamples);
+    if (method_ == Method::CEM && (parameters_.NumElites < 1 || parameters_.NumElites > parameters_.NumSamples)) ThrowNamed("NumElites has to be between 1 and NumSamples (" << parameters_.NumSamples << "), got " << parameters_.NumElites);
+    if (parameters_.Temperature <= 0.0) ThrowNamed("Temperature has to be positive, got " << parameters_.Temperature);
+    if (parameters_.UpdateRate <= 0.0 || parameters_.UpdateRate > 1.0) ThrowNamed("UpdateRate has to be in (0, 1], got " << parameters_.UpdateRate);
+    if (parameters_.NumThreads < 1) ThrowNamed("NumThreads has to be at least 1, got " << parameters_.NumThreads);
+
+    set_seed(parameters_.Seed);
+}
+
+void SamplingMPCSolver::SpecifyProblem(PlanningProblemPtr pointer)
+{
+    if (pointer->type() != "exotica::DynamicTimeIndexedShootingProblem")
+    {
+        ThrowNamed("This SamplingMPCSolver can't solve problem of type '" << pointer->type() << "'!");
+    }
+    MotionSolver::SpecifyProblem(pointer);
+    prob_ = std::static_pointer_cast<DynamicTimeIndexedShootingProblem>(pointer);
+    dynamics_solver_ = prob_->GetScene()->GetDynamicsSolver();
+    workers_.clear();
+    solve_count_ = 0;
+}
+
+void SamplingMPCSolver::Solve(Eigen::MatrixXd& solution)
+{
+    if (!prob_) ThrowNamed("Solver has not been initialized!");
+    Timer planning_timer, iteration_timer;
+
+    const int T = prob_->get_T();
+    const int NU = prob_->get_num_controls();
+    prob_->ResetCostEvolution(GetNumberOfMaxIterations() + 1);
+    prob_->PreUpdate();
+    UpdateWorkers();
+    if (parameters_.ClampControls) control_limits_ = dynamics_solver_->get_control_limits();
+
+    const Eigen::VectorXd& sigma = parameters_.NoiseStandardDeviation;
+    if (sigma.size() == 1)
+        U_sigma_ = Eigen::MatrixXd::Constant(NU, T - 1, sigma(0));
+    else if (sigma.size() == NU)
+        U_sigma_ = sigma.replicate(1, T - 1);
+    else
+        ThrowNamed("Wrong NoiseStandardDeviation size. Should either be 1 or " << NU << ", got " << sigma.size());
+
+    // The control trajectory of the problem is the initial mean, e.g. the shifted solution of the previous MPC step.
+    U_mean_ = prob_->get_U();
+    if (parameters_.ClampControls)
+    {
+        for (int t = 0; t < T - 1; ++t) U_mean_.col(t) = U_mean_.col(t).cwiseMax(control_limits_.col(0)).cwiseMin(control_limits_.col(1));
+    }
+    U_best_ = U_mean_;
+    double best_cost = Rollout(*prob_, U_best_);
+    prob_->SetCostEvolution(0, best_cost);
+
+    samples_.assign(parameters_.NumSamples, Eigen::MatrixXd(NU, T - 1));
+    sample_costs_.resize(parameters_.NumSamples);
+    iteration_times_.clear();
+    iteration_times_.reserve(GetNumberOfMaxIterations());
+
+    if (debug_) HIGHLIGHT_NAMED("SamplingMPCSolver", "Running " << parameters_.Method << " with " << parameters_.NumSamples << " samples on " << workers_.size() + 1 << " threads for max " << GetNumberOfMaxIterations() << " iterations");
+
+    for (int iteration = 1; iteration <= GetNumberOfMaxIterations(); ++iteration)
+    {
+        // Check whether user interrupted (Ctrl+C)
+        if (Server::IsRos() && !ros::ok())
+        {
+            if (debug_) HIGHLIGHT("Solving cancelled by user");
+            prob_->termination_criterion = TerminationCriterion::UserDefined;
+            break;
+        }
+
+        iteration_timer.Reset();
+        RolloutSamples(iteration);
+        UpdateDistribution();
+
+        if (!U_mean_.allFinite())
+        {
+            prob_->termination_criterion = TerminationCriterion::Divergence;
+            WARNING_NAMED("SamplingMPCSolver", "Diverged: Controls are not finite.");
+            break;
+        }
+
+        // The new mean is not necessarily better than the best sample, keep whichever is lowest.
+        const double mean_cost = Rollout(*prob_, U_mean_);
+        if (mean_cost < best_cost)
+        {
+            best_cost = mean_cost;
+            U_best_ = U_mean_;
+        }
+        int best_sample;
+        const double best_sample_cost = sample_costs_.minCoeff(&best_sample);
+        if (best_sample_cost < best_cost)
+        {
+            best_cost = best_sample_cost;
+            U_best_ = samples_[best_sample];
+        }
+        iteration_times_.push_back(iteration_timer.GetDuration());
+
+        if (debug_) HIGHLIGHT_NAMED("SamplingMPCSolver", "Iteration " << iteration << std::setprecision(3) << ":\tTime: " << iteration_times_.back() << " s\tMean cost: " << mean_cost << "\tBest cost: " << best_cost);
+        prob_->SetCostEvolution(iteration, best_cost);
+
+        if (iteration == GetNumberOfMaxIterations()) prob_->termination_criterion = TerminationCriterion::IterationLimit;
+    }
+
+    // Store the best solution and leave the problem at its trajectory.
+    Rollout(*prob_, U_best_);
+    solution = U_best_.transpose();
+    ++solve_count_;
+
+    planning_time_ = planning_timer.GetDuration();
+}
+
+void SamplingMPCSolver::UpdateWorkers()
+{
+    // Noisy rollouts draw from the problem's random number generator in
+    // sequence, which the concurrent rollouts could not reproduce.
+    const int num_workers = prob_->get_stochastic_updates_enabled() ? 0 : std::min(parameters_.NumThreads, parameters_.NumSamples) - 1;
+    if (static_cast<int>(workers_.size()) > num_workers) workers_.resize(num_workers);
+    while (static_cast<int>(workers_.size()) < num_workers)
+    {
+        DynamicTimeIndexedShootingProblemInitializer init(prob_->GetParameters());
+        DynamicTimeIndexedShootingProblemPtr worker = std::dynamic_pointer_cast<DynamicTimeIndexedShootingProblem>(Setup::CreateProblem(Initializer(init)));
+        if (!worker) ThrowNamed("Failed to create a copy of the problem for the concurrent rollouts.");
+        workers_.push_back(worker);
+    }
+
+    for (auto& worker : workers_) worker->CopyStateFrom(*prob_);
+    thread_pool_.Resize(num_workers);
+}
+
+void SamplingMPCSolver::RolloutSamples(int iteration)
+{
+    const int num_threads = static_cast<int>(workers_.size()) + 1;
+    // prob_ rolls out the first share of the samples on the calling thread, its copies the others on the persistent threads.
+    thread_pool_.Run([&](int thread) {
+        DynamicTimeIndexedShootingProblem& problem = thread == 0 ? *prob_ : *workers_[thread - 1];
+        // The noise of every sample is seeded independently, so the assignment of samples to threads does not change the result.
+        for (int i = thread; i < parameters_.NumSamples; i += num_threads)
+        {
+            DrawSample(iteration, i);
+            sample_costs_(i) = Rollout(problem, samples_[i]);
+        }
+    });
+}
+
+void SamplingMPCSolver::DrawSample(int iteration, int i)
+{
+    std::mt19937_64 generator(HashCombine(HashCombine(HashCombine(HashCombine(0, seed_), solve_count_), iteration), i));
+    std::normal_distribution<double> standard_normal(0.0, 1.0);
+
+    Eigen::MatrixXd& sample = samples_[i];
+    for (int t = 0; t < sample.cols(); ++t)
+    {
+        for (int k = 0; k < sample.rows(); ++k)
+        {
+            sample(k, t) = U_mean_(k, t) + U_sigma_(k, t) * standard_normal(generator);
+        }
+        if (parameters_.ClampControls) sample.col(t) = sample.col(t).cwiseMax(control_limits_.col(0)).cwiseMin(control_limits_.col(1));
+    }
+}
+
+void SamplingMPCSolver::UpdateDistribution()
+{
+    const int N = parameters_.NumSamples;
+    const double alpha = parameters_.UpdateRate;
+
+    // Samples whose rollout diverged do not contribute.
+    std::vector<int> valid;
+    valid.reserve(N);
+    for (int i = 0; i < N; ++i)
+    {
+        if (std::isfinite(sample_costs_(i))) valid.push_back(i);
+    }
+    if (valid.empty())
+    {
+        WARNING_NAMED("SamplingMPCSolver", "All rollouts diverged, keeping the sampling distribution.");
+        return;
+    }
+
+    Eigen::MatrixXd mean = Eigen::MatrixXd::Zero(U_mean_.rows(), U_mean_.cols());
+    if (method_ == Method::MPPI)
+    {
+        // Path-integral update: exponentially weighted average of the samples.
+        // Costs are shifted by their minimum to avoid underflow of the weights.
+        double min_cost = sample_costs_(valid[0]);
+        for (int i : valid) min_cost = std::min(min_cost, sample_costs_(i));
+        double weight_sum = 0.0;
+        for (int i : valid)
+        {
+            const double weight = std::exp(-(sample_costs_(i) - min_cost) / parameters_.Temperature);
+            mean.noalias() += weight * samples_[i];
+            weight_sum += weight;
+        }
+        mean /= weight_sum;
+        U_mean_ = (1.0 - alpha) * U_mean_ + alpha * mean;
+    }
+    else
+    {
+        // Cross-entropy update: refit the mean and standard deviation to the elite samples.
+        const int num_elites = std::min(parameters_.NumElites, static_cast<int>(valid.size()));
+        std::partial_sort(valid.begin(), valid.begin() + num_elites, valid.end(), [this](int a, int b) {
+            return sample_costs_(a) < sample_costs_(b) || (sample_costs_(a) == sample_costs_(b) && a < b);
+        });
+        for (int e = 0; e < num_elites; ++e) mean += samples_[valid[e]];
+        mean /= num_elites;
+        Eigen::MatrixXd variance = Eigen::MatrixXd::Zero(U_mean_.rows(), U_mean_.cols());
+        for (int e = 0; e < num_elites; ++e) variance += (samples_[valid[e]] - mean).cwiseAbs2();
+        variance /= num_elites;
+        U_mean_ = (1.0 - alpha) * U_mean_ + alpha * mean;
+        U_sigma_ = ((1.0 - alpha) * U_sigma_ + alpha * variance.cwiseSqrt()).cwiseMax(parameters_.MinimumStandardDeviation);
+    }
+}
+
+double SamplingMPCSolver::Rollout(DynamicTimeIndexedShootingProblem& problem, Eigen::MatrixXdRefConst U) const
+{
+    const int T = problem.get_T();
+    const double dt = problem.GetScene()->GetDynamicsSolver()->get_dt();
+    double cost = 0.0;
+    for (int t = 0; t < T - 1; ++t)
+    {
+        problem.Update(U.col(t), t);
+        cost += dt * (problem.GetControlCost(t) + problem.GetStateCost(t));
+    }
+
+    // Add terminal cost
+    cost += problem.GetStateCost(T - 1);
+    return cost;
+}
+
+Eigen::VectorXd SamplingMPCSolver::GetFeedbackControl(Eigen::VectorXdRefConst x, int t) const
+{
+    return U_best_.col(t);
+}
+
+const std::vector<double>& SamplingMPCSolver::get_iteration_times() const
+{
+    return iteration_times_;
+}
+
+void SamplingMPCSolver::set_seed(int seed_in)
+{
+    seed_ = seed_in;
+    solve_count_ = 0;
+}
+
+}  // namespace exotica
@@ -0,0 +1,46 @@
+//
+// Copyright (c) 2020, University of Edinburgh
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <exotica_sampling_mpc_solver/sampling_mpc_solver.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+using namespace exotica;
+namespace py = pybind11;
+
+PYBIND11_MODULE(exotica_sampling_mpc_solver_py, module)
+{
+    module.doc() = "Exotica Sampling-based MPC Solver";
+
+    py::module::import("pyexotica");
+
+    py::class_<SamplingMPCSolver, std::shared_ptr<SamplingMPCSolver>, FeedbackMotionSolver> sampling_mpc_solver(module, "SamplingMPCSolver");
+    sampling_mpc_solver.def_property_readonly("iteration_times", &SamplingMPCSolver::get_iteration_times);
+    sampling_mpc_solver.def("set_seed", &SamplingMPCSolver::set_seed);
+}
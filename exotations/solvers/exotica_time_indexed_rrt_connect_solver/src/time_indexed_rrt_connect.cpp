@@ -147,6 +147,8 @@ void TimeIndexedRRTConnectSolver::PostSolve()
     int v = ompl_simple_setup_->getSpaceInformation()->getMotionValidator()->getValidMotionCount();
     int iv = ompl_simple_setup_->getSpaceInformation()->getMotionValidator()->getInvalidMotionCount();
     CONSOLE_BRIDGE_logDebug("There were %d valid motions and %d invalid motions.", v, iv);
+    if (prob_->GetValidityCache().IsEnabled())
+        CONSOLE_BRIDGE_logDebug("Validity cache hit rate: %.1f%% (%zu hits, %zu misses).", 100.0 * prob_->GetValidityCache().GetHitRate(), prob_->GetValidityCache().GetNumberOfHits(), prob_->GetValidityCache().GetNumberOfMisses());
 
     if (ompl_simple_setup_->getProblemDefinition()->hasApproximateSolution())
         CONSOLE_BRIDGE_logWarn("Computed solution is approximate");
@@ -0,0 +1,241 @@
+//
+// Copyright (c) 2019, University of Edinburgh
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef EXOTICA_CORE_AUTODIFF_DYNAMICS_SOLVER_H_
+#define EXOTICA_CORE_AUTODIFF_DYNAMICS_SOLVER_H_
+
+#include <exotica_core/dynamics_solver.h>
+#include <exotica_core/tools/autodiff_chain_hessian.h>
+#include <exotica_core/tools/autodiff_chain_jacobian.h>
+
+namespace exotica
+{
+/// \brief DynamicsSolver which obtains its derivatives from forward-mode automatic differentiation.
+///
+/// Derived implements the forward dynamics once, generically over the scalar type:
+///
+///     template <typename T>
+///     Eigen::Matrix<T, NX, 1> Dynamics(const Eigen::Matrix<T, NX, 1>& x, const Eigen::Matrix<T, NU, 1>& u) const;
+///
+/// f is evaluated with T = double, fx and fu with a first-order and fxx, fuu and fxu with a second-order AutoDiffScalar.
+/// The derivative vectors are compile-time-sized if NX and NU are. Setting the AutomaticDifferentiation parameter
+/// to false falls back to the finite differences and zero second-order derivatives of AbstractDynamicsSolver.
+template <typename Derived, int NX = Eigen::Dynamic, int NU = Eigen::Dynamic>
+class AutoDiffDynamicsSolver : public DynamicsSolver
+{
+public:
+    void InstantiateBase(const Initializer& init) override
+    {
+        DynamicsSolver::InstantiateBase(init);
+        set_automatic_differentiation(DynamicsSolverInitializer(init).AutomaticDifferentiation);
+    }
+
+    StateVector f(const StateVector& x, const ControlVector& u) override
+    {
+        return static_cast<const Derived*>(this)->template Dynamics<double>(x, u);
+    }
+
+    StateDerivative fx(const StateVector& x, const ControlVector& u) override
+    {
+        if (!automatic_differentiation_) return DynamicsSolver::fx(x, u);
+        ComputeDerivatives(x, u);
+        return get_fx();
+    }
+
+    ControlDerivative fu(const StateVector& x, const ControlVector& u) override
+    {
+        if (!automatic_differentiation_) return DynamicsSolver::fu(x, u);
+        ComputeDerivatives(x, u);
+        return get_fu();
+    }
+
+    Eigen::Tensor<double, 3> fxx(const StateVector& x, const ControlVector& u) override
+    {
+        if (!automatic_differentiation_) return DynamicsSolver::fxx(x, u);
+        ComputeSecondOrderDerivatives(x, u);
+        return fxx_ad_;
+    }
+
+    Eigen::Tensor<double, 3> fuu(const StateVector& x, const ControlVector& u) override
+    {
+        if (!automatic_differentiation_) return DynamicsSolver::fuu(x, u);
+        ComputeSecondOrderDerivatives(x, u);
+        return fuu_ad_;
+    }
+
+    Eigen::Tensor<double, 3> fxu(const StateVector& x, const ControlVector& u) override
+    {
+        if (!automatic_differentiation_) return DynamicsSolver::fxu(x, u);
+        ComputeSecondOrderDerivatives(x, u);
+        return fxu_ad_;
+    }
+
+    /// \brief Computes the Hessian of v^T f in a single second-order pass over a scalar output instead of contracting fxx, fuu and fxu.
+    void ContractedSecondOrderDerivatives(const StateVector& x, const ControlVector& u, const StateVector& v, StateDerivative& v_fxx, ControlHessian& v_fuu, ControlStateHessian& v_fxu) override
+    {
+        if (!automatic_differentiation_) return DynamicsSolver::ContractedSecondOrderDerivatives(x, u, v, v_fxx, v_fuu, v_fxu);
+
+        const int nx = get_num_positions() + get_num_velocities();
+        const int nu = get_num_controls();
+        typename ContractedHessian::InputType z(nx + nu);
+        z << x, u;
+        typename ContractedHessian::ValueType value;
+        typename ContractedHessian::JacobianType jacobian(1, nx + nu);
+        typename ContractedHessian::HessianType hessian;
+        ContractedHessian(ContractedFunctor(*static_cast<const Derived*>(this), nx, nu, v))(z, value, jacobian, hessian);
+
+        v_fxx = hessian[0].topLeftCorner(nx, nx);
+        v_fuu = hessian[0].bottomRightCorner(nu, nu);
+        v_fxu = hessian[0].bottomLeftCorner(nu, nx);
+    }
+
+    /// \brief Returns whether the derivatives are computed by automatic differentiation (true) or finite differences (false).
+    bool get_automatic_differentiation() const
+    {
+        return automatic_differentiation_;
+    }
+
+    /// \brief Switches between automatic differentiation (true) and finite differences (false).
+    void set_automatic_differentiation(bool automatic_differentiation_in)
+    {
+        automatic_differentiation_ = automatic_differentiation_in;
+        second_order_cache_valid_ = false;
+        ClearDerivativeCache();
+    }
+
+protected:
+    void ComputeDerivativesInternal(const StateVector& x, const ControlVector& u, StateVector& xdot, StateDerivative& fx_out, ControlDerivative& fu_out) override
+    {
+        if (!automatic_differentiation_) return DynamicsSolver::ComputeDerivativesInternal(x, u, xdot, fx_out, fu_out);
+
+        const int nx = get_num_positions() + get_num_velocities();
+        const int nu = get_num_controls();
+        typename Jacobian::InputType z(nx + nu);
+        z << x, u;
+        typename Jacobian::ValueType value(nx);
+        typename Jacobian::JacobianType jacobian(nx, nx + nu);
+        Jacobian(Functor(*static_cast<const Derived*>(this), nx, nu))(z, value, jacobian);
+
+        xdot = value;
+        fx_out = jacobian.leftCols(nx);
+        fu_out = jacobian.rightCols(nu);
+    }
+
+private:
+    static constexpr int NZ = (NX == Eigen::Dynamic || NU == Eigen::Dynamic) ? Eigen::Dynamic : NX + NU;
+
+    /// \brief Evaluates Derived::Dynamics on the stacked input z = [x; u].
+    struct Functor : public FunctorBase<double, NZ, NX, NZ>
+    {
+        Functor(const Derived& solver_in, int nx_in, int nu_in) : solver(solver_in), nx(nx_in), nu(nu_in) {}
+
+        template <typename T>
+        void operator()(const Eigen::Matrix<T, NZ, 1>& z, Eigen::Matrix<T, NX, 1>& xdot) const
+        {
+            const Eigen::Matrix<T, NX, 1> x = z.head(nx);
+            const Eigen::Matrix<T, NU, 1> u = z.tail(nu);
+            xdot = solver.template Dynamics<T>(x, u);
+        }
+
+        const Derived& solver;
+        int nx, nu;
+    };
+
+    /// \brief Evaluates v^T Derived::Dynamics on the stacked input z = [x; u].
+    struct ContractedFunctor : public FunctorBase<double, NZ, 1, NZ>
+    {
+        ContractedFunctor(const Derived& solver_in, int nx_in, int nu_in, const StateVector& v_in) : solver(solver_in), nx(nx_in), nu(nu_in), v(v_in) {}
+
+        template <typename T>
+        void operator()(const Eigen::Matrix<T, NZ, 1>& z, Eigen::Matrix<T, 1, 1>& y) const
+        {
+            const Eigen::Matrix<T, NX, 1> x = z.head(nx);
+            const Eigen::Matrix<T, NU, 1> u = z.tail(nu);
+            const Eigen::Matrix<T, NX, 1> xdot = solver.template Dynamics<T>(x, u);
+            // Accumulate explicitly, the compound operators of AutoDiffScalar are not safe to use here.
+            T sum = T(0.0);
+            for (int i = 0; i < nx; ++i) sum = sum + T(v(i)) * xdot(i);
+            y(0) = sum;
+        }
+
+        const Derived& solver;
+        int nx, nu;
+        const StateVector& v;
+    };
+
+    typedef Eigen::AutoDiffChainJacobian<Functor> Jacobian;
+    typedef Eigen::AutoDiffChainHessian<Functor> Hessian;
+    typedef Eigen::AutoDiffChainHessian<ContractedFunctor> ContractedHessian;
+
+    /// \brief Computes fxx, fuu and fxu from a single second-order pass, unless they are cached for (x, u).
+    void ComputeSecondOrderDerivatives(const StateVector& x, const ControlVector& u)
+    {
+        if (second_order_cache_valid_ && second_order_x_.size() == x.size() && second_order_u_.size() == u.size() && second_order_x_ == x && second_order_u_ == u) return;
+
+        const int nx = get_num_positions() + get_num_velocities();
+        const int nu = get_num_controls();
+        typename Hessian::InputType z(nx + nu);
+        z << x, u;
+        typename Hessian::ValueType value(nx);
+        typename Hessian::JacobianType jacobian(nx, nx + nu);
+        typename Hessian::HessianType hessian;
+        Hessian(Functor(*static_cast<const Derived*>(this), nx, nu))(z, value, jacobian, hessian);
+
+        // Layout of the tensors: the first index is the second partial derivative, the second index the output of f.
+        fxx_ad_ = Eigen::Tensor<double, 3>(nx, nx, nx);
+        fuu_ad_ = Eigen::Tensor<double, 3>(nu, nx, nu);
+        fxu_ad_ = Eigen::Tensor<double, 3>(nu, nx, nx);
+        for (int i = 0; i < nx; ++i)
+        {
+            for (int k = 0; k < nx; ++k)
+                for (int j = 0; j < nx; ++j)
+                    fxx_ad_(k, i, j) = hessian[i](j, k);
+            for (int a = 0; a < nu; ++a)
+            {
+                for (int b = 0; b < nu; ++b)
+                    fuu_ad_(a, i, b) = hessian[i](nx + a, nx + b);
+                for (int j = 0; j < nx; ++j)
+                    fxu_ad_(a, i, j) = hessian[i](j, nx + a);
+            }
+        }
+
+        second_order_x_ = x;
+        second_order_u_ = u;
+        second_order_cache_valid_ = true;
+    }
+
+    bool automatic_differentiation_ = true;    ///< Whether to use automatic differentiation instead of finite differences.
+    bool second_order_cache_valid_ = false;    ///< Whether fxx_ad_, fuu_ad_ and fxu_ad_ are valid for (second_order_x_, second_order_u_).
+    StateVector second_order_x_;               ///< State of the cached second-order derivatives.
+    ControlVector second_order_u_;             ///< Control of the cached second-order derivatives.
+    Eigen::Tensor<double, 3> fxx_ad_, fuu_ad_, fxu_ad_;
+};
+}  // namespace exotica
+
+#endif  // EXOTICA_CORE_AUTODIFF_DYNAMICS_SOLVER_H_
@@ -210,14 +210,21 @@ public:
     /// @param[in]  motion_transforms   A tuple consisting out of collision object name and its beginning and final transform.
     /// @return     Vector of deepest ContinuousCollisionProxy (one per dimension).
     virtual std::vector<ContinuousCollisionProxy> ContinuousCollisionCast(const std::vector<std::vector<std::tuple<std::string, Eigen::Isometry3d, Eigen::Isometry3d>>>& motion_transforms) { ThrowPretty("Not implemented!"); }
+    /// @brief      Performs a continuous collision check along a joint space trajectory, sweeping all pairs allowed to collide across each segment between consecutive waypoints.
+    /// @param[in]  trajectory  Joint space trajectory, one configuration of the controlled joints per row (T x nq).
+    /// @param[in]  self        Indicate if self collision check is required.
+    /// @return     Vector of T-1 ContinuousCollisionProxy holding the earliest contact along each segment.
+    virtual std::vector<ContinuousCollisionProxy> ContinuousCollisionCheckTrajectory(Eigen::MatrixXdRefConst trajectory, bool self = true) { ThrowPretty("Not implemented!"); }
     /// @brief      Returns the translation of the named collision object.
     /// @param[in]  name    Name of the collision object to query.
     virtual Eigen::Vector3d GetTranslation(const std::string& name) = 0;
 
-    void SetACM(const AllowedCollisionMatrix& acm)
+    virtual void SetACM(const AllowedCollisionMatrix& acm)
     {
         acm_ = acm;
+        ++revision_;
     }
+    const AllowedCollisionMatrix& GetACM() const { return acm_; }
 
     bool GetAlwaysExternallyUpdatedCollisionScene() const { return always_externally_updated_collision_scene_; }
     void SetAlwaysExternallyUpdatedCollisionScene(const bool value)
@@ -231,6 +238,7 @@ public:
         if (scale < 0.0)
             ThrowPretty("Link scaling needs to be greater than or equal to 0");
         robot_link_scale_ = scale;
+        ++revision_;
     }
 
     double GetWorldLinkScale() const { return world_link_scale_; }
@@ -239,6 +247,7 @@ public:
         if (scale < 0.0)
             ThrowPretty("Link scaling needs to be greater than or equal to 0");
         world_link_scale_ = scale;
+        ++revision_;
     }
 
     double GetRobotLinkPadding() const { return robot_link_padding_; }
@@ -247,6 +256,7 @@ public:
         if (padding < 0.0)
             HIGHLIGHT_NAMED("SetRobotLinkPadding", "Generally, padding should be positive.");
         robot_link_padding_ = padding;
+        ++revision_;
     }
 
     double GetWorldLinkPadding() const { return world_link_padding_; }
@@ -255,14 +265,19 @@ public:
         if (padding < 0.0)
             HIGHLIGHT_NAMED("SetRobotLinkPadding", "Generally, padding should be positive.");
         world_link_padding_ = padding;
+        ++revision_;
     }
 
     bool GetReplacePrimitiveShapesWithMeshes() const { return replace_primitive_shapes_with_meshes_; }
     void SetReplacePrimitiveShapesWithMeshes(const bool value)
     {
         replace_primitive_shapes_with_meshes_ = value;
+        ++revision_;
     }
 
+    /// \brief Returns a counter which is incremented whenever the ACM, the link scaling or padding, or the shape replacement change.
+    unsigned int GetRevision() const { return revision_; }
+
     /// \brief Creates the collision scene from kinematic elements.
     /// \param objects Vector kinematic element pointers of collision objects.
     virtual void UpdateCollisionObjects(const std::map<std::string, std::weak_ptr<KinematicElement>>& objects) = 0;
@@ -307,6 +322,9 @@ protected:
 
     /// Replace primitive shapes with meshes internally (e.g. when primitive shape algorithms are brittle, i.e. in FCL)
     bool replace_primitive_shapes_with_meshes_ = false;
+
+    /// Incremented on changes of the ACM, link scaling, padding or shape replacement, see GetRevision
+    unsigned int revision_ = 0;
 };
 
 typedef std::shared_ptr<CollisionScene> CollisionScenePtr;
@@ -54,10 +54,14 @@ template <typename T, int NX, int NU>
 class AbstractDynamicsSolver : public Object, Uncopyable, public virtual InstantiableBase
 {
 public:
-    typedef Eigen::Matrix<T, NX, 1> StateVector;         ///< Convenience definition for a StateVector containing both position and velocity (dimension NX x 1)
-    typedef Eigen::Matrix<T, NU, 1> ControlVector;       ///< Convenience definition for a ControlVector (dimension NU x 1)
-    typedef Eigen::Matrix<T, NX, NX> StateDerivative;    ///< Convenience definition for a StateDerivative
-    typedef Eigen::Matrix<T, NX, NU> ControlDerivative;  ///< Convenience definition for a ControlDerivative
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef Eigen::Matrix<T, NX, 1> StateVector;           ///< Convenience definition for a StateVector containing both position and velocity (dimension NX x 1)
+    typedef Eigen::Matrix<T, NU, 1> ControlVector;         ///< Convenience definition for a ControlVector (dimension NU x 1)
+    typedef Eigen::Matrix<T, NX, NX> StateDerivative;      ///< Convenience definition for a StateDerivative
+    typedef Eigen::Matrix<T, NX, NU> ControlDerivative;    ///< Convenience definition for a ControlDerivative
+    typedef Eigen::Matrix<T, NU, NU> ControlHessian;       ///< Convenience definition for a contracted second derivative w.r.t. the control (dimension NU x NU)
+    typedef Eigen::Matrix<T, NU, NX> ControlStateHessian;  ///< Convenience definition for a contracted mixed second derivative (dimension NU x NX)
 
     AbstractDynamicsSolver();
     virtual ~AbstractDynamicsSolver();
@@ -92,6 +96,40 @@ public:
     virtual Eigen::Tensor<T, 3> fuu(const StateVector& x, const ControlVector& u);
     virtual Eigen::Tensor<T, 3> fxu(const StateVector& x, const ControlVector& u);
 
+    /// \brief Second-order derivatives of the forward dynamics contracted with v, i.e. the Hessians of v^T f.
+    ///
+    /// Equivalent to contracting fxx, fuu and fxu with v along their second (output) index, without forming the tensors:
+    /// v_fxx(k, j) = sum_i v_i d^2 f_i / dx_j dx_k, v_fuu(a, b) = sum_i v_i d^2 f_i / du_a du_b and v_fxu(a, j) = sum_i v_i d^2 f_i / dx_j du_a.
+    /// The default implementation takes central finite differences of the directional derivatives fx^T v and fu^T v
+    /// (2 * (NX + NU) evaluations of ComputeDerivativesInternal). Solvers with analytic second-order derivatives should override it.
+    virtual void ContractedSecondOrderDerivatives(const StateVector& x, const ControlVector& u, const StateVector& v, StateDerivative& v_fxx, ControlHessian& v_fuu, ControlStateHessian& v_fxu);
+
+    /// \brief Computes the forward dynamics and its derivatives w.r.t. the state and the control in a single call.
+    ///
+    /// The results are cached for the last (x, u) such that repeated calls with the same inputs (e.g., from fx and fu for the same timestep) return immediately.
+    /// Use get_state_derivative(), get_fx() and get_fu() (and get_fxx(), get_fuu(), get_fxu() if second_order is set) to access the results.
+    /// \param x             State
+    /// \param u             Control
+    /// \param second_order  Whether to also compute the second-order derivatives fxx, fuu and fxu
+    void ComputeDerivatives(const StateVector& x, const ControlVector& u, bool second_order = false);
+
+    /// \brief Returns the forward dynamics evaluated by the last call to ComputeDerivatives.
+    const StateVector& get_state_derivative() const;
+
+    /// \brief Returns the derivative w.r.t. the state evaluated by the last call to ComputeDerivatives.
+    const StateDerivative& get_fx() const;
+
+    /// \brief Returns the derivative w.r.t. the control evaluated by the last call to ComputeDerivatives.
+    const ControlDerivative& get_fu() const;
+
+    /// \brief Returns the second-order derivatives evaluated by the last call to ComputeDerivatives with second_order set.
+    const Eigen::Tensor<T, 3>& get_fxx() const;
+    const Eigen::Tensor<T, 3>& get_fuu() const;
+    const Eigen::Tensor<T, 3>& get_fxu() const;
+
+    /// \brief Invalidates the derivatives cached by ComputeDerivatives, e.g., after changing parameters of the dynamic system.
+    void ClearDerivativeCache();
+
     /// \brief Simulates the dynamic system from starting state x using control u for t seconds
     ///
     /// Simulates the system and steps the simulation by timesteps dt for a total time of t using the specified integration scheme starting from state x and with controls u.
@@ -99,9 +137,19 @@ public:
 
     /// \brief Return the difference of two state vectors.
     ///     Used when e.g. angle differences need to be wrapped from [-pi; pi]
-    virtual StateVector StateDelta(const StateVector& x_1, const StateVector& x_2)
+    ///     Forwards to the overload below. It is final so that a solver still overriding this overload fails to compile instead of being bypassed.
+    virtual StateVector StateDelta(const StateVector& x_1, const StateVector& x_2) final
     {
-        return x_1 - x_2;
+        StateVector delta(x_1.size());
+        StateDelta(x_1, x_2, delta);
+        return delta;
+    }
+
+    /// \brief Writes the difference of two state vectors into delta without allocating, e.g. for columns of a trajectory.
+    ///     Solvers with a custom state difference override this overload (with a using-declaration to keep the one above visible).
+    virtual void StateDelta(Eigen::Ref<const StateVector> x_1, Eigen::Ref<const StateVector> x_2, Eigen::Ref<StateVector> delta)
+    {
+        delta = x_1 - x_2;
     }
 
     /// \brief Returns the position-part of the state vector to update the scene.
@@ -132,7 +180,7 @@ public:
     /// \brief Returns the control limits vector.
     //  returns: Two-column matrix, first column contains low control limits,
     //      second - the high control limits
-    Eigen::MatrixXd get_control_limits();
+    const Eigen::MatrixXd& get_control_limits();
     void set_control_limits(Eigen::VectorXd control_limits_low, Eigen::VectorXd control_limits_high);
 
     virtual ControlVector InverseDynamics(const StateVector& state);
@@ -157,12 +205,36 @@ protected:
     /// \brief Integrates the dynamic system from state x with controls u applied for one timestep dt using the selected integrator.
     inline StateVector Integrate(const StateVector& x, const ControlVector& u);
 
+    /// \brief Computes the forward dynamics and its first-order derivatives for ComputeDerivatives.
+    ///
+    /// The default implementation calls f, fx and fu individually (i.e., finite differences unless they are overridden).
+    /// Solvers that obtain all terms from a single computation should override this method. If fx or fu are then implemented in terms of ComputeDerivatives, this method must not call them.
+    virtual void ComputeDerivativesInternal(const StateVector& x, const ControlVector& u, StateVector& xdot, StateDerivative& fx_out, ControlDerivative& fu_out);
+
     void InitializeSecondOrderDerivatives();
     Eigen::Tensor<T, 3> fxx_default_, fuu_default_, fxu_default_;
+
+private:
+    bool derivative_cache_valid_ = false;               ///< Whether the first-order derivatives for (cached_x_, cached_u_) are cached.
+    bool second_order_derivative_cache_valid_ = false;  ///< Whether the second-order derivatives for (cached_x_, cached_u_) are cached.
+    StateVector cached_x_;                              ///< State of the cached derivatives.
+    ControlVector cached_u_;                            ///< Control of the cached derivatives.
+    StateVector cached_xdot_;                           ///< Cached forward dynamics.
+    StateDerivative cached_fx_;                         ///< Cached derivative w.r.t. the state.
+    ControlDerivative cached_fu_;                       ///< Cached derivative w.r.t. the control.
+    Eigen::Tensor<T, 3> cached_fxx_, cached_fuu_, cached_fxu_;
+
+    // Buffers of the finite differences in ContractedSecondOrderDerivatives, sized on the first call.
+    StateVector fd_x_, fd_xdot_;
+    ControlVector fd_u_;
+    StateDerivative fd_fx_low_, fd_fx_high_;
+    ControlDerivative fd_fu_low_, fd_fu_high_;
 };
 
 typedef AbstractDynamicsSolver<double, Eigen::Dynamic, Eigen::Dynamic> DynamicsSolver;
 
+extern template class AbstractDynamicsSolver<double, Eigen::Dynamic, Eigen::Dynamic>;
+
 typedef std::shared_ptr<exotica::DynamicsSolver> DynamicsSolverPtr;
 }  // namespace exotica
 
@@ -33,6 +33,7 @@
 #include <map>
 #include <random>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <moveit/robot_model/robot_model.h>
@@ -61,6 +62,13 @@ enum KinematicRequestFlags
     KIN_J_DOT = 8
 };
 
+/// @brief Kernels for the time derivative of the Jacobian (KIN_J_DOT).
+enum JacobianDerivativeMethod
+{
+    JDOT_PAIRWISE = 0,   //!< Sums the contributions of all pairs of Jacobian columns, O(n^2).
+    JDOT_PREFIX_SUM = 1  //!< Evaluates the same sum with prefix sums over the Jacobian columns, O(n).
+};
+
 inline KinematicRequestFlags operator|(KinematicRequestFlags a, KinematicRequestFlags b)
 {
     return static_cast<KinematicRequestFlags>(static_cast<int>(a) | static_cast<int>(b));
@@ -97,6 +105,15 @@ struct KinematicFrame
     KDL::Frame temp_AB;
     KDL::Frame temp_A;
     KDL::Frame temp_B;
+
+    // Indices of frame_A and frame_B in the flat tree (see FlatKinematicTree), valid for the given flat tree revision.
+    int index_A = -1;
+    int index_B = -1;
+    int flat_tree_revision = -1;
+
+    // Controlled elements between the common ancestor of frame_A and frame_B and each of the two frames (flat tree indices).
+    std::vector<int> jacobian_chain_A;
+    std::vector<int> jacobian_chain_B;
 };
 
 /// @brief The KinematicResponse is the container to keep kinematic update data.
@@ -114,6 +131,72 @@ struct KinematicResponse
     ArrayJacobian jacobian_dot;
 };
 
+/// @brief Flattened, topologically sorted copy of the kinematic tree stored as a structure of arrays.
+/// It is compiled from the KinematicElement graph whenever the model changes and is used for the
+/// forward pass in KinematicTree::UpdateTree. Parents always precede their children.
+struct FlatKinematicTree
+{
+    enum JointType
+    {
+        JOINT_FIXED = 0,
+        JOINT_REVOLUTE = 1,
+        JOINT_PRISMATIC = 2
+    };
+
+    void Clear();
+    void Add(std::shared_ptr<KinematicElement> element, int parent_index);
+    void ComputeSubtrees();
+    int Size() const { return static_cast<int>(parent.size()); }
+    int IndexOf(const std::shared_ptr<KinematicElement>& element) const;
+
+    /// @brief Computes the pose of element i relative to its parent.
+    /// @param i Index into the flat arrays.
+    /// @param q Joint position (ignored for fixed joints).
+    inline KDL::Frame Pose(int i, double q) const
+    {
+        switch (type[i])
+        {
+            case JOINT_REVOLUTE:
+                return KDL::Frame(KDL::Rotation::Rot2(axis[i], q), origin[i]) * offset[i];
+            case JOINT_PRISMATIC:
+                return KDL::Frame(origin[i] + axis[i] * q) * offset[i];
+            default:
+                return offset[i];
+        }
+    }
+
+    /// @brief Computes the unit joint twist of element i relative to its parent, equivalent to KDL::Segment::twist(q, 1.0).
+    inline KDL::Twist Twist(int i, double q) const
+    {
+        switch (type[i])
+        {
+            case JOINT_REVOLUTE:
+                return KDL::Twist(KDL::Vector::Zero(), axis[i]).RefPoint(KDL::Rotation::Rot2(axis[i], q) * offset[i].p);
+            case JOINT_PRISMATIC:
+                return KDL::Twist(axis[i], KDL::Vector::Zero());
+            default:
+                return KDL::Twist::Zero();
+        }
+    }
+
+    std::vector<std::shared_ptr<KinematicElement>> element;  //!< Keeps the compiled elements alive until the tree is compiled again.
+    std::vector<int> parent;                                 //!< Index of the parent element, -1 for the root.
+    std::vector<JointType> type;
+    std::vector<KDL::Vector> axis;    //!< Unit joint axis in the parent frame.
+    std::vector<KDL::Vector> origin;  //!< Joint origin in the parent frame.
+    std::vector<KDL::Frame> offset;   //!< Segment tip relative to the joint frame.
+    std::vector<int> state_index;     //!< Index into the tree state vector, -1 for fixed joints.
+    std::vector<int> control_id;      //!< Column in the Jacobian, -1 for elements that are not controlled.
+    std::vector<KDL::Frame> frame;    //!< World frame of each element after the last update.
+
+    // Elements are stored in depth-first order so that the subtree of element i spans [i, subtree_end[i]).
+    std::vector<int> subtree_end;
+    std::vector<double> state;                   //!< Joint position each element was last updated with.
+    std::vector<char> is_trajectory_generated;   //!< Whether each element was trajectory generated during the last update.
+    std::unordered_map<const KinematicElement*, int> index;  //!< Index of each compiled element.
+    int revision = 0;                                        //!< Incremented every time the tree is compiled.
+};
+
 /// @brief The KinematicSolution is created from - and maps into - a KinematicResponse.
 class KinematicSolution
 {
@@ -141,6 +224,14 @@ public:
     BaseType GetControlledBaseType() const;
     std::shared_ptr<KinematicResponse> RequestFrames(const KinematicsRequest& request);
     void Update(Eigen::VectorXdRefConst x);
+
+    /// @brief Evaluates the requested frames for a batch of configurations.
+    /// The outputs have one row per configuration, so each column holds one coordinate for all configurations.
+    /// The tree is returned to its current configuration afterwards.
+    /// @param X Configurations, one per row (N x number of controlled joints).
+    /// @param frames Position and quaternion (x, y, z, qx, qy, qz, qw) of each requested frame (N x 7 * number of frames).
+    /// @param jacobians Column-major Jacobian of each requested frame if KIN_J was requested, otherwise empty (N x 6 * number of controlled joints * number of frames).
+    void UpdateBatch(Eigen::MatrixXdRefConst X, Eigen::MatrixXd& frames, Eigen::MatrixXd& jacobians);
     void ResetJointLimits();
     const Eigen::MatrixXd& GetJointLimits() const { return joint_limits_; }
     void SetJointLimitsLower(Eigen::VectorXdRefConst lower_in);
@@ -182,6 +273,8 @@ public:
     Eigen::MatrixXd Jacobian(std::shared_ptr<KinematicElement> element_A, const KDL::Frame& offset_a, std::shared_ptr<KinematicElement> element_B, const KDL::Frame& offset_b) const;
     Eigen::MatrixXd Jacobian(const std::string& element_A, const KDL::Frame& offset_a, const std::string& element_B, const KDL::Frame& offset_b) const;
     Eigen::MatrixXd Jdot(const KDL::Jacobian& jacobian);
+    void SetJacobianDerivativeMethod(JacobianDerivativeMethod method) { jacobian_derivative_method_ = method; }
+    JacobianDerivativeMethod GetJacobianDerivativeMethod() const { return jacobian_derivative_method_; }
 
     void ResetModel();
     std::shared_ptr<KinematicElement> AddElement(const std::string& name, const Eigen::Isometry3d& transform, const std::string& parent = "", shapes::ShapeConstPtr shape = shapes::ShapeConstPtr(nullptr), const KDL::RigidBodyInertia& inertia = KDL::RigidBodyInertia::Zero(), const Eigen::Vector4d& color = Eigen::Vector4d(0.5, 0.5, 0.5, 1.0), const std::vector<VisualElement>& visual = {}, bool is_controlled = false);
@@ -230,16 +323,26 @@ public:
 
     void SetKinematicResponse(std::shared_ptr<KinematicResponse> response_in) { solution_ = response_in; }
     std::shared_ptr<KinematicResponse> GetKinematicResponse() { return solution_; }
+
+    /// @brief Number of tree segments whose frames have been recomputed since the last call to ResetRecomputedSegmentCount.
+    /// Only the subtrees below joints whose values changed are recomputed on every update.
+    std::size_t GetRecomputedSegmentCount() const { return recomputed_segment_count_; }
+    void ResetRecomputedSegmentCount() { recomputed_segment_count_ = 0; }
     bool debug = false;
 
 private:
     void BuildTree(const KDL::Tree& RobotKinematics);
     void AddElementFromSegmentMapIterator(KDL::SegmentMap::const_iterator segment, std::shared_ptr<KinematicElement> parent);
+    void CompileTree();
     void UpdateTree();
     void UpdateFK();
+    void UpdateFrameIndices(KinematicFrame& frame) const;
+    bool FrameNeedsUpdate(KinematicFrame& frame) const;
     void UpdateJ();
     void ComputeJ(KinematicFrame& frame, KDL::Jacobian& jacobian) const;
     void ComputeJdot(const KDL::Jacobian& jacobian, KDL::Jacobian& jacobian_dot) const;
+    void ComputeJdotPairwise(const KDL::Jacobian& jacobian, KDL::Jacobian& jacobian_dot) const;
+    void ComputeJdotPrefixSum(const KDL::Jacobian& jacobian, KDL::Jacobian& jacobian_dot) const;
     void UpdateJdot();
 
     // Joint limits
@@ -265,6 +368,13 @@ private:
     std::map<std::string, std::weak_ptr<KinematicElement>> tree_map_;
     std::map<std::string, std::weak_ptr<KinematicElement>> collision_tree_map_;
     std::shared_ptr<KinematicElement> root_;
+    FlatKinematicTree flat_tree_;
+    bool flat_tree_needs_compiling_ = true;  //!< Set whenever the structure of the tree changes.
+    std::vector<int> updated_subtrees_;      //!< Roots of the subtrees recomputed during the last forward pass.
+    std::vector<char> updated_frames_;       //!< Whether each requested frame was recomputed during the last update.
+    std::weak_ptr<KinematicResponse> last_updated_solution_;
+    std::size_t recomputed_segment_count_ = 0;
+    JacobianDerivativeMethod jacobian_derivative_method_ = JDOT_PREFIX_SUM;
     std::vector<std::weak_ptr<KinematicElement>> controlled_joints_;
     std::map<std::string, std::weak_ptr<KinematicElement>> controlled_joints_map_;
     std::map<std::string, std::weak_ptr<KinematicElement>> model_joints_map_;
@@ -34,6 +34,7 @@
 
 #include <exotica_core/planning_problem.h>
 #include <exotica_core/tasks.h>
+#include <exotica_core/tools/thread_pool.h>
 
 namespace exotica
 {
@@ -43,6 +44,8 @@ public:
     AbstractTimeIndexedProblem();
     virtual ~AbstractTimeIndexedProblem();
 
+    void InstantiateBase(const Initializer& init) override;
+
     /// \brief Updates the entire problem from a given trajectory (e.g., used in an optimization solver)
     /// \param x_trajectory_in      Trajectory flattened as a vector; expects dimension: (T - 1) * N
     void Update(Eigen::VectorXdRefConst x_trajectory_in);
@@ -52,6 +55,17 @@ public:
     /// \param t        Timestep to update
     virtual void Update(Eigen::VectorXdRefConst x_in, int t);
 
+    /// \brief Returns the number of threads used by the trajectory Update.
+    int GetNumThreads() const;
+
+    /// \brief Sets the number of threads used by the trajectory Update.
+    /// With more than one thread, the timesteps are split into contiguous blocks which are evaluated concurrently.
+    /// Each additional thread works on its own copy of the problem (scene and task maps) which is synchronised with this problem after PreUpdate.
+    /// The results are identical to the serial update as long as task maps do not depend on the order in which timesteps are updated.
+    /// Task map parameters changed after instantiation are not propagated to the copies.
+    /// \param num_threads  Number of threads (1 for the serial update)
+    void SetNumThreads(const int num_threads);
+
     /// \brief Returns the duration of the trajectory (T * tau).
     double GetDuration() const;
 
@@ -241,6 +255,10 @@ public:
 protected:
     virtual void ReinitializeVariables();
 
+    /// \brief Part of PreUpdate shared with the problems without general constraints.
+    /// Updates the task maps and the cost weights, marks the problem copies of the parallel update for synchronisation and recreates the kinematic solutions.
+    void PreUpdateCost();
+
     /// \brief Checks the desired time index for bounds and supports -1 indexing.
     inline void ValidateTimeIndex(int& t_in) const
     {
@@ -254,6 +272,15 @@ protected:
         }
     }
 
+    /// \brief Updates the scene and the kinematics of timestep t and passes the kinematics of t and t-1 to the task maps.
+    void UpdateKinematics(Eigen::VectorXdRefConst x_in, int t);
+
+    /// \brief Evaluates the used task maps at timestep t into Phi, jacobian and hessian. Expects UpdateKinematics to have been called for t.
+    void UpdateTaskMaps(int t);
+
+    /// \brief Updates the cost, inequality and equality terms of timestep t from Phi, jacobian and hessian.
+    virtual void UpdateTaskTerms(int t);
+
     int T_ = 0;       //!< Number of time steps
     double tau_ = 0;  //!< Time step duration
 
@@ -283,6 +310,20 @@ protected:
     // Terms related with the joint velocity constraint - the Jacobian triplets are constant so can be cached.
     int joint_velocity_constraint_dimension_ = 0;
     std::vector<Eigen::Triplet<double>> joint_velocity_constraint_jacobian_triplets_;
+
+private:
+    /// \brief Updates all timesteps of the trajectory using num_threads_ threads.
+    void UpdateParallel(Eigen::VectorXdRefConst x_trajectory_in);
+
+    /// \brief Creates the problem copies for the parallel update and synchronises them with this problem.
+    void UpdateWorkers();
+
+    bool workers_need_syncing_ = true;  //!< Set by PreUpdate: the problem copies used by the parallel trajectory Update need to be synchronised.
+
+    Initializer initializer_;                                           //!< Initializer of the problem, used to create the copies for the parallel update.
+    int num_threads_ = 1;                                               //!< Number of threads used by the trajectory Update.
+    std::vector<std::shared_ptr<AbstractTimeIndexedProblem>> workers_;  //!< Problem copies used by the parallel trajectory Update (one per additional thread).
+    ThreadPool thread_pool_;                                            //!< Persistent threads evaluating the blocks of the copies.
 };
 }  // namespace exotica
 
@@ -50,11 +50,6 @@ public:
     /// \brief Updates internal variables before solving, e.g., after setting new values for Rho.
     void PreUpdate() override;
 
-    /// \brief Updates an individual timestep from a given state vector
-    /// \param x_in     State
-    /// \param t        Timestep to update
-    void Update(Eigen::VectorXdRefConst x, int t) override;
-
     // Checks bound constraints
     bool IsValid() override;
 
@@ -86,6 +81,9 @@ public:
     Eigen::VectorXd GetJointVelocityLimits() const = delete;
     void SetJointVelocityLimits(const Eigen::VectorXd& qdot_max_in) = delete;
 
+protected:
+    void UpdateTaskTerms(int t) override;
+
 private:
     void ReinitializeVariables() override;
 };
@@ -54,9 +54,10 @@ public:
 
     const double& get_tau() const;  ///< Returns the discretization timestep tau
 
-    const Eigen::MatrixXd& get_X() const;      ///< Returns the state trajectory X
-    Eigen::VectorXd get_X(int t) const;        ///< Returns the state at time t
-    void set_X(Eigen::MatrixXdRefConst X_in);  ///< Sets the state trajectory X (can be used as the initial guess)
+    const Eigen::MatrixXd& get_X() const;             ///< Returns the state trajectory X
+    Eigen::VectorXd get_X(int t) const;               ///< Returns the state at time t
+    void set_X(Eigen::MatrixXdRefConst X_in);         ///< Sets the state trajectory X (can be used as the initial guess)
+    void set_X(Eigen::VectorXdRefConst x_in, int t);  ///< Sets the state at time t, e.g. the start state
 
     const Eigen::MatrixXd& get_U() const;      ///< Returns the control trajectory U
     Eigen::VectorXd get_U(int t) const;        ///< Returns the control state at time t
@@ -78,6 +79,17 @@ public:
 
     void EnableStochasticUpdates();
     void DisableStochasticUpdates();
+    bool get_stochastic_updates_enabled() const;  ///< Returns whether noise is added to the state during Update
+
+    /// \brief Copies the scene state, horizon, trajectories, weights and cost goals of another instance of the same problem.
+    ///     Used to keep independent copies of a problem (e.g. for concurrent rollouts) in sync with the original.
+    /// @param other Problem instantiated from the same initializer.
+    void CopyStateFrom(DynamicTimeIndexedShootingProblem& other);
+
+    /// \brief Copies the trajectories, weights and cost goals of another instance of the same problem with the same horizon.
+    ///     Unlike CopyStateFrom, the scene is not copied and no buffers are reallocated, e.g. to sync copies between receding-horizon solves.
+    /// @param other Problem instantiated from the same initializer with the same T.
+    void CopyTrajectoriesFrom(const DynamicTimeIndexedShootingProblem& other);
 
     // TODO: Make private and add getter (no need to be public!)
     TimeIndexedTask cost;  //!< Cost task
@@ -106,6 +118,13 @@ public:
         return Eigen::MatrixXd::Zero(num_controls_, num_positions_ + num_velocities_);
     };  ///< lxu == lux
 
+    // Same as above, but written into vectors and matrices of the correct size (e.g. the workspace of a solver) without allocating.
+    void GetStateCostJacobian(int t, Eigen::VectorXdRef state_cost_jacobian) const;        ///< lx
+    void GetControlCostJacobian(int t, Eigen::VectorXdRef control_cost_jacobian) const;    ///< lu
+    void GetStateCostHessian(int t, Eigen::MatrixXdRef state_cost_hessian) const;          ///< lxx
+    void GetControlCostHessian(Eigen::MatrixXdRef control_cost_hessian) const;             ///< luu
+    void GetStateControlCostHessian(Eigen::MatrixXdRef state_control_cost_hessian) const;  ///< lxu == lux
+
     Eigen::VectorXd Dynamics(Eigen::VectorXdRefConst x, Eigen::VectorXdRefConst u);
     Eigen::VectorXd Simulate(Eigen::VectorXdRefConst x, Eigen::VectorXdRefConst u);
 
@@ -146,6 +165,13 @@ protected:
     std::normal_distribution<double> standard_normal_noise_{0, 1};
 
     TaskSpaceVector cost_Phi;
+
+private:
+    // Buffers of the cost functions, which are const. A problem must not be evaluated concurrently.
+    mutable Eigen::VectorXd x_diff_;          ///< Difference of the state to the goal state.
+    mutable Eigen::VectorXd state_buffer_;    ///< Products of the state cost with a state vector.
+    mutable Eigen::VectorXd control_buffer_;  ///< Product of the control cost with the control.
+    mutable Eigen::VectorXd task_buffer_;     ///< Product of the task cost weights with the task space error.
 };
 typedef std::shared_ptr<exotica::DynamicTimeIndexedShootingProblem> DynamicTimeIndexedShootingProblemPtr;
 }  // namespace exotica
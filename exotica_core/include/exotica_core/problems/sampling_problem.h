@@ -32,6 +32,7 @@
 
 #include <exotica_core/planning_problem.h>
 #include <exotica_core/tasks.h>
+#include <exotica_core/tools/validity_cache.h>
 
 #include <exotica_core/sampling_problem_initializer.h>
 
@@ -43,9 +44,15 @@ public:
     SamplingProblem();
     virtual ~SamplingProblem();
 
+    void InstantiateBase(const Initializer& init) override;
     virtual void Instantiate(const SamplingProblemInitializer& init);
 
     void Update(Eigen::VectorXdRefConst x);
+
+    /// \brief Checks whether a state is valid, evaluating the checks in increasing order of cost and stopping at the first violated one.
+    /// The joint limits are checked before updating the scene, the used task maps are then evaluated in order of TaskMap::GetRelativeCost.
+    /// For invalid states, only the task maps evaluated up to the violated constraint are updated.
+    /// If the validity cache is enabled and the state has been checked before, the scene and task maps are not updated.
     bool IsValid(Eigen::VectorXdRefConst x);  // Not overriding on purpose - this updates and calls IsValid
     bool IsValid() override;
     void PreUpdate() override;
@@ -67,6 +74,20 @@ public:
 
     void SetGoalState(Eigen::VectorXdRefConst qT);
     const Eigen::VectorXd& GetGoalState() const { return goal_; }
+
+    /// \brief Creates a copy of the problem from its initializer, e.g., to check the validity of states from multiple threads.
+    /// The copy has its own scene and task maps and can be updated concurrently with this problem. It is synchronised with this problem using CopyStateFrom.
+    std::shared_ptr<SamplingProblem> CreateReplica();
+
+    /// \brief Copies the scene, joint limits, start and goal state as well as the goals and weights of the constraints of another problem.
+    /// Both problems have to be created from the same initializer, see CreateReplica. Task map parameters changed after instantiation are not copied.
+    void CopyStateFrom(SamplingProblem& other);
+
+    /// \brief Cache of the validity of previously checked states, enabled with ValidityCacheSize.
+    /// Entries are invalidated when the scene revision changes or constraints are modified.
+    const ValidityCache& GetValidityCache() const { return validity_cache_; }
+    void ClearValidityCache() { validity_cache_.Clear(); }
+
     TaskSpaceVector Phi;
     SamplingTask inequality;
     SamplingTask equality;
@@ -76,8 +97,28 @@ public:
     int num_tasks;
 
 private:
+    /// \brief Constraints of one task map, checked together in IsValid.
+    struct ValidityCheck
+    {
+        int task_map;                 ///< Index into tasks_.
+        std::vector<int> inequality;  ///< Indices into inequality.indexing.
+        std::vector<int> equality;    ///< Indices into equality.indexing.
+    };
+
+    bool IsWithinBounds(Eigen::VectorXdRefConst x) const;
+    /// \brief Updates the scene and evaluates the constraints in order of cost, see IsValid.
+    bool CheckValidity(Eigen::VectorXdRefConst x);
+    /// \brief Evaluates the task map of a check and returns whether its constraints are satisfied. Expects the scene to be updated for x.
+    bool CheckConstraints(Eigen::VectorXdRefConst x, const ValidityCheck& check);
+
+    /// \brief Orders the used task maps by their relative cost.
+    void UpdateValidityChecks();
+
+    std::vector<ValidityCheck> validity_checks_;  ///< Used task maps in increasing order of relative cost.
+    ValidityCache validity_cache_;
     Eigen::VectorXd goal_;
     bool compound_;
+    Initializer initializer_;  ///< Initializer of the problem, used to create replicas.
 };
 
 typedef std::shared_ptr<exotica::SamplingProblem> SamplingProblemPtr;
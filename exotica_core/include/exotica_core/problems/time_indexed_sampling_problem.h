@@ -32,6 +32,7 @@
 
 #include <exotica_core/planning_problem.h>
 #include <exotica_core/tasks.h>
+#include <exotica_core/tools/validity_cache.h>
 
 #include <exotica_core/time_indexed_sampling_problem_initializer.h>
 
@@ -47,6 +48,7 @@ public:
 
     void Update(Eigen::VectorXdRefConst x, const double& t);
     using PlanningProblem::IsValid;
+    /// \brief Checks whether a state is valid at time t. If the validity cache is enabled and the state has been checked before, the scene and task maps are not updated.
     bool IsValid(Eigen::VectorXdRefConst x, const double& t);  // Not overriding on purpose
     void PreUpdate() override;
 
@@ -72,6 +74,11 @@ public:
     double GetGoalTime() const;
     void SetGoalTime(const double& t);
 
+    /// \brief Cache of the validity of previously checked states and times, enabled with ValidityCacheSize.
+    /// Entries are invalidated when the scene revision changes or constraints are modified.
+    const ValidityCache& GetValidityCache() const { return validity_cache_; }
+    void ClearValidityCache() { validity_cache_.Clear(); }
+
     Eigen::VectorXd vel_limits;
     TaskSpaceVector Phi;
     SamplingTask inequality;
@@ -84,6 +91,10 @@ public:
     int num_tasks;
 
 private:
+    /// \brief Updates the scene and task maps and evaluates the constraints.
+    bool CheckValidity(Eigen::VectorXdRefConst x, const double& t);
+
+    ValidityCache validity_cache_;
     double T_;
     double t_goal_;
     Eigen::VectorXd goal_;
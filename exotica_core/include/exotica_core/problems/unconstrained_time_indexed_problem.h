@@ -53,11 +53,6 @@ public:
     /// \brief Updates internal variables before solving, e.g., after setting new values for Rho.
     void PreUpdate() override;
 
-    /// \brief Updates an individual timestep from a given state vector
-    /// \param x_in     State
-    /// \param t        Timestep to update
-    void Update(Eigen::VectorXdRefConst x_in, int t) override;
-
     // As this is an unconstrained problem, it is always valid.
     bool IsValid() override;
 
@@ -92,6 +87,9 @@ public:
     Eigen::VectorXd GetJointVelocityLimits() const = delete;
     void SetJointVelocityLimits(const Eigen::VectorXd& qdot_max_in) = delete;
 
+protected:
+    void UpdateTaskTerms(int t) override;
+
 private:
     void ReinitializeVariables() override;
 };
@@ -75,8 +75,20 @@ public:
     virtual void Instantiate(const SceneInitializer& init);
     void RequestKinematics(KinematicsRequest& request, std::function<void(std::shared_ptr<KinematicResponse>)> callback);
     const std::string& GetName() const;  // Deprecated - use GetObjectName
+
+    /// \brief Creates an independent copy of the scene, including objects, attachments, trajectories and the model state.
+    /// The copy has its own kinematic tree and collision scene and can be updated concurrently with this scene from a different thread.
+    /// Immutable data (the robot model and collision shapes) is shared. Kinematic requests are copied but not their callbacks.
+    std::shared_ptr<Scene> Clone();
+
+    /// \brief Replaces objects, attachments, trajectories, collision settings and the model state of this scene with those of another scene.
+    /// Both scenes have to be instantiated from the same robot model. The kinematic request of this scene is kept if it has a callback.
+    void CopyStateFrom(Scene& other);
     void Update(Eigen::VectorXdRefConst x, double t = 0);
 
+    /// \brief Evaluates the requested kinematic frames (and Jacobians) for a batch of configurations at time t, see KinematicTree::UpdateBatch.
+    void UpdateBatch(Eigen::MatrixXdRefConst X, Eigen::MatrixXd& frames, Eigen::MatrixXd& jacobians, double t = 0);
+
     /// \brief Returns a pointer to the CollisionScene
     const CollisionScenePtr& GetCollisionScene() const;
 
@@ -174,6 +186,10 @@ public:
     const std::map<std::string, std::vector<std::string>>& GetControlledJointToCollisionLinkMap() const { return controlled_joint_to_collision_link_map_; };
     /// @brief Returns world links that are to be excluded from collision checking.
     const std::set<std::string>& get_world_links_to_exclude_from_collision_scene() const { return world_links_to_exclude_from_collision_scene_; }
+    /// @brief Returns a counter which is incremented whenever objects, attachments, trajectories or the model state of the scene change.
+    /// Includes the revision of the collision scene (ACM, link scaling and padding).
+    /// Updating the controlled state via Update does not change the revision. Used to invalidate cached validity checks.
+    unsigned int GetRevision() const { return revision_ + (collision_scene_ ? collision_scene_->GetRevision() : 0); }
 private:
     void UpdateInternalFrames(bool update_request = true);
 
@@ -226,6 +242,9 @@ private:
     std::shared_ptr<KinematicResponse> kinematic_solution_;
     std::function<void(std::shared_ptr<KinematicResponse>)> kinematic_request_callback_;
     bool request_needs_updating_;
+
+    /// \brief Incremented on changes of the scene other than the controlled state, see GetRevision.
+    unsigned int revision_ = 0;
 };
 
 typedef std::shared_ptr<Scene> ScenePtr;
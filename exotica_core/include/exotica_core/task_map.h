@@ -63,6 +63,11 @@ public:
     virtual int TaskSpaceJacobianDim() { return TaskSpaceDim(); }
     virtual void PreUpdate() {}
     virtual std::vector<TaskVectorEntry> GetLieGroupIndices() { return std::vector<TaskVectorEntry>(); }
+
+    /// \brief Cost of evaluating the task map relative to an analytic function of the kinematics (1.0).
+    /// Used to evaluate cheap task maps first, e.g., when checking the validity of sampled states. Task maps querying the collision scene should return a higher value.
+    virtual double GetRelativeCost() const { return 1.0; }
+
     std::vector<KinematicFrameRequest> GetFrames() const;
 
     std::vector<KinematicSolution> kinematics = std::vector<KinematicSolution>(1);
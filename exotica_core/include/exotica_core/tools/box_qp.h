@@ -43,26 +43,61 @@ typedef struct BoxQPSolution
     std::vector<size_t> clamped_idx;
 } BoxQPSolution;
 
-inline BoxQPSolution BoxQP(const Eigen::MatrixXd& H, const Eigen::VectorXd& q,
-                           const Eigen::VectorXd& b_low, const Eigen::VectorXd& b_high,
-                           const Eigen::VectorXd& x_init, const double gamma,
-                           const int max_iterations, const double epsilon, const double lambda)
+/// Intermediate results of BoxQP. Reusing a workspace (and solution) avoids
+/// heap allocations as long as the number of free dimensions does not change.
+typedef struct BoxQPWorkspace
+{
+    Eigen::VectorXd x, x_new, grad, Hx;
+    Eigen::VectorXd q_free, x_free, x_clamped, delta_xf;
+    Eigen::MatrixXd Hff, Hfc;
+    Eigen::PartialPivLU<Eigen::MatrixXd> Hff_lu;
+} BoxQPWorkspace;
+
+/// Computes Hff_inv = (Hff + lambda * I)^-1 without temporaries: solves L * U * Hff_inv = P.
+inline void InvertRegularized(const Eigen::Ref<const Eigen::MatrixXd>& Hff, const double lambda, Eigen::PartialPivLU<Eigen::MatrixXd>& Hff_lu, Eigen::MatrixXd& Hff_inv)
+{
+    Hff_lu.compute(Hff + lambda * Eigen::MatrixXd::Identity(Hff.rows(), Hff.cols()));
+    Hff_inv.setZero(Hff.rows(), Hff.cols());
+    for (Eigen::Index i = 0; i < Hff_inv.rows(); ++i) Hff_inv(Hff_lu.permutationP().indices()(i), i) = 1.0;
+    Hff_lu.matrixLU().template triangularView<Eigen::UnitLower>().solveInPlace(Hff_inv);
+    Hff_lu.matrixLU().template triangularView<Eigen::Upper>().solveInPlace(Hff_inv);
+}
+
+/// Same as the BoxQP below, but writes the result into solution and keeps the intermediate results in workspace.
+/// The arguments may be compile-time-sized.
+inline void BoxQP(const Eigen::Ref<const Eigen::MatrixXd>& H, const Eigen::Ref<const Eigen::VectorXd>& q,
+                  const Eigen::Ref<const Eigen::VectorXd>& b_low, const Eigen::Ref<const Eigen::VectorXd>& b_high,
+                  const Eigen::Ref<const Eigen::VectorXd>& x_init, const double gamma,
+                  const int max_iterations, const double epsilon, const double lambda,
+                  BoxQPWorkspace& workspace, BoxQPSolution& solution)
 {
     int it = 0;
-    Eigen::VectorXd delta_xf, x = x_init;
-    std::vector<size_t> clamped_idx, free_idx;
-    Eigen::VectorXd grad = q + H * x_init;
-    Eigen::MatrixXd Hff, Hfc, Hff_inv;
+    Eigen::VectorXd& x = workspace.x;
+    Eigen::VectorXd& grad = workspace.grad;
+    std::vector<size_t>& clamped_idx = solution.clamped_idx;
+    std::vector<size_t>& free_idx = solution.free_idx;
+    clamped_idx.clear();
+    free_idx.clear();
+    clamped_idx.reserve(x_init.size());
+    free_idx.reserve(x_init.size());
+
+    x = x_init;
+    grad = q;
+    grad.noalias() += H * x_init;
 
-    Hff_inv = (Eigen::MatrixXd::Identity(H.rows(), H.cols()) * 1e-5 + H).inverse();
+    InvertRegularized(H, 1e-5, workspace.Hff_lu, solution.Hff_inv);
 
     if (grad.norm() <= epsilon)
-        return {Hff_inv, x_init, free_idx, clamped_idx};
+    {
+        solution.x = x_init;
+        return;
+    }
 
     while (grad.norm() > epsilon && it < max_iterations)
     {
         ++it;
-        grad = q + H * x;
+        grad = q;
+        grad.noalias() += H * x;
         clamped_idx.clear();
         free_idx.clear();
 
@@ -75,8 +110,13 @@ inline BoxQPSolution BoxQP(const Eigen::MatrixXd& H, const Eigen::VectorXd& q,
         }
 
         if (free_idx.size() == 0)
-            return {Hff_inv, x, free_idx, clamped_idx};
+        {
+            solution.x = x;
+            return;
+        }
 
+        Eigen::MatrixXd& Hff = workspace.Hff;
+        Eigen::MatrixXd& Hfc = workspace.Hfc;
         Hff.resize(free_idx.size(), free_idx.size());
         Hfc.resize(free_idx.size(), clamped_idx.size());
 
@@ -94,7 +134,12 @@ inline BoxQPSolution BoxQP(const Eigen::MatrixXd& H, const Eigen::VectorXd& q,
         }
 
         // NOTE: Array indexing not supported in current eigen version
-        Eigen::VectorXd q_free(free_idx.size()), x_free(free_idx.size()), x_clamped(clamped_idx.size());
+        Eigen::VectorXd& q_free = workspace.q_free;
+        Eigen::VectorXd& x_free = workspace.x_free;
+        Eigen::VectorXd& x_clamped = workspace.x_clamped;
+        q_free.resize(free_idx.size());
+        x_free.resize(free_idx.size());
+        x_clamped.resize(clamped_idx.size());
         for (size_t i = 0; i < free_idx.size(); ++i)
         {
             q_free(i) = q(free_idx[i]);
@@ -104,33 +149,33 @@ inline BoxQPSolution BoxQP(const Eigen::MatrixXd& H, const Eigen::VectorXd& q,
         for (size_t j = 0; j < clamped_idx.size(); ++j)
             x_clamped(j) = x(clamped_idx[j]);
 
-        Hff_inv = (Eigen::MatrixXd::Identity(Hff.rows(), Hff.cols()) * lambda + Hff).inverse();
+        InvertRegularized(Hff, lambda, workspace.Hff_lu, solution.Hff_inv);
 
-        if (clamped_idx.size() == 0)
-            delta_xf = -Hff_inv * (q_free)-x_free;
-        else
-            delta_xf = -Hff_inv * (q_free + Hfc * x_clamped) - x_free;
+        // delta_xf = -Hff_inv * (q_free + Hfc * x_clamped) - x_free
+        if (clamped_idx.size() != 0) q_free.noalias() += Hfc * x_clamped;
+        workspace.delta_xf.noalias() = -solution.Hff_inv * q_free;
+        workspace.delta_xf -= x_free;
 
-        double f_old = (0.5 * x.transpose() * H * x + q.transpose() * x)(0);
-        const Eigen::VectorXd alpha_space = Eigen::VectorXd::LinSpaced(10, 1.0, 0.1);
+        workspace.Hx.noalias() = H * x;
+        double f_old = 0.5 * x.dot(workspace.Hx) + q.dot(x);
 
         bool armijo_reached = false;
-        Eigen::VectorXd x_new;
-        for (int ai = 0; ai < alpha_space.rows(); ++ai)
+        Eigen::VectorXd& x_new = workspace.x_new;
+        for (int ai = 0; ai < 10; ++ai)
         {
-            const double& alpha = alpha_space[ai];
+            const double alpha = 1.0 - 0.1 * ai;  // 1.0, 0.9, ..., 0.1
 
             x_new = x;
             for (size_t i = 0; i < free_idx.size(); ++i)
                 x_new(free_idx[i]) = std::max(std::min(
-                                                  x(free_idx[i]) + alpha * delta_xf(i), b_high(i)),
-                                              b_low(i));
+                                                  x(free_idx[i]) + alpha * workspace.delta_xf(i), b_high(free_idx[i])),
+                                              b_low(free_idx[i]));
 
-            double f_new = (0.5 * x_new.transpose() * H * x_new + q.transpose() * x_new)(0);
-            Eigen::VectorXd x_diff = x - x_new;
+            workspace.Hx.noalias() = H * x_new;
+            double f_new = 0.5 * x_new.dot(workspace.Hx) + q.dot(x_new);
 
             // armijo criterion>
-            double armijo_coef = (f_old - f_new) / (grad.transpose() * x_diff + 1e-5);
+            double armijo_coef = (f_old - f_new) / (grad.dot(x - x_new) + 1e-5);
             if (armijo_coef > gamma)
             {
                 armijo_reached = true;
@@ -143,7 +188,18 @@ inline BoxQPSolution BoxQP(const Eigen::MatrixXd& H, const Eigen::VectorXd& q,
         if (!armijo_reached) break;
     }
 
-    return {Hff_inv, x, free_idx, clamped_idx};
+    solution.x = x;
+}
+
+inline BoxQPSolution BoxQP(const Eigen::MatrixXd& H, const Eigen::VectorXd& q,
+                           const Eigen::VectorXd& b_low, const Eigen::VectorXd& b_high,
+                           const Eigen::VectorXd& x_init, const double gamma,
+                           const int max_iterations, const double epsilon, const double lambda)
+{
+    BoxQPWorkspace workspace;
+    BoxQPSolution solution;
+    BoxQP(H, q, b_low, b_high, x_init, gamma, max_iterations, epsilon, lambda, workspace, solution);
+    return solution;
 }
 
 inline BoxQPSolution BoxQP(const Eigen::MatrixXd& H, const Eigen::VectorXd& q,
@@ -0,0 +1,161 @@
+//
+// Copyright (c) 2019, University of Edinburgh
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef EXOTICA_CORE_THREAD_POOL_H_
+#define EXOTICA_CORE_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <exotica_core/tools/uncopyable.h>
+
+namespace exotica
+{
+/// \brief Persistent worker threads for work which is split across a fixed number of threads many times,
+/// e.g., the rollouts of every solver iteration. Creating the threads once avoids spawning and joining
+/// them on every call.
+class ThreadPool : Uncopyable
+{
+public:
+    ThreadPool() = default;
+    ~ThreadPool() { Stop(); }
+
+    /// \brief Starts num_workers worker threads. Does nothing if that many are running already. Must not be called during Run.
+    void Resize(int num_workers)
+    {
+        if (num_workers == static_cast<int>(threads_.size())) return;
+        Stop();
+        stop_ = false;
+        exceptions_.assign(num_workers, nullptr);
+        threads_.reserve(num_workers);
+        for (int i = 0; i < num_workers; ++i) threads_.emplace_back(&ThreadPool::Work, this, i + 1, generation_);
+    }
+
+    int GetNumWorkers() const { return static_cast<int>(threads_.size()); }
+
+    /// \brief Calls task(0) on the calling thread and task(1), ..., task(GetNumWorkers()) on the workers and returns once all have finished.
+    /// If tasks throw, the exception of the lowest thread index is rethrown.
+    void Run(const std::function<void(int)>& task)
+    {
+        if (threads_.empty())
+        {
+            task(0);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = &task;
+            pending_ = static_cast<int>(threads_.size());
+            ++generation_;
+        }
+        start_.notify_all();
+
+        std::exception_ptr exception;
+        try
+        {
+            task(0);
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            finished_.wait(lock, [this]() { return pending_ == 0; });
+            task_ = nullptr;
+        }
+
+        for (std::exception_ptr& worker_exception : exceptions_)
+        {
+            if (!exception) exception = worker_exception;
+            worker_exception = nullptr;
+        }
+        if (exception) std::rethrow_exception(exception);
+    }
+
+private:
+    void Work(int thread, unsigned int generation)
+    {
+        while (true)
+        {
+            const std::function<void(int)>* task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_.wait(lock, [&]() { return stop_ || generation_ != generation; });
+                if (stop_) return;
+                generation = generation_;
+                task = task_;
+            }
+
+            try
+            {
+                (*task)(thread);
+            }
+            catch (...)
+            {
+                exceptions_[thread - 1] = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--pending_ == 0) finished_.notify_one();
+            }
+        }
+    }
+
+    void Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        start_.notify_all();
+        for (std::thread& thread : threads_) thread.join();
+        threads_.clear();
+    }
+
+    std::vector<std::thread> threads_;
+    std::vector<std::exception_ptr> exceptions_;  ///< Exception thrown by the task on each worker during the current Run.
+    std::mutex mutex_;
+    std::condition_variable start_;     ///< Signals a new task or stop_ to the workers.
+    std::condition_variable finished_;  ///< Signals the last worker finishing its task.
+    const std::function<void(int)>* task_ = nullptr;
+    unsigned int generation_ = 0;  ///< Incremented for every task, so that workers run each task once.
+    int pending_ = 0;              ///< Number of workers which have not finished the current task.
+    bool stop_ = false;
+};
+}
+
+#endif  // EXOTICA_CORE_THREAD_POOL_H_
@@ -0,0 +1,158 @@
+//
+// Copyright (c) 2019, University of Edinburgh
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef EXOTICA_CORE_VALIDITY_CACHE_H_
+#define EXOTICA_CORE_VALIDITY_CACHE_H_
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <exotica_core/tools/conversions.h>
+
+namespace exotica
+{
+/// \brief Bounded least-recently-used cache of state validity.
+/// States are hashed on their joint values (and optionally time) quantised to a grid of the given resolution, i.e.,
+/// states falling into the same grid cell share a cache entry. A resolution of zero only reuses identical states.
+/// Entries are tagged with a scene revision: changing the revision invalidates all entries.
+class ValidityCache
+{
+public:
+    typedef std::vector<int64_t> Key;
+
+    /// \brief Enables the cache. A capacity of zero disables it.
+    void Configure(double resolution, std::size_t capacity)
+    {
+        if (resolution < 0.0) throw std::invalid_argument("ValidityCache: resolution must not be negative");
+        resolution_ = resolution;
+        capacity_ = capacity;
+        Clear();
+        ResetStatistics();
+    }
+
+    bool IsEnabled() const { return capacity_ > 0; }
+
+    /// \brief Clears all entries if the revision differs from the revision of the cached entries.
+    void SetRevision(unsigned int revision)
+    {
+        if (revision == revision_) return;
+        Clear();
+        revision_ = revision;
+    }
+
+    Key GetKey(Eigen::VectorXdRefConst x, double t = 0.0) const
+    {
+        Key key(x.size() + 1);
+        for (int i = 0; i < x.size(); ++i) key[i] = Quantise(x(i));
+        key[x.size()] = Quantise(t);
+        return key;
+    }
+
+    /// \brief Returns whether the key is cached and if so, sets valid to the cached validity.
+    bool Lookup(const Key& key, bool& valid)
+    {
+        const auto it = map_.find(key);
+        if (it == map_.end())
+        {
+            ++misses_;
+            return false;
+        }
+        // Move to the front of the least-recently-used list
+        entries_.splice(entries_.begin(), entries_, it->second);
+        valid = it->second->second;
+        ++hits_;
+        return true;
+    }
+
+    void Insert(const Key& key, bool valid)
+    {
+        if (!IsEnabled()) return;
+        if (map_.size() >= capacity_)
+        {
+            map_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+        entries_.emplace_front(key, valid);
+        map_[key] = entries_.begin();
+    }
+
+    void Clear()
+    {
+        map_.clear();
+        entries_.clear();
+    }
+
+    void ResetStatistics()
+    {
+        hits_ = 0;
+        misses_ = 0;
+    }
+
+    std::size_t GetSize() const { return map_.size(); }
+    std::size_t GetCapacity() const { return capacity_; }
+    double GetResolution() const { return resolution_; }
+    std::size_t GetNumberOfHits() const { return hits_; }
+    std::size_t GetNumberOfMisses() const { return misses_; }
+    double GetHitRate() const { return hits_ + misses_ > 0 ? static_cast<double>(hits_) / static_cast<double>(hits_ + misses_) : 0.0; }
+private:
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const
+        {
+            std::size_t hash = key.size();
+            for (const int64_t k : key) hash ^= std::hash<int64_t>()(k) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+            return hash;
+        }
+    };
+
+    int64_t Quantise(double value) const
+    {
+        if (resolution_ > 0.0) return static_cast<int64_t>(std::floor(value / resolution_));
+        int64_t bits;
+        std::memcpy(&bits, &value, sizeof(double));
+        return bits;
+    }
+
+    double resolution_ = 0.0;
+    std::size_t capacity_ = 0;
+    unsigned int revision_ = 0;
+    std::size_t hits_ = 0;
+    std::size_t misses_ = 0;
+    std::list<std::pair<Key, bool>> entries_;  ///< Most recently used first
+    std::unordered_map<Key, std::list<std::pair<Key, bool>>::iterator, KeyHash> map_;
+};
+}
+
+#endif  // EXOTICA_CORE_VALIDITY_CACHE_H_
@@ -173,7 +173,7 @@ void AbstractDynamicsSolver<T, NX, NU>::SetIntegrator(std::string integrator_in)
 }
 
 template <typename T, int NX, int NU>
-Eigen::MatrixXd AbstractDynamicsSolver<T, NX, NU>::get_control_limits()
+const Eigen::MatrixXd& AbstractDynamicsSolver<T, NX, NU>::get_control_limits()
 {
     if (!control_limits_initialized_)
         set_control_limits(raw_control_limits_low_, raw_control_limits_high_);
@@ -246,6 +246,145 @@ Eigen::Tensor<T, 3> AbstractDynamicsSolver<T, NX, NU>::fxu(const StateVector& x,
     return fxu_default_;
 }
 
+template <typename T, int NX, int NU>
+void AbstractDynamicsSolver<T, NX, NU>::ContractedSecondOrderDerivatives(const StateVector& x, const ControlVector& u, const StateVector& v, StateDerivative& v_fxx, ControlHessian& v_fuu, ControlStateHessian& v_fxu)
+{
+    // Finite differences of the gradients of v^T f. The step is larger than the one of fx and fu
+    // as these may be finite differences themselves.
+    constexpr double eps = 1e-4;
+    const int NX_ = num_positions_ + num_velocities_;
+    const int NU_ = num_controls_;
+
+    v_fxx.resize(NX_, NX_);
+    v_fuu.resize(NU_, NU_);
+    v_fxu.resize(NU_, NX_);
+
+    // The buffers keep their size between calls, so only the first call allocates.
+    fd_x_.resize(NX_);
+    fd_u_.resize(NU_);
+    fd_xdot_.resize(NX_);
+    fd_fx_low_.resize(NX_, NX_);
+    fd_fx_high_.resize(NX_, NX_);
+    fd_fu_low_.resize(NX_, NU_);
+    fd_fu_high_.resize(NX_, NU_);
+
+    fd_x_ = x;
+    for (int k = 0; k < NX_; ++k)
+    {
+        fd_x_(k) = x(k) - eps / 2.0;
+        ComputeDerivativesInternal(fd_x_, u, fd_xdot_, fd_fx_low_, fd_fu_low_);
+        fd_x_(k) = x(k) + eps / 2.0;
+        ComputeDerivativesInternal(fd_x_, u, fd_xdot_, fd_fx_high_, fd_fu_high_);
+        fd_x_(k) = x(k);
+
+        fd_fx_high_ -= fd_fx_low_;
+        v_fxx.col(k).noalias() = fd_fx_high_.transpose() * v;
+        v_fxx.col(k) /= eps;
+    }
+
+    fd_u_ = u;
+    for (int a = 0; a < NU_; ++a)
+    {
+        fd_u_(a) = u(a) - eps / 2.0;
+        ComputeDerivativesInternal(x, fd_u_, fd_xdot_, fd_fx_low_, fd_fu_low_);
+        fd_u_(a) = u(a) + eps / 2.0;
+        ComputeDerivativesInternal(x, fd_u_, fd_xdot_, fd_fx_high_, fd_fu_high_);
+        fd_u_(a) = u(a);
+
+        fd_fu_high_ -= fd_fu_low_;
+        fd_fx_high_ -= fd_fx_low_;
+        v_fuu.col(a).noalias() = fd_fu_high_.transpose() * v;
+        v_fuu.col(a) /= eps;
+        v_fxu.row(a).noalias() = v.transpose() * fd_fx_high_;
+        v_fxu.row(a) /= eps;
+    }
+
+    // The Hessians of v^T f are symmetric, average out the asymmetric finite-difference error in place.
+    for (int j = 0; j < NX_; ++j)
+        for (int i = 0; i < j; ++i) v_fxx(i, j) = v_fxx(j, i) = 0.5 * (v_fxx(i, j) + v_fxx(j, i));
+    for (int b = 0; b < NU_; ++b)
+        for (int a = 0; a < b; ++a) v_fuu(a, b) = v_fuu(b, a) = 0.5 * (v_fuu(a, b) + v_fuu(b, a));
+}
+
+template <typename T, int NX, int NU>
+void AbstractDynamicsSolver<T, NX, NU>::ComputeDerivatives(const StateVector& x, const ControlVector& u, bool second_order)
+{
+    const bool same_input = derivative_cache_valid_ && cached_x_.size() == x.size() && cached_u_.size() == u.size() && cached_x_ == x && cached_u_ == u;
+    if (!same_input)
+    {
+        second_order_derivative_cache_valid_ = false;
+        cached_x_ = x;
+        cached_u_ = u;
+        ComputeDerivativesInternal(x, u, cached_xdot_, cached_fx_, cached_fu_);
+        derivative_cache_valid_ = true;
+    }
+
+    if (second_order && !second_order_derivative_cache_valid_)
+    {
+        cached_fxx_ = fxx(x, u);
+        cached_fuu_ = fuu(x, u);
+        cached_fxu_ = fxu(x, u);
+        second_order_derivative_cache_valid_ = true;
+    }
+}
+
+template <typename T, int NX, int NU>
+void AbstractDynamicsSolver<T, NX, NU>::ComputeDerivativesInternal(const StateVector& x, const ControlVector& u, StateVector& xdot, StateDerivative& fx_out, ControlDerivative& fu_out)
+{
+    xdot = f(x, u);
+    fx_out = fx(x, u);
+    fu_out = fu(x, u);
+}
+
+template <typename T, int NX, int NU>
+const Eigen::Matrix<T, NX, 1>& AbstractDynamicsSolver<T, NX, NU>::get_state_derivative() const
+{
+    if (!derivative_cache_valid_) ThrowPretty("No derivatives have been computed yet. Call ComputeDerivatives first.");
+    return cached_xdot_;
+}
+
+template <typename T, int NX, int NU>
+const Eigen::Matrix<T, NX, NX>& AbstractDynamicsSolver<T, NX, NU>::get_fx() const
+{
+    if (!derivative_cache_valid_) ThrowPretty("No derivatives have been computed yet. Call ComputeDerivatives first.");
+    return cached_fx_;
+}
+
+template <typename T, int NX, int NU>
+const Eigen::Matrix<T, NX, NU>& AbstractDynamicsSolver<T, NX, NU>::get_fu() const
+{
+    if (!derivative_cache_valid_) ThrowPretty("No derivatives have been computed yet. Call ComputeDerivatives first.");
+    return cached_fu_;
+}
+
+template <typename T, int NX, int NU>
+const Eigen::Tensor<T, 3>& AbstractDynamicsSolver<T, NX, NU>::get_fxx() const
+{
+    if (!second_order_derivative_cache_valid_) ThrowPretty("No second-order derivatives have been computed yet. Call ComputeDerivatives with second_order set first.");
+    return cached_fxx_;
+}
+
+template <typename T, int NX, int NU>
+const Eigen::Tensor<T, 3>& AbstractDynamicsSolver<T, NX, NU>::get_fuu() const
+{
+    if (!second_order_derivative_cache_valid_) ThrowPretty("No second-order derivatives have been computed yet. Call ComputeDerivatives with second_order set first.");
+    return cached_fuu_;
+}
+
+template <typename T, int NX, int NU>
+const Eigen::Tensor<T, 3>& AbstractDynamicsSolver<T, NX, NU>::get_fxu() const
+{
+    if (!second_order_derivative_cache_valid_) ThrowPretty("No second-order derivatives have been computed yet. Call ComputeDerivatives with second_order set first.");
+    return cached_fxu_;
+}
+
+template <typename T, int NX, int NU>
+void AbstractDynamicsSolver<T, NX, NU>::ClearDerivativeCache()
+{
+    derivative_cache_valid_ = false;
+    second_order_derivative_cache_valid_ = false;
+}
+
 template <typename T, int NX, int NU>
 Eigen::Matrix<T, NU, 1> AbstractDynamicsSolver<T, NX, NU>::InverseDynamics(const StateVector& state)
 {
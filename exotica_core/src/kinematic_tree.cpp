@@ -29,8 +29,9 @@
 
 #include <algorithm>
 #include <iostream>
-#include <queue>
+#include <limits>
 #include <set>
+#include <stack>
 
 #include <eigen_conversions/eigen_kdl.h>
 #include <geometric_shapes/mesh_operations.h>
@@ -61,6 +62,78 @@ KinematicResponse::KinematicResponse(KinematicRequestFlags _flags, int _size, in
     x.setZero(_n);
 }
 
+void FlatKinematicTree::Clear()
+{
+    element.clear();
+    parent.clear();
+    type.clear();
+    axis.clear();
+    origin.clear();
+    offset.clear();
+    state_index.clear();
+    control_id.clear();
+    frame.clear();
+    subtree_end.clear();
+    state.clear();
+    is_trajectory_generated.clear();
+    index.clear();
+    ++revision;
+}
+
+void FlatKinematicTree::Add(std::shared_ptr<KinematicElement> new_element, int parent_index)
+{
+    const KDL::Joint& joint = new_element->segment.getJoint();
+    JointType joint_type;
+    switch (joint.getType())
+    {
+        case KDL::Joint::RotAxis:
+        case KDL::Joint::RotX:
+        case KDL::Joint::RotY:
+        case KDL::Joint::RotZ:
+            joint_type = JOINT_REVOLUTE;
+            break;
+        case KDL::Joint::TransAxis:
+        case KDL::Joint::TransX:
+        case KDL::Joint::TransY:
+        case KDL::Joint::TransZ:
+            joint_type = JOINT_PRISMATIC;
+            break;
+        default:
+            joint_type = JOINT_FIXED;
+            break;
+    }
+
+    // KDL::Segment::pose(q) evaluates to joint.pose(q) * f_tip, where f_tip is the tip frame relative to
+    // the joint frame at q = 0. We recover f_tip here so the forward pass does not need the KDL::Segment.
+    // NB: This assumes the unit joint scale and zero joint offset used by kdl_parser and BuildTree.
+    element.push_back(new_element);
+    parent.push_back(parent_index);
+    type.push_back(joint_type);
+    axis.push_back(joint.JointAxis());
+    origin.push_back(joint_type == JOINT_FIXED ? KDL::Vector::Zero() : joint.JointOrigin());
+    offset.push_back(joint.pose(0.0).Inverse() * new_element->segment.getFrameToTip());
+    state_index.push_back(joint_type == JOINT_FIXED ? -1 : new_element->id);
+    control_id.push_back(new_element->is_controlled ? new_element->control_id : -1);
+    frame.push_back(KDL::Frame::Identity());
+    state.push_back(std::numeric_limits<double>::quiet_NaN());
+    is_trajectory_generated.push_back(false);
+    index[new_element.get()] = Size() - 1;
+}
+
+void FlatKinematicTree::ComputeSubtrees()
+{
+    // In depth-first order every subtree is contiguous and ends where the subtree of its last child ends.
+    subtree_end.resize(Size());
+    for (int i = 0; i < Size(); ++i) subtree_end[i] = i + 1;
+    for (int i = Size() - 1; i > 0; --i) subtree_end[parent[i]] = std::max(subtree_end[parent[i]], subtree_end[i]);
+}
+
+int FlatKinematicTree::IndexOf(const std::shared_ptr<KinematicElement>& element) const
+{
+    auto it = index.find(element.get());
+    return it == index.end() ? -1 : it->second;
+}
+
 KinematicsRequest::KinematicsRequest() = default;
 
 KinematicFrameRequest::KinematicFrameRequest() = default;
@@ -393,6 +466,7 @@ void KinematicTree::UpdateModel()
         tree_map_[joint.lock()->segment.getName()] = joint.lock();
     }
     debug_tree_.resize(tree_.size() - 1);
+    flat_tree_needs_compiling_ = true;
     UpdateTree();
     debug_scene_changed_ = true;
 }
@@ -460,6 +534,7 @@ void KinematicTree::ChangeParent(const std::string& name, const std::string& par
     child->parent_name = parent->segment.getName();
     parent->children.push_back(child);
     child->UpdateClosestRobotLink();
+    flat_tree_needs_compiling_ = true;
     debug_scene_changed_ = true;
 }
 
@@ -537,6 +612,7 @@ std::shared_ptr<KinematicElement> KinematicTree::AddElement(const std::string& n
     new_element->UpdateClosestRobotLink();
     tree_map_[name] = new_element;
     new_element->visual = visual;
+    flat_tree_needs_compiling_ = true;
     debug_scene_changed_ = true;
     return new_element;
 }
@@ -635,6 +711,12 @@ std::shared_ptr<KinematicResponse> KinematicTree::RequestFrames(const Kinematics
         }
     }
 
+    // Precompute the Jacobian chains, otherwise they are computed once the tree has been compiled.
+    if (!flat_tree_needs_compiling_)
+    {
+        for (KinematicFrame& frame : solution_->frame) UpdateFrameIndices(frame);
+    }
+
     debug_frames_.resize(solution_->frame.size() * 2);
 
     return solution_;
@@ -657,40 +739,102 @@ void KinematicTree::Update(Eigen::VectorXdRefConst x)
     if (debug) PublishFrames();
 }
 
-void KinematicTree::UpdateTree()
+void KinematicTree::UpdateBatch(Eigen::MatrixXdRefConst X, Eigen::MatrixXd& frames, Eigen::MatrixXd& jacobians)
+{
+    if (X.cols() != state_size_) ThrowPretty("Wrong state vector size! Got " << X.cols() << " expected " << state_size_);
+
+    const int num_configurations = X.rows();
+    const int num_frames = solution_->frame.size();
+    const int jacobian_size = 6 * num_controlled_joints_;
+    frames.resize(num_configurations, 7 * num_frames);
+    jacobians.resize(num_configurations, (flags_ & KIN_J) ? jacobian_size * num_frames : 0);
+
+    const Eigen::VectorXd x_current = solution_->x;
+    for (int n = 0; n < num_configurations; ++n)
+    {
+        Update(X.row(n).transpose());
+        for (int i = 0; i < num_frames; ++i)
+        {
+            const KDL::Frame& frame = solution_->Phi(i);
+            for (int j = 0; j < 3; ++j) frames(n, 7 * i + j) = frame.p[j];
+            frame.M.GetQuaternion(frames(n, 7 * i + 3), frames(n, 7 * i + 4), frames(n, 7 * i + 5), frames(n, 7 * i + 6));
+            if (flags_ & KIN_J) jacobians.row(n).segment(jacobian_size * i, jacobian_size) = Eigen::Map<const Eigen::RowVectorXd>(solution_->jacobian(i).data.data(), jacobian_size);
+        }
+    }
+    Update(x_current);
+}
+
+void KinematicTree::CompileTree()
 {
-    std::queue<std::shared_ptr<KinematicElement>> elements;
-    elements.push(root_);
-    root_->RemoveExpiredChildren();
+    // Release the previously compiled elements first so that elements which
+    // have been removed from the scene expire before we traverse the tree.
+    flat_tree_.Clear();
+
+    // Depth-first traversal, see FlatKinematicTree::subtree_end.
+    std::stack<std::pair<std::shared_ptr<KinematicElement>, int>> elements;
+    elements.push({root_, -1});
     while (elements.size() > 0)
     {
-        auto element = elements.front();
+        std::shared_ptr<KinematicElement> element = elements.top().first;
+        flat_tree_.Add(element, elements.top().second);
         elements.pop();
-        // Elements with id > -1 have parent links.
-        // ID=-1 is the global world reference frame.
-        if (element->id > -1)
+
+        const int index = flat_tree_.Size() - 1;
+        element->RemoveExpiredChildren();
+        for (auto child = element->children.rbegin(); child != element->children.rend(); ++child)
         {
-            if (element->segment.getJoint().getType() != KDL::Joint::JointType::None)
-            {
-                element->frame = element->parent.lock()->frame * element->GetPose(tree_state_(element->id));
-            }
-            else
-            {
-                element->frame = element->parent.lock()->frame * element->GetPose();
-            }
+            std::shared_ptr<KinematicElement> child_element = child->lock();
+            if (child_element) elements.push({child_element, index});
         }
-        // Root of tree.
-        else
+    }
+    flat_tree_.ComputeSubtrees();
+
+    flat_tree_needs_compiling_ = false;
+}
+
+void KinematicTree::UpdateTree()
+{
+    const bool update_all = flat_tree_needs_compiling_;
+    if (flat_tree_needs_compiling_) CompileTree();
+
+    const int size = flat_tree_.Size();
+    if (update_all) updated_subtrees_.assign(1, 0);
+
+    // Elements before subtree_end belong to a subtree which is being recomputed.
+    int subtree_end = update_all ? size : 0;
+    for (int i = 0; i < size; ++i)
+    {
+        KinematicElement& element = *flat_tree_.element[i];
+        const int state_index = flat_tree_.state_index[i];
+        const double q = state_index > -1 ? tree_state_(state_index) : 0.0;
+
+        if (i >= subtree_end)
         {
-            // NB: We could simply set KDL::Frame() here, however, to support
-            // trajectories for the base joint, we return GetPose();
-            element->frame = element->GetPose();
+            // The subtree only moves if the joint value changed or if the element is (or was) trajectory generated.
+            if (!element.is_trajectory_generated && !flat_tree_.is_trajectory_generated[i] && q == flat_tree_.state[i]) continue;
+            subtree_end = flat_tree_.subtree_end[i];
+            updated_subtrees_.push_back(i);
         }
-        element->RemoveExpiredChildren();
-        for (std::weak_ptr<KinematicElement> child : element->children)
+
+        flat_tree_.state[i] = q;
+        flat_tree_.is_trajectory_generated[i] = element.is_trajectory_generated;
+
+        // NB: Trajectory generated elements (including the root) replace their segment pose.
+        KDL::Frame& frame = flat_tree_.frame[i];
+        const int parent = flat_tree_.parent[i];
+        if (element.is_trajectory_generated)
         {
-            elements.push(child.lock());
+            frame = element.generated_offset;
         }
+        else
+        {
+            frame = flat_tree_.Pose(i, q);
+        }
+
+        // The root of the tree (parent = -1) is the global world reference frame.
+        if (parent > -1) frame = flat_tree_.frame[parent] * frame;
+        element.frame = frame;
+        ++recomputed_segment_count_;
     }
 }
 
@@ -796,14 +940,62 @@ KDL::Frame KinematicTree::FK(const std::string& element_A, const KDL::Frame& off
     return FK(A->second.lock(), offset_a, B->second.lock(), offset_b);
 }
 
+void KinematicTree::UpdateFrameIndices(KinematicFrame& frame) const
+{
+    frame.index_A = flat_tree_.IndexOf(frame.frame_A.lock());
+    frame.index_B = flat_tree_.IndexOf(frame.frame_B.lock());
+    frame.flat_tree_revision = flat_tree_.revision;
+    frame.jacobian_chain_A.clear();
+    frame.jacobian_chain_B.clear();
+    if (frame.index_A < 0 || frame.index_B < 0) return;
+
+    // Joints above the common ancestor move frame A and frame B alike and cancel out of the Jacobian.
+    // Parents precede their children in the flat tree, so we step up from whichever index is larger.
+    int a = frame.index_A;
+    int b = frame.index_B;
+    while (a != b)
+    {
+        if (a > b)
+        {
+            if (flat_tree_.control_id[a] > -1) frame.jacobian_chain_A.push_back(a);
+            a = flat_tree_.parent[a];
+        }
+        else
+        {
+            if (flat_tree_.control_id[b] > -1) frame.jacobian_chain_B.push_back(b);
+            b = flat_tree_.parent[b];
+        }
+    }
+}
+
+bool KinematicTree::FrameNeedsUpdate(KinematicFrame& frame) const
+{
+    if (frame.flat_tree_revision != flat_tree_.revision) UpdateFrameIndices(frame);
+    if (frame.index_A < 0 || frame.index_B < 0) return true;
+
+    for (const int& root : updated_subtrees_)
+    {
+        const int end = flat_tree_.subtree_end[root];
+        if ((frame.index_A >= root && frame.index_A < end) || (frame.index_B >= root && frame.index_B < end)) return true;
+    }
+    return false;
+}
+
 void KinematicTree::UpdateFK()
 {
+    // A different response may have been swapped in (e.g. by time-indexed problems), its frames all need updating.
+    const bool update_all = last_updated_solution_.lock() != solution_;
+    last_updated_solution_ = solution_;
+
+    updated_frames_.resize(solution_->frame.size());
     int i = 0;
     for (KinematicFrame& frame : solution_->frame)
     {
-        solution_->Phi(i) = FK(frame);
+        updated_frames_[i] = update_all || FrameNeedsUpdate(frame);
+        if (updated_frames_[i]) solution_->Phi(i) = FK(frame);
         ++i;
     }
+    updated_subtrees_.clear();
 }
 
 Eigen::MatrixXd KinematicTree::Jacobian(std::shared_ptr<KinematicElement> element_A, const KDL::Frame& offset_a, std::shared_ptr<KinematicElement> element_B, const KDL::Frame& offset_b) const
@@ -838,6 +1030,40 @@ Eigen::MatrixXd KinematicTree::Jdot(const KDL::Jacobian& jacobian)
 }
 
 void KinematicTree::ComputeJdot(const KDL::Jacobian& jacobian, KDL::Jacobian& jacobian_dot) const
+{
+    switch (jacobian_derivative_method_)
+    {
+        case JDOT_PAIRWISE:
+            ComputeJdotPairwise(jacobian, jacobian_dot);
+            break;
+        case JDOT_PREFIX_SUM:
+            ComputeJdotPrefixSum(jacobian, jacobian_dot);
+            break;
+        default:
+            ThrowPretty("Unknown Jacobian derivative method " << jacobian_derivative_method_);
+    }
+}
+
+void KinematicTree::ComputeJdotPrefixSum(const KDL::Jacobian& jacobian, KDL::Jacobian& jacobian_dot) const
+{
+    // Closed form of the sum in ComputeJdotPairwise. With v_i and w_i the linear and angular parts of column i:
+    //   Jdot_i = [ (sum_{j<i} w_j) x v_i + w_i x (sum_{j>=i} v_j) ; (sum_{j<i} w_j) x w_i ]
+    const int n = jacobian.columns();
+    jacobian_dot.data.resize(6, n);
+    Eigen::Vector3d angular_prefix = Eigen::Vector3d::Zero();
+    Eigen::Vector3d linear_suffix = jacobian.data.topRows<3>().rowwise().sum();
+    for (int i = 0; i < n; ++i)
+    {
+        const Eigen::Vector3d linear = jacobian.data.block<3, 1>(0, i);
+        const Eigen::Vector3d angular = jacobian.data.block<3, 1>(3, i);
+        jacobian_dot.data.block<3, 1>(0, i) = angular_prefix.cross(linear) + angular.cross(linear_suffix);
+        jacobian_dot.data.block<3, 1>(3, i) = angular_prefix.cross(angular);
+        angular_prefix += angular;
+        linear_suffix -= linear;
+    }
+}
+
+void KinematicTree::ComputeJdotPairwise(const KDL::Jacobian& jacobian, KDL::Jacobian& jacobian_dot) const
 {
     jacobian_dot.data.setZero(jacobian.rows(), jacobian.columns());
     for (int i = 0; i < jacobian.columns(); ++i)
@@ -876,27 +1102,21 @@ void KinematicTree::ComputeJ(KinematicFrame& frame, KDL::Jacobian& jacobian) con
 {
     jacobian.data.setZero();
     KDL::Frame tmp = FK(frame);  // Create temporary offset frames
-    std::shared_ptr<KinematicElement> it = frame.frame_A.lock();
-    while (it != nullptr)
+    if (frame.flat_tree_revision != flat_tree_.revision) UpdateFrameIndices(frame);
+    if (frame.index_A < 0 || frame.index_B < 0) ThrowPretty("The requested frame is not part of the compiled kinematic tree, the tree has to be updated first.");
+
+    const KDL::Rotation base_inverse = frame.temp_B.M.Inverse();
+    for (const int& i : frame.jacobian_chain_A)
     {
-        if (it->is_controlled)
-        {
-            KDL::Frame segment_reference;
-            if (it->parent.lock() != nullptr) segment_reference = it->parent.lock()->frame;
-            jacobian.setColumn(it->control_id, frame.temp_B.M.Inverse() * (segment_reference.M * it->segment.twist(tree_state_(it->id), 1.0)).RefPoint(frame.temp_A.p - it->frame.p));
-        }
-        it = it->parent.lock();
+        const int parent = flat_tree_.parent[i];
+        const KDL::Rotation& segment_reference = parent > -1 ? flat_tree_.frame[parent].M : KDL::Rotation::Identity();
+        jacobian.setColumn(flat_tree_.control_id[i], base_inverse * (segment_reference * flat_tree_.Twist(i, tree_state_(flat_tree_.state_index[i]))).RefPoint(frame.temp_A.p - flat_tree_.frame[i].p));
     }
-    it = frame.frame_B.lock();
-    while (it != nullptr)
+    for (const int& i : frame.jacobian_chain_B)
     {
-        if (it->is_controlled)
-        {
-            KDL::Frame segment_reference;
-            if (it->parent.lock() != nullptr) segment_reference = it->parent.lock()->frame;
-            jacobian.setColumn(it->control_id, jacobian.getColumn(it->control_id) - (frame.temp_B.M.Inverse() * (segment_reference.M * it->segment.twist(tree_state_(it->id), 1.0)).RefPoint(frame.temp_A.p - it->frame.p)));
-        }
-        it = it->parent.lock();
+        const int parent = flat_tree_.parent[i];
+        const KDL::Rotation& segment_reference = parent > -1 ? flat_tree_.frame[parent].M : KDL::Rotation::Identity();
+        jacobian.setColumn(flat_tree_.control_id[i], -(base_inverse * (segment_reference * flat_tree_.Twist(i, tree_state_(flat_tree_.state_index[i]))).RefPoint(frame.temp_A.p - flat_tree_.frame[i].p)));
     }
 }
 
@@ -905,7 +1125,7 @@ void KinematicTree::UpdateJ()
     int i = 0;
     for (KinematicFrame& frame : solution_->frame)
     {
-        ComputeJ(frame, solution_->jacobian(i));
+        if (updated_frames_[i]) ComputeJ(frame, solution_->jacobian(i));
         ++i;
     }
 }
@@ -915,7 +1135,7 @@ void KinematicTree::UpdateJdot()
     int i = 0;
     for (KinematicFrame& frame : solution_->frame)
     {
-        ComputeJdot(solution_->jacobian(i), solution_->jacobian_dot(i));
+        if (updated_frames_[i]) ComputeJdot(solution_->jacobian(i), solution_->jacobian_dot(i));
         ++i;
     }
 }
@@ -27,6 +27,8 @@
 // POSSIBILITY OF SUCH DAMAGE.
 //
 
+#include <algorithm>
+
 #include <exotica_core/problems/abstract_time_indexed_problem.h>
 #include <exotica_core/setup.h>
 
@@ -39,6 +41,13 @@ AbstractTimeIndexedProblem::AbstractTimeIndexedProblem()
 
 AbstractTimeIndexedProblem::~AbstractTimeIndexedProblem() = default;
 
+void AbstractTimeIndexedProblem::InstantiateBase(const Initializer& init)
+{
+    PlanningProblem::InstantiateBase(init);
+    initializer_ = init;
+    workers_.clear();
+}
+
 Eigen::MatrixXd AbstractTimeIndexedProblem::GetBounds() const
 {
     return scene_->GetKinematicTree().GetJointLimits();
@@ -136,11 +145,24 @@ void AbstractTimeIndexedProblem::SetTau(const double tau_in)
     ReinitializeVariables();
 }
 
-void AbstractTimeIndexedProblem::PreUpdate()
+void AbstractTimeIndexedProblem::PreUpdateCost()
 {
     PlanningProblem::PreUpdate();
+    workers_need_syncing_ = true;
     for (int i = 0; i < tasks_.size(); ++i) tasks_[i]->is_used = false;
     cost.UpdateS();
+
+    // Create a new set of kinematic solutions with the size of the trajectory
+    // based on the lastest KinematicResponse in order to reflect model state
+    // updates etc.
+    kinematic_solutions_.clear();
+    kinematic_solutions_.resize(T_);
+    for (int i = 0; i < T_; ++i) kinematic_solutions_[i] = std::make_shared<KinematicResponse>(*scene_->GetKinematicTree().GetKinematicResponse());
+}
+
+void AbstractTimeIndexedProblem::PreUpdate()
+{
+    PreUpdateCost();
     inequality.UpdateS();
     equality.UpdateS();
 
@@ -169,13 +191,6 @@ void AbstractTimeIndexedProblem::PreUpdate()
             }
         }
     }
-
-    // Create a new set of kinematic solutions with the size of the trajectory
-    // based on the lastest KinematicResponse in order to reflect model state
-    // updates etc.
-    kinematic_solutions_.clear();
-    kinematic_solutions_.resize(T_);
-    for (int i = 0; i < T_; ++i) kinematic_solutions_[i] = std::make_shared<KinematicResponse>(*scene_->GetKinematicTree().GetKinematicResponse());
 }
 
 void AbstractTimeIndexedProblem::SetInitialTrajectory(const std::vector<Eigen::VectorXd>& q_init_in)
@@ -201,11 +216,28 @@ double AbstractTimeIndexedProblem::GetDuration() const
     return tau_ * static_cast<double>(T_);
 }
 
+int AbstractTimeIndexedProblem::GetNumThreads() const
+{
+    return num_threads_;
+}
+
+void AbstractTimeIndexedProblem::SetNumThreads(const int num_threads)
+{
+    if (num_threads < 1) ThrowPretty("Invalid number of threads: " << num_threads);
+    num_threads_ = num_threads;
+}
+
 void AbstractTimeIndexedProblem::Update(Eigen::VectorXdRefConst x_trajectory_in)
 {
     if (x_trajectory_in.size() != (T_ - 1) * N)
         ThrowPretty("To update using the trajectory Update method, please use a trajectory of size N x (T-1) (" << N * (T_ - 1) << "), given: " << x_trajectory_in.size());
 
+    if (num_threads_ > 1)
+    {
+        UpdateParallel(x_trajectory_in);
+        return;
+    }
+
     for (int t = 1; t < T_; ++t)
     {
         Update(x_trajectory_in.segment((t - 1) * N, N), t);
@@ -216,6 +248,16 @@ void AbstractTimeIndexedProblem::Update(Eigen::VectorXdRefConst x_in, int t)
 {
     ValidateTimeIndex(t);
 
+    UpdateKinematics(x_in, t);
+    UpdateTaskMaps(t);
+    UpdateTaskTerms(t);
+
+    if (t > 0) xdiff[t] = x[t] - x[t - 1];
+    ++number_of_problem_updates_;
+}
+
+void AbstractTimeIndexedProblem::UpdateKinematics(Eigen::VectorXdRefConst x_in, int t)
+{
     x[t] = x_in;
 
     // Set the corresponding KinematicResponse for KinematicTree in order to
@@ -235,6 +277,10 @@ void AbstractTimeIndexedProblem::Update(Eigen::VectorXdRefConst x_in, int t)
     PlanningProblem::UpdateMultipleTaskKinematics(kinematics_solutions);
 
     scene_->Update(x_in, static_cast<double>(t) * tau_);
+}
+
+void AbstractTimeIndexedProblem::UpdateTaskMaps(int t)
+{
     Phi[t].SetZero(length_Phi);
     if (flags_ & KIN_J) jacobian[t].setZero();
     if (flags_ & KIN_J_DOT)
@@ -258,6 +304,10 @@ void AbstractTimeIndexedProblem::Update(Eigen::VectorXdRefConst x_in, int t)
             }
         }
     }
+}
+
+void AbstractTimeIndexedProblem::UpdateTaskTerms(int t)
+{
     if (flags_ & KIN_J_DOT)
     {
         cost.Update(Phi[t], jacobian[t], hessian[t], t);
@@ -276,8 +326,91 @@ void AbstractTimeIndexedProblem::Update(Eigen::VectorXdRefConst x_in, int t)
         inequality.Update(Phi[t], t);
         equality.Update(Phi[t], t);
     }
-    if (t > 0) xdiff[t] = x[t] - x[t - 1];
-    ++number_of_problem_updates_;
+}
+
+void AbstractTimeIndexedProblem::UpdateWorkers()
+{
+    const int num_workers = num_threads_ - 1;
+    if (static_cast<int>(workers_.size()) > num_workers) workers_.resize(num_workers);
+    while (static_cast<int>(workers_.size()) < num_workers)
+    {
+        std::shared_ptr<AbstractTimeIndexedProblem> worker = std::dynamic_pointer_cast<AbstractTimeIndexedProblem>(Setup::CreateProblem(initializer_));
+        if (!worker) ThrowPretty("Failed to create a copy of the problem for the parallel update.");
+        workers_.push_back(worker);
+        workers_need_syncing_ = true;
+    }
+    thread_pool_.Resize(num_workers);
+
+    if (workers_need_syncing_)
+    {
+        for (auto& worker : workers_)
+        {
+            worker->scene_->CopyStateFrom(*scene_);
+            worker->flags_ = flags_;
+            worker->T_ = T_;
+            worker->tau_ = tau_;
+            // Reallocates the buffers and the kinematic solutions for the updated scene.
+            worker->ReinitializeVariables();
+        }
+        workers_need_syncing_ = false;
+    }
+
+    for (auto& worker : workers_)
+    {
+        for (int i = 0; i < num_tasks; ++i) worker->tasks_[i]->is_used = tasks_[i]->is_used;
+    }
+}
+
+void AbstractTimeIndexedProblem::UpdateParallel(Eigen::VectorXdRefConst x_trajectory_in)
+{
+    UpdateWorkers();
+
+    // Timesteps 1..T-1 are split into contiguous blocks. The first block is
+    // evaluated by this problem, the others by the problem copies on the
+    // persistent threads of thread_pool_. Each copy first evaluates the
+    // kinematics of the timestep preceding its block so that task maps using
+    // the previous timestep see the same values as in the serial update.
+    const int num_blocks = std::min(num_threads_, T_ - 1);
+    auto block_begin = [this, num_blocks](int block) { return 1 + block * (T_ - 1) / num_blocks; };
+
+    auto update_block = [this, &x_trajectory_in](AbstractTimeIndexedProblem& problem, int begin, int end) {
+        if (&problem != this) problem.UpdateKinematics(x_trajectory_in.segment((begin - 2) * N, N), begin - 1);
+        for (int t = begin; t < end; ++t)
+        {
+            problem.UpdateKinematics(x_trajectory_in.segment((t - 1) * N, N), t);
+            problem.UpdateTaskMaps(t);
+            if (&problem != this)
+            {
+                x[t] = problem.x[t];
+                Phi[t].data = problem.Phi[t].data;
+                if (flags_ & KIN_J) jacobian[t] = problem.jacobian[t];
+                if (flags_ & KIN_J_DOT) hessian[t] = problem.hessian[t];
+
+                // Keep the kinematic solutions consistent with the serial update.
+                const KinematicResponse& source = *problem.kinematic_solutions_[t];
+                KinematicResponse& target = *kinematic_solutions_[t];
+                target.x = source.x;
+                target.Phi = source.Phi;
+                target.Phi_dot = source.Phi_dot;
+                target.jacobian = source.jacobian;
+                target.jacobian_dot = source.jacobian_dot;
+            }
+            UpdateTaskTerms(t);
+        }
+    };
+
+    thread_pool_.Run([&](int block) {
+        if (block == 0)
+            update_block(*this, block_begin(0), block_begin(1));
+        else if (block < num_blocks)
+            update_block(*workers_[block - 1], block_begin(block), block_begin(block + 1));
+    });
+
+    // Leave the scene and the task kinematics in the same state as the serial update.
+    UpdateKinematics(x[T_ - 1], T_ - 1);
+
+    for (int t = 1; t < T_; ++t) xdiff[t] = x[t] - x[t - 1];
+    number_of_problem_updates_ += T_ - 1;
 }
 
 double AbstractTimeIndexedProblem::get_ct() const
@@ -59,71 +59,18 @@ void BoundedTimeIndexedProblem::Instantiate(const BoundedTimeIndexedProblemIniti
 
     T_ = this->parameters_.T;
     tau_ = this->parameters_.tau;
+    SetNumThreads(this->parameters_.NumThreads);
     ApplyStartState(false);
     ReinitializeVariables();
 }
 
 void BoundedTimeIndexedProblem::PreUpdate()
 {
-    PlanningProblem::PreUpdate();
-    for (int i = 0; i < tasks_.size(); ++i) tasks_[i]->is_used = false;
-    cost.UpdateS();
-
-    // Create a new set of kinematic solutions with the size of the trajectory
-    // based on the lastest KinematicResponse in order to reflect model state
-    // updates etc.
-    kinematic_solutions_.clear();
-    kinematic_solutions_.resize(T_);
-    for (int i = 0; i < T_; ++i) kinematic_solutions_[i] = std::make_shared<KinematicResponse>(*scene_->GetKinematicTree().GetKinematicResponse());
+    PreUpdateCost();
 }
 
-void BoundedTimeIndexedProblem::Update(Eigen::VectorXdRefConst x_in, int t)
+void BoundedTimeIndexedProblem::UpdateTaskTerms(int t)
 {
-    ValidateTimeIndex(t);
-
-    x[t] = x_in;
-
-    // Set the corresponding KinematicResponse for KinematicTree in order to
-    // have Kinematics elements updated based in x_in.
-    scene_->GetKinematicTree().SetKinematicResponse(kinematic_solutions_[t]);
-
-    // Pass the corresponding number of relevant task kinematics to the TaskMaps
-    // via the PlanningProblem::UpdateMultipleTaskKinematics method. For now we
-    // support passing _two_ timesteps - this can be easily changed later on.
-    std::vector<std::shared_ptr<KinematicResponse>> kinematics_solutions{kinematic_solutions_[t]};
-
-    // If the current timestep is 0, pass the 0th timestep's response twice.
-    // Otherwise pass the (t-1)th response.
-    kinematics_solutions.emplace_back((t == 0) ? kinematic_solutions_[t] : kinematic_solutions_[t - 1]);
-
-    // Actually update the tasks' kinematics mappings.
-    PlanningProblem::UpdateMultipleTaskKinematics(kinematics_solutions);
-
-    scene_->Update(x_in, static_cast<double>(t) * tau_);
-
-    Phi[t].SetZero(length_Phi);
-    if (flags_ & KIN_J) jacobian[t].setZero();
-    if (flags_ & KIN_J_DOT)
-        for (int i = 0; i < length_jacobian; ++i) hessian[t](i).setZero();
-    for (int i = 0; i < num_tasks; ++i)
-    {
-        // Only update TaskMap if rho is not 0
-        if (tasks_[i]->is_used)
-        {
-            if (flags_ & KIN_J_DOT)
-            {
-                tasks_[i]->Update(x[t], Phi[t].data.segment(tasks_[i]->start, tasks_[i]->length), jacobian[t].middleRows(tasks_[i]->start_jacobian, tasks_[i]->length_jacobian), hessian[t].segment(tasks_[i]->start, tasks_[i]->length));
-            }
-            else if (flags_ & KIN_J)
-            {
-                tasks_[i]->Update(x[t], Phi[t].data.segment(tasks_[i]->start, tasks_[i]->length), jacobian[t].middleRows(tasks_[i]->start_jacobian, tasks_[i]->length_jacobian));
-            }
-            else
-            {
-                tasks_[i]->Update(x[t], Phi[t].data.segment(tasks_[i]->start, tasks_[i]->length));
-            }
-        }
-    }
     if (flags_ & KIN_J_DOT)
     {
         cost.Update(Phi[t], jacobian[t], hessian[t], t);
@@ -136,10 +83,6 @@ void BoundedTimeIndexedProblem::Update(Eigen::VectorXdRefConst x_in, int t)
     {
         cost.Update(Phi[t], t);
     }
-
-    if (t > 0) xdiff[t] = x[t] - x[t - 1];
-
-    ++number_of_problem_updates_;
 }
 
 void BoundedTimeIndexedProblem::ReinitializeVariables()
@@ -336,6 +336,13 @@ void DynamicTimeIndexedShootingProblem::set_X(Eigen::MatrixXdRefConst X_in)
     X_ = X_in;
 }
 
+void DynamicTimeIndexedShootingProblem::set_X(Eigen::VectorXdRefConst x_in, int t)
+{
+    ValidateTimeIndex(t);
+    if (x_in.rows() != X_.rows()) ThrowPretty("Sizes don't match! " << X_.rows() << " vs " << x_in.rows());
+    X_.col(t) = x_in;
+}
+
 const Eigen::MatrixXd& DynamicTimeIndexedShootingProblem::get_U() const
 {
     return U_;
@@ -491,32 +498,52 @@ void DynamicTimeIndexedShootingProblem::Update(Eigen::VectorXdRefConst u_in, int
 double DynamicTimeIndexedShootingProblem::GetStateCost(int t) const
 {
     ValidateTimeIndex(t);
-    const Eigen::VectorXd x_diff = scene_->GetDynamicsSolver()->StateDelta(X_.col(t), X_star_.col(t));
-    const double general_cost = cost.ydiff[t].transpose() * cost.S[t] * cost.ydiff[t];  // TODO: ct scaling
-    return (x_diff.transpose() * Q_[t] * x_diff) + general_cost;
+    x_diff_.resize(num_positions_ + num_velocities_);
+    scene_->GetDynamicsSolver()->StateDelta(X_.col(t), X_star_.col(t), x_diff_);
+    state_buffer_.noalias() = Q_[t] * x_diff_;
+    task_buffer_.noalias() = cost.S[t] * cost.ydiff[t];
+    const double general_cost = cost.ydiff[t].dot(task_buffer_);  // TODO: ct scaling
+    return x_diff_.dot(state_buffer_) + general_cost;
 }
 
 Eigen::VectorXd DynamicTimeIndexedShootingProblem::GetStateCostJacobian(int t) const
 {
     // TODO: Check whether we should make this a RowVectorXd
-    ValidateTimeIndex(t);
-    const Eigen::VectorXd x_diff = scene_->GetDynamicsSolver()->StateDelta(X_.col(t), X_star_.col(t));
-    const Eigen::VectorXd state_cost_jacobian = Q_[t] * x_diff + Q_[t].transpose() * x_diff;
+    Eigen::VectorXd state_cost_jacobian(num_positions_ + num_velocities_);
+    GetStateCostJacobian(t, state_cost_jacobian);
+    return state_cost_jacobian;
+}
 
-    Eigen::VectorXd general_cost_jacobian = Eigen::VectorXd::Zero(num_positions_ + num_velocities_);
-    general_cost_jacobian.head(num_positions_) = cost.jacobian[t].transpose() * cost.S[t] * cost.ydiff[t] * 2.0;
+void DynamicTimeIndexedShootingProblem::GetStateCostJacobian(int t, Eigen::VectorXdRef state_cost_jacobian) const
+{
+    ValidateTimeIndex(t);
+    x_diff_.resize(num_positions_ + num_velocities_);
+    scene_->GetDynamicsSolver()->StateDelta(X_.col(t), X_star_.col(t), x_diff_);
+    state_cost_jacobian.noalias() = Q_[t] * x_diff_;
+    state_cost_jacobian.noalias() += Q_[t].transpose() * x_diff_;
 
-    return state_cost_jacobian + general_cost_jacobian;
+    // General cost
+    task_buffer_.noalias() = cost.S[t] * cost.ydiff[t];
+    state_cost_jacobian.head(num_positions_).noalias() += 2.0 * cost.jacobian[t].transpose() * task_buffer_;
 }
 
 Eigen::MatrixXd DynamicTimeIndexedShootingProblem::GetStateCostHessian(int t) const
+{
+    Eigen::MatrixXd state_cost_hessian(num_positions_ + num_velocities_, num_positions_ + num_velocities_);
+    GetStateCostHessian(t, state_cost_hessian);
+    return state_cost_hessian;
+}
+
+void DynamicTimeIndexedShootingProblem::GetStateCostHessian(int t, Eigen::MatrixXdRef state_cost_hessian) const
 {
     ValidateTimeIndex(t);
-    Eigen::VectorXd general_cost_jacobian = Eigen::VectorXd::Zero(num_positions_ + num_velocities_);
-    general_cost_jacobian.head(num_positions_) = cost.jacobian[t].transpose() * cost.S[t] * cost.ydiff[t] * 2.0;
+    state_buffer_.setZero(num_positions_ + num_velocities_);
+    task_buffer_.noalias() = cost.S[t] * cost.ydiff[t];
+    state_buffer_.head(num_positions_).noalias() = 2.0 * cost.jacobian[t].transpose() * task_buffer_;
     // TODO: Using a J^T*J approximation for the general cost here as Hessians aren't implemented for task maps yet.
     // TODO: As we are not using RowVectorXd (yet), this is J*J^T instead of the correct J^T*J
-    return Q_[t] + Q_[t].transpose() + (general_cost_jacobian * general_cost_jacobian.transpose());
+    state_cost_hessian = Q_[t] + Q_[t].transpose();
+    state_cost_hessian.noalias() += state_buffer_ * state_buffer_.transpose();
 }
 
 Eigen::MatrixXd DynamicTimeIndexedShootingProblem::GetControlCostHessian() const
@@ -524,6 +551,16 @@ Eigen::MatrixXd DynamicTimeIndexedShootingProblem::GetControlCostHessian() const
     return R_ + R_.transpose();
 }
 
+void DynamicTimeIndexedShootingProblem::GetControlCostHessian(Eigen::MatrixXdRef control_cost_hessian) const
+{
+    control_cost_hessian = R_ + R_.transpose();
+}
+
+void DynamicTimeIndexedShootingProblem::GetStateControlCostHessian(Eigen::MatrixXdRef state_control_cost_hessian) const
+{
+    state_control_cost_hessian.setZero();
+}
+
 double DynamicTimeIndexedShootingProblem::GetControlCost(int t) const
 {
     if (t >= T_ - 1 || t < -1)
@@ -534,10 +571,18 @@ double DynamicTimeIndexedShootingProblem::GetControlCost(int t) const
     {
         t = T_ - 2;
     }
-    return U_.col(t).transpose() * R_ * U_.col(t);
+    control_buffer_.noalias() = R_ * U_.col(t);
+    return U_.col(t).dot(control_buffer_);
 }
 
 Eigen::VectorXd DynamicTimeIndexedShootingProblem::GetControlCostJacobian(int t) const
+{
+    Eigen::VectorXd control_cost_jacobian(num_controls_);
+    GetControlCostJacobian(t, control_cost_jacobian);
+    return control_cost_jacobian;
+}
+
+void DynamicTimeIndexedShootingProblem::GetControlCostJacobian(int t, Eigen::VectorXdRef control_cost_jacobian) const
 {
     if (t >= T_ - 1 || t < -1)
     {
@@ -547,7 +592,8 @@ Eigen::VectorXd DynamicTimeIndexedShootingProblem::GetControlCostJacobian(int t)
     {
         t = T_ - 2;
     }
-    return R_ * U_.col(t) + R_.transpose() * U_.col(t);
+    control_cost_jacobian.noalias() = R_ * U_.col(t);
+    control_cost_jacobian.noalias() += R_.transpose() * U_.col(t);
 }
 
 Eigen::VectorXd DynamicTimeIndexedShootingProblem::Dynamics(Eigen::VectorXdRefConst x, Eigen::VectorXdRefConst u)
@@ -594,4 +640,41 @@ void DynamicTimeIndexedShootingProblem::DisableStochasticUpdates()
     stochastic_updates_enabled_ = false;
 }
 
+bool DynamicTimeIndexedShootingProblem::get_stochastic_updates_enabled() const
+{
+    return stochastic_matrices_specified_ && stochastic_updates_enabled_;
+}
+
+void DynamicTimeIndexedShootingProblem::CopyStateFrom(DynamicTimeIndexedShootingProblem& other)
+{
+    if (num_positions_ != other.num_positions_ || num_velocities_ != other.num_velocities_ || num_controls_ != other.num_controls_) ThrowPretty("Cannot copy the state of a problem with different dimensions!");
+
+    scene_->CopyStateFrom(*other.scene_);
+    scene_->GetDynamicsSolver()->set_integrator(other.scene_->GetDynamicsSolver()->get_integrator());
+
+    // Resizes the trajectories and the cost task before copying them.
+    if (T_ != other.T_) set_T(other.T_);
+
+    CopyTrajectoriesFrom(other);
+    stochastic_updates_enabled_ = other.stochastic_updates_enabled_;
+
+    // Updates the task weights and the kinematic solutions for the new scene state.
+    PreUpdate();
+}
+
+void DynamicTimeIndexedShootingProblem::CopyTrajectoriesFrom(const DynamicTimeIndexedShootingProblem& other)
+{
+    if (T_ != other.T_ || num_positions_ != other.num_positions_ || num_velocities_ != other.num_velocities_ || num_controls_ != other.num_controls_) ThrowPretty("Cannot copy the trajectories of a problem with a different horizon or dimensions!");
+
+    // The sizes match, so the assignments copy in place.
+    X_ = other.X_;
+    U_ = other.U_;
+    X_star_ = other.X_star_;
+    Qf_ = other.Qf_;
+    Q_ = other.Q_;
+    cost.y = other.cost.y;
+    cost.rho = other.cost.rho;
+    cost.UpdateS();
+}
+
 }  // namespace exotica
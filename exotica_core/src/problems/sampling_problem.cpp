@@ -27,6 +27,8 @@
 // POSSIBILITY OF SUCH DAMAGE.
 //
 
+#include <algorithm>
+
 #include <exotica_core/problems/sampling_problem.h>
 #include <exotica_core/setup.h>
 
@@ -56,6 +58,12 @@ std::vector<double> SamplingProblem::GetBounds()
     return bounds;
 }
 
+void SamplingProblem::InstantiateBase(const Initializer& init)
+{
+    PlanningProblem::InstantiateBase(init);
+    initializer_ = init;
+}
+
 void SamplingProblem::Instantiate(const SamplingProblemInitializer& init)
 {
     if (init.Goal.size() == N)
@@ -110,6 +118,8 @@ void SamplingProblem::Instantiate(const SamplingProblemInitializer& init)
         }
     }
 
+    if (init.ValidityCacheSize > 0) validity_cache_.Configure(init.ValidityCacheResolution, init.ValidityCacheSize);
+
     PreUpdate();
 }
 
@@ -119,6 +129,63 @@ void SamplingProblem::PreUpdate()
     for (int i = 0; i < tasks_.size(); ++i) tasks_[i]->is_used = false;
     inequality.UpdateS();
     equality.UpdateS();
+    UpdateValidityChecks();
+    validity_cache_.Clear();
+}
+
+void SamplingProblem::UpdateValidityChecks()
+{
+    validity_checks_.clear();
+    for (int i = 0; i < num_tasks; ++i)
+    {
+        if (!tasks_[i]->is_used) continue;
+
+        ValidityCheck check;
+        check.task_map = i;
+        for (int j = 0; j < static_cast<int>(inequality.indexing.size()); ++j)
+        {
+            if (inequality.tasks[j] == tasks_[i] && inequality.rho(inequality.indexing[j].id) != 0.0) check.inequality.push_back(j);
+        }
+        for (int j = 0; j < static_cast<int>(equality.indexing.size()); ++j)
+        {
+            if (equality.tasks[j] == tasks_[i] && equality.rho(equality.indexing[j].id) != 0.0) check.equality.push_back(j);
+        }
+        validity_checks_.push_back(check);
+    }
+
+    // Stable, so task maps of the same cost are evaluated in the order they were declared
+    std::stable_sort(validity_checks_.begin(), validity_checks_.end(), [this](const ValidityCheck& a, const ValidityCheck& b) {
+        return tasks_[a.task_map]->GetRelativeCost() < tasks_[b.task_map]->GetRelativeCost();
+    });
+}
+
+std::shared_ptr<SamplingProblem> SamplingProblem::CreateReplica()
+{
+    std::shared_ptr<SamplingProblem> replica = std::dynamic_pointer_cast<SamplingProblem>(Setup::CreateProblem(initializer_));
+    if (!replica) ThrowPretty("Failed to create a replica of the problem.");
+    replica->CopyStateFrom(*this);
+    return replica;
+}
+
+void SamplingProblem::CopyStateFrom(SamplingProblem& other)
+{
+    if (other.N != N || other.num_tasks != num_tasks) ThrowPretty("Cannot copy the state of a problem created from a different initializer.");
+
+    scene_->CopyStateFrom(*other.scene_);
+    const Eigen::MatrixXd& joint_limits = other.scene_->GetKinematicTree().GetJointLimits();
+    scene_->GetKinematicTree().SetJointLimitsLower(joint_limits.col(0));
+    scene_->GetKinematicTree().SetJointLimitsUpper(joint_limits.col(1));
+
+    start_state_ = other.start_state_;
+    t_start = other.t_start;
+    goal_ = other.goal_;
+    inequality.y = other.inequality.y;
+    inequality.rho = other.inequality.rho;
+    inequality.tolerance = other.inequality.tolerance;
+    equality.y = other.equality.y;
+    equality.rho = other.equality.rho;
+    equality.tolerance = other.equality.tolerance;
+    PreUpdate();
 }
 
 void SamplingProblem::SetGoalState(Eigen::VectorXdRefConst qT)
@@ -136,6 +203,7 @@ void SamplingProblem::SetGoalEQ(const std::string& task_name, Eigen::VectorXdRef
         {
             if (goal.rows() != equality.indexing[i].length) ThrowPretty("Expected length of " << equality.indexing[i].length << " and got " << goal.rows());
             equality.y.data.segment(equality.indexing[i].start, equality.indexing[i].length) = goal;
+            validity_cache_.Clear();
             return;
         }
     }
@@ -188,6 +256,7 @@ void SamplingProblem::SetGoalNEQ(const std::string& task_name, Eigen::VectorXdRe
         {
             if (goal.rows() != inequality.indexing[i].length) ThrowPretty("Expected length of " << inequality.indexing[i].length << " and got " << goal.rows());
             inequality.y.data.segment(inequality.indexing[i].start, inequality.indexing[i].length) = goal;
+            validity_cache_.Clear();
             return;
         }
     }
@@ -245,11 +314,9 @@ void SamplingProblem::Update(Eigen::VectorXdRefConst x)
     ++number_of_problem_updates_;
 }
 
-bool SamplingProblem::IsValid()
+bool SamplingProblem::IsWithinBounds(Eigen::VectorXdRefConst x) const
 {
-    // Check bounds
-    const Eigen::VectorXd x = scene_->GetKinematicTree().GetControlledState();
-    const Eigen::MatrixXd bounds = scene_->GetKinematicTree().GetJointLimits();
+    const Eigen::MatrixXd& bounds = scene_->GetKinematicTree().GetJointLimits();
     for (int i = 0; i < N; ++i)
     {
         if (x(i) < bounds(i, 0) || x(i) > bounds(i, 1))
@@ -258,6 +325,13 @@ bool SamplingProblem::IsValid()
             return false;
         }
     }
+    return true;
+}
+
+bool SamplingProblem::IsValid()
+{
+    // Check bounds
+    if (!IsWithinBounds(scene_->GetKinematicTree().GetControlledState())) return false;
 
     // Check constraints
     const bool inequality_is_valid = ((inequality.S * inequality.ydiff).array() <= 0.0).all();
@@ -266,10 +340,61 @@ bool SamplingProblem::IsValid()
     return (inequality_is_valid && equality_is_valid);
 }
 
+bool SamplingProblem::CheckConstraints(Eigen::VectorXdRefConst x, const ValidityCheck& check)
+{
+    const TaskMapPtr& task_map = tasks_[check.task_map];
+    task_map->Update(x, Phi.data.segment(task_map->start, task_map->length));
+
+    if (!check.inequality.empty())
+    {
+        inequality.Update(Phi);
+        for (const int i : check.inequality)
+        {
+            const TaskIndexing& task = inequality.indexing[i];
+            if (((inequality.rho(task.id) * inequality.ydiff.segment(task.start_jacobian, task.length_jacobian)).array() > 0.0).any()) return false;
+        }
+    }
+    if (!check.equality.empty())
+    {
+        equality.Update(Phi);
+        for (const int i : check.equality)
+        {
+            const TaskIndexing& task = equality.indexing[i];
+            if (((equality.rho(task.id) * equality.ydiff.segment(task.start_jacobian, task.length_jacobian)).array() != 0.0).any()) return false;
+        }
+    }
+    return true;
+}
+
 bool SamplingProblem::IsValid(Eigen::VectorXdRefConst x)
 {
-    Update(x);
-    return IsValid();
+    // Joint limits are checked on the raw state, before computing any kinematics
+    if (!IsWithinBounds(x)) return false;
+
+    if (!validity_cache_.IsEnabled()) return CheckValidity(x);
+
+    validity_cache_.SetRevision(scene_->GetRevision());
+    const ValidityCache::Key key = validity_cache_.GetKey(x);
+    bool valid;
+    if (validity_cache_.Lookup(key, valid)) return valid;
+    valid = CheckValidity(x);
+    validity_cache_.Insert(key, valid);
+    return valid;
+}
+
+bool SamplingProblem::CheckValidity(Eigen::VectorXdRefConst x)
+{
+    scene_->Update(x);
+    ++number_of_problem_updates_;
+    for (const ValidityCheck& check : validity_checks_)
+    {
+        if (!CheckConstraints(x, check)) return false;
+    }
+
+    // Also refresh the constraints of task maps which did not need to be checked
+    inequality.Update(Phi);
+    equality.Update(Phi);
+    return true;
 }
 
 int SamplingProblem::GetSpaceDim()
@@ -79,6 +79,7 @@ void TimeIndexedProblem::Instantiate(const TimeIndexedProblemInitializer& init)
 
     T_ = this->parameters_.T;
     tau_ = this->parameters_.tau;
+    SetNumThreads(this->parameters_.NumThreads);
     SetJointVelocityLimits(this->parameters_.JointVelocityLimits);
     ApplyStartState(false);
     ReinitializeVariables();
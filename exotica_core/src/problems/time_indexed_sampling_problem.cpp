@@ -133,6 +133,8 @@ void TimeIndexedSamplingProblem::Instantiate(const TimeIndexedSamplingProblemIni
         }
     }
 
+    if (init.ValidityCacheSize > 0) validity_cache_.Configure(init.ValidityCacheResolution, init.ValidityCacheSize);
+
     PreUpdate();
 }
 
@@ -171,6 +173,7 @@ void TimeIndexedSamplingProblem::SetGoalEQ(const std::string& task_name, Eigen::
         {
             if (goal.rows() != equality.indexing[i].length) ThrowPretty("Expected length of " << equality.indexing[i].length << " and got " << goal.rows());
             equality.y.data.segment(equality.indexing[i].start, equality.indexing[i].length) = goal;
+            validity_cache_.Clear();
             return;
         }
     }
@@ -223,6 +226,7 @@ void TimeIndexedSamplingProblem::SetGoalNEQ(const std::string& task_name, Eigen:
         {
             if (goal.rows() != inequality.indexing[i].length) ThrowPretty("Expected length of " << inequality.indexing[i].length << " and got " << goal.rows());
             inequality.y.data.segment(inequality.indexing[i].start, inequality.indexing[i].length) = goal;
+            validity_cache_.Clear();
             return;
         }
     }
@@ -268,6 +272,19 @@ double TimeIndexedSamplingProblem::GetRhoNEQ(const std::string& task_name)
 }
 
 bool TimeIndexedSamplingProblem::IsValid(Eigen::VectorXdRefConst x, const double& t)
+{
+    if (!validity_cache_.IsEnabled()) return CheckValidity(x, t);
+
+    validity_cache_.SetRevision(scene_->GetRevision());
+    const ValidityCache::Key key = validity_cache_.GetKey(x, t);
+    bool valid;
+    if (validity_cache_.Lookup(key, valid)) return valid;
+    valid = CheckValidity(x, t);
+    validity_cache_.Insert(key, valid);
+    return valid;
+}
+
+bool TimeIndexedSamplingProblem::CheckValidity(Eigen::VectorXdRefConst x, const double& t)
 {
     scene_->Update(x, t);
     for (int i = 0; i < num_tasks; ++i)
@@ -291,11 +308,12 @@ void TimeIndexedSamplingProblem::PreUpdate()
     for (int i = 0; i < tasks_.size(); ++i) tasks_[i]->is_used = false;
     inequality.UpdateS();
     equality.UpdateS();
+    validity_cache_.Clear();
 }
 
 void TimeIndexedSamplingProblem::Update(Eigen::VectorXdRefConst x, const double& t)
 {
-    IsValid(x, t);
+    CheckValidity(x, t);
     ++number_of_problem_updates_;
 }
 
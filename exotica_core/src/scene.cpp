@@ -74,6 +74,12 @@ void Scene::Instantiate(const SceneInitializer& init)
         Server::Instance()->GetModel(init.URDF, model, init.URDF, init.SRDF);
     }
     kinematica_.Instantiate(init.JointGroup, model, object_name_);
+    if (init.JacobianDerivativeMethod == "PrefixSum")
+        kinematica_.SetJacobianDerivativeMethod(JDOT_PREFIX_SUM);
+    else if (init.JacobianDerivativeMethod == "Pairwise")
+        kinematica_.SetJacobianDerivativeMethod(JDOT_PAIRWISE);
+    else
+        ThrowPretty("Unknown JacobianDerivativeMethod '" << init.JacobianDerivativeMethod << "', expected 'PrefixSum' or 'Pairwise'.");
     ps_.reset(new planning_scene::PlanningScene(model));
 
     // Write URDF/SRDF to ROS param server
@@ -211,6 +217,55 @@ void Scene::Instantiate(const SceneInitializer& init)
     if (debug_) INFO_NAMED(object_name_, "Exotica Scene initialized");
 }
 
+std::shared_ptr<Scene> Scene::Clone()
+{
+    // Links, attachments and trajectories are copied from the current state instead of the initializer.
+    SceneInitializer init(parameters_);
+    init.LoadScene = "";
+    init.Links.clear();
+    init.AttachLinks.clear();
+    init.Trajectories.clear();
+    std::shared_ptr<Scene> clone = std::make_shared<Scene>();
+    clone->InstantiateInternal(init);
+    clone->CopyStateFrom(*this);
+    return clone;
+}
+
+void Scene::CopyStateFrom(Scene& other)
+{
+    // The copied planning scene shares the (immutable) collision shapes of the world objects.
+    ps_ = planning_scene::PlanningScene::clone(other.ps_);
+    custom_links_ = other.custom_links_;
+    attached_objects_ = other.attached_objects_;
+    trajectory_generators_.clear();
+    for (const auto& it : other.trajectory_generators_)
+    {
+        trajectory_generators_[it.first] = std::make_pair(std::weak_ptr<KinematicElement>(), std::make_shared<Trajectory>(it.second.second->GetData(), it.second.second->GetRadius()));
+    }
+    collision_scene_->SetACM(other.collision_scene_->GetACM());
+    collision_scene_->SetWorldLinkPadding(other.collision_scene_->GetWorldLinkPadding());
+    collision_scene_->SetRobotLinkPadding(other.collision_scene_->GetRobotLinkPadding());
+    collision_scene_->SetWorldLinkScale(other.collision_scene_->GetWorldLinkScale());
+    collision_scene_->SetRobotLinkScale(other.collision_scene_->GetRobotLinkScale());
+    UpdateSceneFrames();
+    UpdateInternalFrames(false);
+
+    kinematica_.SetJacobianDerivativeMethod(other.kinematica_.GetJacobianDerivativeMethod());
+    if (kinematic_request_callback_)
+    {
+        // Keep the own request and notify its owner about the new response.
+        kinematic_solution_ = kinematica_.RequestFrames(kinematic_request_);
+        kinematic_request_callback_(kinematic_solution_);
+    }
+    else
+    {
+        kinematic_request_ = other.kinematic_request_;
+        kinematic_solution_ = kinematica_.RequestFrames(kinematic_request_);
+    }
+    request_needs_updating_ = false;
+    SetModelState(other.GetModelState());
+}
+
 void Scene::RequestKinematics(KinematicsRequest& request, std::function<void(std::shared_ptr<KinematicResponse>)> callback)
 {
     kinematic_request_ = request;
@@ -241,6 +296,17 @@ void Scene::Update(Eigen::VectorXdRefConst x, double t)
     if (debug_) PublishScene();
 }
 
+void Scene::UpdateBatch(Eigen::MatrixXdRefConst X, Eigen::MatrixXd& frames, Eigen::MatrixXd& jacobians, double t)
+{
+    if (request_needs_updating_ && kinematic_request_callback_)
+    {
+        UpdateInternalFrames();
+    }
+
+    UpdateTrajectoryGenerators(t);
+    kinematica_.UpdateBatch(X, frames, jacobians);
+}
+
 void Scene::UpdateMoveItPlanningScene()
 {
     std::map<std::string, double> modelState = GetModelStateMap();
@@ -339,6 +405,7 @@ void Scene::UpdatePlanningSceneWorld(const moveit_msgs::PlanningSceneWorldConstP
 
 void Scene::UpdateCollisionObjects()
 {
+    ++revision_;
     collision_scene_->UpdateCollisionObjects(kinematica_.GetCollisionTreeMap());
 }
 
@@ -474,6 +541,7 @@ void Scene::SetModelState(Eigen::VectorXdRefConst x, double t, bool update_traj)
     if (update_traj) UpdateTrajectoryGenerators(t);
     // Update Kinematica internal state
     kinematica_.SetModelState(x);
+    ++revision_;
 
     if (force_collision_) collision_scene_->UpdateCollisionObjectTransforms();
     if (debug_) PublishScene();
@@ -489,6 +557,7 @@ void Scene::SetModelState(std::map<std::string, double> x, double t, bool update
     if (update_traj) UpdateTrajectoryGenerators(t);
     // Update Kinematica internal state
     kinematica_.SetModelState(x);
+    ++revision_;
 
     if (force_collision_) collision_scene_->UpdateCollisionObjectTransforms();
     if (debug_) PublishScene();
@@ -593,6 +662,7 @@ void Scene::UpdateInternalFrames(bool update_request)
 
 void Scene::UpdateSceneFrames()
 {
+    ++revision_;
     kinematica_.ResetModel();
 
     // Add world objects
@@ -762,12 +832,14 @@ void Scene::RemoveObject(const std::string& name)
 
 void Scene::AttachObject(const std::string& name, const std::string& parent)
 {
+    ++revision_;
     kinematica_.ChangeParent(name, parent, KDL::Frame::Identity(), false);
     attached_objects_[name] = AttachedObject(parent);
 }
 
 void Scene::AttachObjectLocal(const std::string& name, const std::string& parent, const KDL::Frame& pose)
 {
+    ++revision_;
     kinematica_.ChangeParent(name, parent, pose, true);
     attached_objects_[name] = AttachedObject(parent, pose);
 }
@@ -782,6 +854,7 @@ void Scene::DetachObject(const std::string& name)
     if (!HasAttachedObject(name)) ThrowPretty("'" << name << "' is not attached to the robot!");
     auto object = attached_objects_.find(name);
     kinematica_.ChangeParent(name, "", KDL::Frame::Identity(), false);
+    ++revision_;
     attached_objects_.erase(object);
 }
 
@@ -808,6 +881,7 @@ void Scene::AddTrajectory(const std::string& link, std::shared_ptr<Trajectory> t
     if (traj->GetDuration() == 0.0) ThrowPretty("The trajectory is empty!");
     trajectory_generators_[link] = std::pair<std::weak_ptr<KinematicElement>, std::shared_ptr<Trajectory>>(it->second, traj);
     it->second.lock()->is_trajectory_generated = true;
+    ++revision_;
 }
 
 std::shared_ptr<Trajectory> Scene::GetTrajectory(const std::string& link)
@@ -822,6 +896,7 @@ void Scene::RemoveTrajectory(const std::string& link)
     const auto& it = trajectory_generators_.find(link);
     if (it == trajectory_generators_.end()) ThrowPretty("No trajectory generator defined for link '" << link << "'!");
     it->second.first.lock()->is_trajectory_generated = false;
+    ++revision_;
     trajectory_generators_.erase(it);
 }
 }  // namespace exotica
@@ -0,0 +1,414 @@
+//
+// Copyright (c) 2018, University of Edinburgh
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <exotica_core/exotica_core.h>
+#include <gtest/gtest.h>
+
+// Extend testing printout //////////////////////
+
+namespace testing
+{
+namespace internal
+{
+enum GTestColor
+{
+    COLOR_DEFAULT,
+    COLOR_RED,
+    COLOR_GREEN,
+    COLOR_YELLOW
+};
+
+extern void ColoredPrintf(GTestColor color, const char* fmt, ...);
+}
+}
+#define PRINTF(...)                                                                        \
+    do                                                                                     \
+    {                                                                                      \
+        testing::internal::ColoredPrintf(testing::internal::COLOR_GREEN, "[          ] "); \
+        testing::internal::ColoredPrintf(testing::internal::COLOR_YELLOW, __VA_ARGS__);    \
+    } while (0)
+
+// C++ stream interface
+class TestCout : public std::stringstream
+{
+public:
+    ~TestCout()
+    {
+        PRINTF("%s\n", str().c_str());
+    }
+};
+
+#define TEST_COUT TestCout()
+
+//////////////////////////////////////////////
+
+using namespace exotica;
+
+#define NUM_BENCHMARK_ITERATIONS 100
+#define CHECK_MARGIN 0.1
+#define ACCURACY_MARGIN 0.2
+#define SDF_TOLERANCE 0.04  // Twice the default voxel size
+
+ScenePtr CreateScene(int num_world_objects, const std::string& collision_scene = "CollisionSceneFCLLatest")
+{
+    Initializer scene("Scene", {{"Name", std::string("CollisionTestScene")},
+                                {"JointGroup", std::string("arm")},
+                                {"URDF", std::string("{exotica_examples}/resources/robots/lwr_simplified.urdf")},
+                                {"SRDF", std::string("{exotica_examples}/resources/robots/lwr_simplified.srdf")},
+                                {"CollisionScene", collision_scene},
+                                {"AlwaysUpdateCollisionScene", true}});
+    ScenePtr ret = Setup::CreateScene(scene);
+
+    // Scatter small boxes through the workspace of the arm
+    std::srand(0);
+    for (int i = 0; i < num_world_objects; ++i)
+    {
+        const Eigen::Vector3d p = Eigen::Vector3d::Random().cwiseProduct(Eigen::Vector3d(1.0, 1.0, 0.75)) + Eigen::Vector3d(0.0, 0.0, 0.75);
+        ret->AddObject("Box" + std::to_string(i), KDL::Frame(KDL::Vector(p(0), p(1), p(2))), "", shapes::ShapeConstPtr(new shapes::Box(0.05, 0.05, 0.05)), KDL::RigidBodyInertia::Zero(), Eigen::Vector4d(0.5, 0.5, 0.5, 1.0), false);
+    }
+    ret->UpdateCollisionObjects();
+    return ret;
+}
+
+bool HasMatchingProxy(const CollisionProxy& proxy, const std::vector<CollisionProxy>& proxies)
+{
+    for (const CollisionProxy& other : proxies)
+    {
+        const std::string& a1 = proxy.e1->segment.getName();
+        const std::string& a2 = proxy.e2->segment.getName();
+        const std::string& b1 = other.e1->segment.getName();
+        const std::string& b2 = other.e2->segment.getName();
+        const bool same_pair = (a1 == b1 && a2 == b2) || (a1 == b2 && a2 == b1);
+        if (same_pair && std::abs(proxy.distance - other.distance) < 1e-6) return true;
+    }
+    return false;
+}
+
+void TestRobotToWorldCollisionDistance(int num_world_objects, bool check_reference)
+{
+    ScenePtr scene = CreateScene(num_world_objects);
+    const CollisionScenePtr& collision_scene = scene->GetCollisionScene();
+    std::vector<Eigen::VectorXd> states(NUM_BENCHMARK_ITERATIONS);
+    for (Eigen::VectorXd& x : states) x = scene->GetKinematicTree().GetRandomControlledState();
+
+    if (check_reference)
+    {
+        for (const Eigen::VectorXd& x : states)
+        {
+            scene->Update(x);
+            const std::vector<CollisionProxy> proxies = collision_scene->GetRobotToWorldCollisionDistance(CHECK_MARGIN);
+            // The reference evaluates every robot-world pair allowed to collide
+            const std::vector<CollisionProxy> reference = collision_scene->GetCollisionDistance(false);
+            for (const CollisionProxy& proxy : reference)
+            {
+                if (proxy.distance < CHECK_MARGIN) ASSERT_TRUE(HasMatchingProxy(proxy, proxies)) << "Missing " << proxy.Print();
+            }
+            for (const CollisionProxy& proxy : proxies) ASSERT_TRUE(HasMatchingProxy(proxy, reference)) << "Unexpected " << proxy.Print();
+        }
+    }
+
+    double duration = 0.0;
+    std::size_t num_proxies = 0;
+    for (const Eigen::VectorXd& x : states)
+    {
+        scene->Update(x);
+        Timer timer;
+        num_proxies += collision_scene->GetRobotToWorldCollisionDistance(CHECK_MARGIN).size();
+        duration += timer.GetDuration();
+    }
+    TEST_COUT << num_world_objects << " world objects: " << duration / NUM_BENCHMARK_ITERATIONS * 1e6 << "us per robot-to-world query, " << static_cast<double>(num_proxies) / NUM_BENCHMARK_ITERATIONS << " proxies on average";
+}
+
+TEST(ExoticaCollisionScene, RobotToWorldDistance10)
+{
+    try
+    {
+        TestRobotToWorldCollisionDistance(10, true);
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaCollisionScene, RobotToWorldDistance1000)
+{
+    try
+    {
+        TestRobotToWorldCollisionDistance(1000, true);
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaCollisionScene, RobotToWorldDistance10000)
+{
+    try
+    {
+        TestRobotToWorldCollisionDistance(10000, false);
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaCollisionScene, IncrementalUpdateMatchesRebuild)
+{
+    try
+    {
+        ScenePtr scene = CreateScene(100);
+        for (int i = 0; i < 100; i += 2) scene->RemoveObject("Box" + std::to_string(i));
+        scene->AttachObject("Box1", "lwr_arm_6_link");
+        scene->AttachObject("Box3", "lwr_arm_4_link");
+        scene->DetachObject("Box3");
+
+        // The clone builds its collision scene from scratch
+        ScenePtr reference = scene->Clone();
+        for (int i = 0; i < NUM_BENCHMARK_ITERATIONS; ++i)
+        {
+            const Eigen::VectorXd x = scene->GetKinematicTree().GetRandomControlledState();
+            scene->Update(x);
+            reference->Update(x);
+            ASSERT_EQ(scene->GetCollisionScene()->IsStateValid(true), reference->GetCollisionScene()->IsStateValid(true));
+            const std::vector<CollisionProxy> proxies = scene->GetCollisionScene()->GetRobotToWorldCollisionDistance(CHECK_MARGIN);
+            const std::vector<CollisionProxy> reference_proxies = reference->GetCollisionScene()->GetRobotToWorldCollisionDistance(CHECK_MARGIN);
+            ASSERT_EQ(proxies.size(), reference_proxies.size());
+            for (const CollisionProxy& proxy : proxies) ASSERT_TRUE(HasMatchingProxy(proxy, reference_proxies)) << "Unexpected " << proxy.Print();
+        }
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+// Closest distance of each robot collision element to the world
+std::map<std::string, double> GetClosestDistances(const std::vector<CollisionProxy>& proxies)
+{
+    std::map<std::string, double> distances;
+    for (const CollisionProxy& proxy : proxies)
+    {
+        auto it = distances.emplace(proxy.e1->segment.getName(), proxy.distance).first;
+        it->second = std::min(it->second, proxy.distance);
+    }
+    return distances;
+}
+
+void CompareSignedDistanceFieldToFCL(int num_world_objects)
+{
+    ScenePtr fcl = CreateScene(num_world_objects, "CollisionSceneFCLLatest");
+    ScenePtr sdf = CreateScene(num_world_objects, "CollisionSceneSDF");
+    std::vector<Eigen::VectorXd> states(NUM_BENCHMARK_ITERATIONS);
+    for (Eigen::VectorXd& x : states) x = fcl->GetKinematicTree().GetRandomControlledState();
+
+    // The first update voxelises the world
+    Timer timer;
+    sdf->Update(states[0]);
+    const double field_time = timer.GetDuration();
+
+    double fcl_time = 0.0, sdf_time = 0.0, error = 0.0;
+    int num_compared = 0;
+    for (const Eigen::VectorXd& x : states)
+    {
+        fcl->Update(x);
+        sdf->Update(x);
+        timer.Reset();
+        const std::vector<CollisionProxy> fcl_proxies = fcl->GetCollisionScene()->GetRobotToWorldCollisionDistance(ACCURACY_MARGIN);
+        fcl_time += timer.GetDuration();
+        timer.Reset();
+        // The field may overestimate a distance by up to SDF_TOLERANCE, so links just inside the margin for FCL must still be reported
+        const std::vector<CollisionProxy> sdf_proxies = sdf->GetCollisionScene()->GetRobotToWorldCollisionDistance(ACCURACY_MARGIN + SDF_TOLERANCE);
+        sdf_time += timer.GetDuration();
+
+        // The capsules enclose the links, so the field may underestimate the distance but only overestimate it by the voxelisation error
+        const std::map<std::string, double> sdf_distances = GetClosestDistances(sdf_proxies);
+        for (const auto& it : GetClosestDistances(fcl_proxies))
+        {
+            if (it.second > ACCURACY_MARGIN) continue;
+            auto sdf_it = sdf_distances.find(it.first);
+            ASSERT_TRUE(sdf_it != sdf_distances.end()) << "No distance for " << it.first;
+            EXPECT_LT(sdf_it->second, it.second + SDF_TOLERANCE) << it.first;
+            error += std::abs(sdf_it->second - it.second);
+            ++num_compared;
+        }
+    }
+    TEST_COUT << num_world_objects << " world objects: field computed in " << field_time << "s, robot-to-world query FCL " << fcl_time / NUM_BENCHMARK_ITERATIONS * 1e6 << "us, SDF " << sdf_time / NUM_BENCHMARK_ITERATIONS * 1e6 << "us, mean absolute error " << (num_compared > 0 ? error / num_compared : 0.0) << "m over " << num_compared << " links";
+}
+
+TEST(ExoticaCollisionScene, SignedDistanceFieldAgainstFCL)
+{
+    try
+    {
+        CompareSignedDistanceFieldToFCL(10);
+        CompareSignedDistanceFieldToFCL(1000);
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+// Earliest contact along one segment using pairwise continuous collision checks
+ContinuousCollisionProxy GetEarliestContact(ScenePtr scene, Eigen::VectorXdRefConst x_beg, Eigen::VectorXdRefConst x_end)
+{
+    const CollisionScenePtr& collision_scene = scene->GetCollisionScene();
+    const std::vector<std::string> robot_links = collision_scene->GetCollisionRobotLinks();
+    std::vector<std::string> links = robot_links;
+    for (const std::string& link : collision_scene->GetCollisionWorldLinks()) links.push_back(link);
+
+    std::map<std::string, KDL::Frame> tf_beg, tf_end;
+    scene->Update(x_beg);
+    for (const std::string& link : links) tf_beg[link] = scene->GetKinematicTree().FK(link, KDL::Frame(), "", KDL::Frame());
+    scene->Update(x_end);
+    for (const std::string& link : links) tf_end[link] = scene->GetKinematicTree().FK(link, KDL::Frame(), "", KDL::Frame());
+
+    ContinuousCollisionProxy earliest;
+    earliest.time_of_contact = 1.0;
+    for (std::size_t i = 0; i < robot_links.size(); ++i)
+    {
+        for (std::size_t j = i + 1; j < links.size(); ++j)
+        {
+            const std::string& o1 = robot_links[i];
+            const std::string& o2 = links[j];
+            if (!collision_scene->IsAllowedToCollide(o1, o2, true)) continue;
+            const ContinuousCollisionProxy proxy = collision_scene->ContinuousCollisionCheck(o1, tf_beg[o1], tf_end[o1], o2, tf_beg[o2], tf_end[o2]);
+            if (proxy.in_collision && (!earliest.in_collision || proxy.time_of_contact < earliest.time_of_contact)) earliest = proxy;
+        }
+    }
+    return earliest;
+}
+
+TEST(ExoticaCollisionScene, ContinuousCollisionCheckTrajectory)
+{
+    try
+    {
+        ScenePtr scene = CreateScene(20);
+        const CollisionScenePtr& collision_scene = scene->GetCollisionScene();
+
+        // Linear interpolation between random configurations
+        const int num_segments = 5, num_waypoints_per_segment = 10;
+        Eigen::MatrixXd trajectory(num_segments * num_waypoints_per_segment + 1, scene->GetKinematicTree().GetNumControlledJoints());
+        Eigen::VectorXd x_beg = scene->GetKinematicTree().GetRandomControlledState();
+        trajectory.row(0) = x_beg.transpose();
+        for (int i = 0; i < num_segments; ++i)
+        {
+            const Eigen::VectorXd x_end = scene->GetKinematicTree().GetRandomControlledState();
+            for (int j = 1; j <= num_waypoints_per_segment; ++j)
+            {
+                trajectory.row(i * num_waypoints_per_segment + j) = (x_beg + (x_end - x_beg) * j / num_waypoints_per_segment).transpose();
+            }
+            x_beg = x_end;
+        }
+
+        const Eigen::VectorXd x_current = scene->GetKinematicTree().GetRandomControlledState();
+        scene->Update(x_current);
+        const std::vector<ContinuousCollisionProxy> proxies = collision_scene->ContinuousCollisionCheckTrajectory(trajectory);
+        ASSERT_EQ(proxies.size(), static_cast<std::size_t>(trajectory.rows() - 1));
+
+        // The query leaves the scene in its current state
+        EXPECT_TRUE(scene->GetKinematicTree().GetControlledState().isApprox(x_current));
+
+        int num_colliding = 0;
+        double reference_time = 0.0;
+        Timer timer;
+        for (int t = 0; t < trajectory.rows() - 1; ++t)
+        {
+            timer.Reset();
+            const ContinuousCollisionProxy reference = GetEarliestContact(scene, trajectory.row(t).transpose(), trajectory.row(t + 1).transpose());
+            reference_time += timer.GetDuration();
+            ASSERT_EQ(proxies[t].in_collision, reference.in_collision) << "Segment " << t << ": " << proxies[t].Print() << " vs " << reference.Print();
+            if (reference.in_collision)
+            {
+                EXPECT_NEAR(proxies[t].time_of_contact, reference.time_of_contact, 1e-3) << "Segment " << t;
+                ++num_colliding;
+            }
+        }
+
+        timer.Reset();
+        for (int i = 0; i < NUM_BENCHMARK_ITERATIONS; ++i) collision_scene->ContinuousCollisionCheckTrajectory(trajectory);
+        TEST_COUT << trajectory.rows() << " waypoints, " << num_colliding << " segments in collision: " << timer.GetDuration() / NUM_BENCHMARK_ITERATIONS * 1e3 << "ms per trajectory, " << reference_time * 1e3 << "ms checking pairs one segment at a time";
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaCollisionScene, ContinuousCollisionCheckTrajectoryLargeRotation)
+{
+    try
+    {
+        ScenePtr scene = CreateScene(0);
+        const CollisionScenePtr& collision_scene = scene->GetCollisionScene();
+
+        // Swing the horizontally stretched arm about the base in a single segment
+        Eigen::VectorXd x_mid = Eigen::VectorXd::Zero(scene->GetKinematicTree().GetNumControlledJoints());
+        x_mid(1) = M_PI_2;
+        Eigen::MatrixXd trajectory(2, x_mid.size());
+        trajectory.row(0) = x_mid.transpose();
+        trajectory.row(1) = x_mid.transpose();
+        trajectory(0, 0) = -1.4;
+        trajectory(1, 0) = 1.4;
+
+        // The obstacle is only hit halfway through the swing, outside the boxes around the links at both waypoints
+        scene->Update(x_mid);
+        const KDL::Frame obstacle = scene->GetKinematicTree().FK("lwr_arm_5_link", KDL::Frame(), "", KDL::Frame());
+        scene->AddObject("Obstacle", obstacle, "", shapes::ShapeConstPtr(new shapes::Box(0.1, 0.1, 0.1)), KDL::RigidBodyInertia::Zero(), Eigen::Vector4d(0.5, 0.5, 0.5, 1.0), false);
+        scene->UpdateCollisionObjects();
+
+        for (int t = 0; t < 2; ++t)
+        {
+            scene->Update(trajectory.row(t).transpose());
+            ASSERT_TRUE(collision_scene->IsStateValid(false)) << "Waypoint " << t << " is in collision";
+        }
+
+        const ContinuousCollisionProxy reference = GetEarliestContact(scene, trajectory.row(0).transpose(), trajectory.row(1).transpose());
+        ASSERT_TRUE(reference.in_collision);
+
+        const std::vector<ContinuousCollisionProxy> proxies = collision_scene->ContinuousCollisionCheckTrajectory(trajectory, false);
+        ASSERT_EQ(proxies.size(), 1u);
+        EXPECT_TRUE(proxies[0].in_collision) << "Contact missed by the broad phase";
+        EXPECT_NEAR(proxies[0].time_of_contact, reference.time_of_contact, 1e-3);
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    int ret = RUN_ALL_TESTS();
+    Setup::Destroy();
+    return ret;
+}
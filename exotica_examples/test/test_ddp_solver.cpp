@@ -0,0 +1,382 @@
+//
+// Copyright (c) 2018, University of Edinburgh
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+#include <exotica_core/exotica_core.h>
+#include <exotica_ddp_solver/control_limited_ddp_solver.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+// Extend testing printout //////////////////////
+
+namespace testing
+{
+namespace internal
+{
+enum GTestColor
+{
+    COLOR_DEFAULT,
+    COLOR_RED,
+    COLOR_GREEN,
+    COLOR_YELLOW
+};
+
+extern void ColoredPrintf(GTestColor color, const char* fmt, ...);
+}
+}
+#define PRINTF(...)                                                                        \
+    do                                                                                     \
+    {                                                                                      \
+        testing::internal::ColoredPrintf(testing::internal::COLOR_GREEN, "[          ] "); \
+        testing::internal::ColoredPrintf(testing::internal::COLOR_YELLOW, __VA_ARGS__);    \
+    } while (0)
+
+// C++ stream interface
+class TestCout : public std::stringstream
+{
+public:
+    ~TestCout()
+    {
+        PRINTF("%s\n", str().c_str());
+    }
+};
+
+#define TEST_COUT TestCout()
+
+//////////////////////////////////////////////
+
+// Count heap allocations by interposing the C allocator, which both Eigen and operator new use.
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t num, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+namespace
+{
+bool count_allocations = false;
+int number_of_allocations = 0;
+}  // namespace
+
+extern "C" void* malloc(size_t size)
+{
+    if (count_allocations) ++number_of_allocations;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t num, size_t size)
+{
+    if (count_allocations) ++number_of_allocations;
+    return __libc_calloc(num, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+    if (count_allocations) ++number_of_allocations;
+    return __libc_realloc(ptr, size);
+}
+
+using namespace exotica;
+
+#define NUM_BENCHMARK_DDP_ITERATIONS 10
+
+// Exposes the backward and forward pass and the last line-search step of the control-limited DDP solver.
+class ControlLimitedDDPSolverPasses : public ControlLimitedDDPSolver
+{
+public:
+    void RunBackwardPass() { BackwardPass(); }
+    double RunForwardPass(double alpha) { return ForwardPass(alpha, X_ref_, U_ref_); }
+    double GetStepSize() const { return alpha_best_; }
+};
+
+std::shared_ptr<AbstractDDPSolver> CreateCartpoleSolver(DynamicTimeIndexedShootingProblemPtr& problem, double mpc_time_budget = 0.0)
+{
+    Initializer solver_init, problem_init;
+    XMLLoader::Load("{exotica_examples}/resources/configs/dynamic_time_indexed/07_control_limited_ddp_cartpole.xml", solver_init, problem_init);
+    ControlLimitedDDPSolverInitializer parameters(solver_init);
+    parameters.Debug = false;
+    parameters.MPCTimeBudget = mpc_time_budget;
+    std::shared_ptr<AbstractDDPSolver> solver = std::dynamic_pointer_cast<AbstractDDPSolver>(Setup::CreateSolver(Initializer(parameters)));
+    if (!solver) ThrowPretty("Failed to create the DDP solver.");
+    problem = std::static_pointer_cast<DynamicTimeIndexedShootingProblem>(Setup::CreateProblem(problem_init));
+    solver->SpecifyProblem(problem);
+    return solver;
+}
+
+TEST(ExoticaDDPSolver, RecedingHorizonWarmStart)
+{
+    try
+    {
+        DynamicTimeIndexedShootingProblemPtr problem;
+        std::shared_ptr<AbstractDDPSolver> solver = CreateCartpoleSolver(problem);
+        const DynamicsSolverPtr& dynamics_solver = problem->GetScene()->GetDynamicsSolver();
+        const int T = problem->get_T();
+        const double dt = dynamics_solver->get_dt();
+
+        Eigen::MatrixXd solution;
+        solver->Solve(solution);
+        solver->SetNumberOfMaxIterations(3);
+
+        std::srand(0);
+        for (int step = 0; step < 5; ++step)
+        {
+            const Eigen::MatrixXd X_prev = problem->get_X();
+            const Eigen::MatrixXd U_prev = problem->get_U();
+            const std::vector<Eigen::MatrixXd> K_prev = solver->get_K_gains();
+
+            // The measured state deviates from the predicted one
+            const Eigen::VectorXd x0 = X_prev.col(1) + 1e-3 * Eigen::VectorXd::Random(X_prev.rows());
+
+            // Expected warm start: the shifted controls, corrected by the shifted feedback gains around the shifted states
+            problem->set_X(x0, 0);
+            double expected_cost = 0.0;
+            Eigen::VectorXd u0;
+            for (int t = 0; t < T - 1; ++t)
+            {
+                const int shifted = std::min(t + 1, T - 2);
+                const Eigen::VectorXd u = U_prev.col(shifted) + K_prev[shifted] * dynamics_solver->StateDelta(problem->get_X(t), X_prev.col(t + 1));
+                if (t == 0) u0 = u;
+                problem->Update(u, t);
+                expected_cost += dt * (problem->GetControlCost(t) + problem->GetStateCost(t));
+            }
+            expected_cost += problem->GetStateCost(T - 1);
+            ASSERT_FALSE(u0.isApprox(U_prev.col(1))) << "The perturbation is too small to test the feedback";
+
+            solver->SolveMPC(x0, solution);
+            ASSERT_EQ(solution.rows(), T - 1);
+            EXPECT_NEAR(problem->GetCostEvolution(0), expected_cost, 1e-9 * std::max(1.0, std::abs(expected_cost))) << "Step " << step;
+            EXPECT_TRUE(problem->get_X(0).isApprox(x0));
+            EXPECT_TRUE(solution.allFinite());
+            for (int i = 0; i < problem->GetNumberOfIterations(); ++i) EXPECT_TRUE(std::isfinite(problem->GetCostEvolution(i))) << "Step " << step << ", iteration " << i;
+            EXPECT_NE(problem->termination_criterion, TerminationCriterion::Divergence);
+        }
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaDDPSolver, RecedingHorizonTimeBudget)
+{
+    try
+    {
+        Eigen::MatrixXd solution;
+
+        // A budget shorter than one iteration allows exactly one
+        DynamicTimeIndexedShootingProblemPtr problem;
+        std::shared_ptr<AbstractDDPSolver> solver = CreateCartpoleSolver(problem, 1e-9);
+        solver->Solve(solution);
+        solver->SetNumberOfMaxIterations(100);
+        solver->SolveMPC(problem->get_X(1), solution);
+        EXPECT_EQ(problem->GetNumberOfIterations(), 2);  // Initial roll-out and one iteration
+        EXPECT_EQ(problem->termination_criterion, TerminationCriterion::IterationLimit);
+        const double iteration_time = solver->GetPlanningTime();
+
+        // Otherwise the solve ends before an iteration would exceed the budget
+        const double budget = 10.0 * iteration_time;
+        solver = CreateCartpoleSolver(problem, budget);
+        solver->Solve(solution);
+        solver->SetNumberOfMaxIterations(1000);
+        for (int step = 0; step < 5; ++step)
+        {
+            solver->SolveMPC(problem->get_X(1), solution);
+            EXPECT_LE(solver->GetPlanningTime(), budget + 2.0 * iteration_time) << "Step " << step;
+        }
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaDDPSolver, PassesDoNotAllocate)
+{
+    try
+    {
+        Initializer solver_init, problem_init;
+        XMLLoader::Load("{exotica_examples}/resources/configs/dynamic_time_indexed/07_control_limited_ddp_cartpole.xml", solver_init, problem_init);
+        ControlLimitedDDPSolverInitializer parameters(solver_init);
+        parameters.Debug = false;
+        std::shared_ptr<ControlLimitedDDPSolverPasses> solver = std::make_shared<ControlLimitedDDPSolverPasses>();
+        solver->InstantiateInternal(Initializer(parameters));
+        DynamicTimeIndexedShootingProblemPtr problem = std::static_pointer_cast<DynamicTimeIndexedShootingProblem>(Setup::CreateProblem(problem_init));
+        solver->SpecifyProblem(problem);
+        solver->SetNumberOfMaxIterations(5);
+
+        Eigen::MatrixXd solution;
+        solver->Solve(solution);
+        solver->RunBackwardPass();
+        solver->RunForwardPass(0.5);
+
+        number_of_allocations = 0;
+        count_allocations = true;
+        solver->RunBackwardPass();
+        count_allocations = false;
+        EXPECT_EQ(number_of_allocations, 0) << "The backward pass allocates";
+
+        // The forward pass may only allocate within the Update of the problem (e.g. in the simulation and the scene update)
+        const Eigen::MatrixXd U = problem->get_U();
+        number_of_allocations = 0;
+        count_allocations = true;
+        for (int t = 0; t < problem->get_T() - 1; ++t) problem->Update(U.col(t), t);
+        count_allocations = false;
+        const int number_of_problem_update_allocations = number_of_allocations;
+
+        number_of_allocations = 0;
+        count_allocations = true;
+        const double cost = solver->RunForwardPass(0.5);
+        count_allocations = false;
+        EXPECT_EQ(number_of_allocations, number_of_problem_update_allocations) << "The forward pass allocates outside of the problem Update";
+        EXPECT_TRUE(std::isfinite(cost));
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaDDPSolver, ParallelLineSearchMatchesSerial)
+{
+    try
+    {
+        Initializer solver_init, problem_init;
+        XMLLoader::Load("{exotica_examples}/resources/configs/dynamic_time_indexed/07_control_limited_ddp_cartpole.xml", solver_init, problem_init);
+
+        // Batches which split the 11 step sizes unevenly, and more threads than step sizes
+        Eigen::MatrixXd serial_solution;
+        std::vector<double> serial_costs;
+        double serial_step_size = 0.0;
+        for (const int num_threads : {1, 2, 4, 16})
+        {
+            ControlLimitedDDPSolverInitializer parameters(solver_init);
+            parameters.Debug = false;
+            parameters.NumThreadsLineSearch = num_threads;
+            std::shared_ptr<ControlLimitedDDPSolverPasses> solver = std::make_shared<ControlLimitedDDPSolverPasses>();
+            solver->InstantiateInternal(Initializer(parameters));
+            DynamicTimeIndexedShootingProblemPtr problem = std::static_pointer_cast<DynamicTimeIndexedShootingProblem>(Setup::CreateProblem(problem_init));
+            solver->SpecifyProblem(problem);
+            solver->SetNumberOfMaxIterations(20);
+
+            Eigen::MatrixXd solution;
+            solver->Solve(solution);
+            std::vector<double> costs(problem->GetNumberOfIterations());
+            for (int i = 0; i < problem->GetNumberOfIterations(); ++i) costs[i] = problem->GetCostEvolution(i);
+
+            if (num_threads == 1)
+            {
+                serial_solution = solution;
+                serial_costs = costs;
+                serial_step_size = solver->GetStepSize();
+                continue;
+            }
+
+            // Every thread count evaluates the same rollouts, so the accepted steps and costs of all iterations match
+            ASSERT_EQ(costs.size(), serial_costs.size()) << num_threads << " threads";
+            for (std::size_t i = 0; i < costs.size(); ++i) EXPECT_DOUBLE_EQ(costs[i], serial_costs[i]) << num_threads << " threads, iteration " << i;
+            EXPECT_EQ(solver->GetStepSize(), serial_step_size) << num_threads << " threads";
+            EXPECT_TRUE(solution.isApprox(serial_solution)) << num_threads << " threads";
+        }
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+// Times the derivatives of one backward pass on the cartpole (automatic differentiation) and on the LWR with Pinocchio
+// dynamics, through the fused ComputeDerivatives call and through separate fx and fu calls on the same dynamics solver.
+// The cache is cleared before every call, so each separate call runs the full derivative computation as it did before.
+TEST(ExoticaDDPSolver, FusedDerivativesIterationTime)
+{
+    try
+    {
+        for (const std::string& config : {std::string("07_control_limited_ddp_cartpole.xml"), std::string("02_lwr_task_maps.xml")})
+        {
+            Initializer solver_init, problem_init;
+            XMLLoader::Load("{exotica_examples}/resources/configs/dynamic_time_indexed/" + config, solver_init, problem_init);
+            std::shared_ptr<AbstractDDPSolver> solver = std::dynamic_pointer_cast<AbstractDDPSolver>(Setup::CreateSolver(solver_init));
+            ASSERT_TRUE(solver != nullptr);
+            solver->debug_ = false;
+            solver->SetNumberOfMaxIterations(NUM_BENCHMARK_DDP_ITERATIONS);
+            DynamicTimeIndexedShootingProblemPtr problem = std::static_pointer_cast<DynamicTimeIndexedShootingProblem>(Setup::CreateProblem(problem_init));
+            solver->SpecifyProblem(problem);
+
+            Eigen::MatrixXd solution;
+            Timer timer;
+            solver->Solve(solution);
+            const double time_per_iteration = timer.GetDuration() / std::max(problem->GetNumberOfIterations(), 1);
+
+            const DynamicsSolverPtr dynamics_solver = problem->GetScene()->GetDynamicsSolver();
+            const int T = problem->get_T();
+            Eigen::MatrixXd fx, fu;
+            double time_fused = 0.0, time_separate = 0.0;
+            for (int pass = 0; pass < NUM_BENCHMARK_DDP_ITERATIONS; ++pass)
+            {
+                timer.Reset();
+                for (int t = 0; t < T - 1; ++t)
+                {
+                    dynamics_solver->ClearDerivativeCache();
+                    dynamics_solver->ComputeDerivatives(problem->get_X(t), problem->get_U(t));
+                    fx = dynamics_solver->get_fx();
+                    fu = dynamics_solver->get_fu();
+                }
+                time_fused += timer.GetDuration();
+
+                timer.Reset();
+                for (int t = 0; t < T - 1; ++t)
+                {
+                    dynamics_solver->ClearDerivativeCache();
+                    fx = dynamics_solver->fx(problem->get_X(t), problem->get_U(t));
+                    dynamics_solver->ClearDerivativeCache();
+                    fu = dynamics_solver->fu(problem->get_X(t), problem->get_U(t));
+                }
+                time_separate += timer.GetDuration();
+            }
+            time_fused /= NUM_BENCHMARK_DDP_ITERATIONS;
+            time_separate /= NUM_BENCHMARK_DDP_ITERATIONS;
+
+            TEST_COUT << config << ": " << time_per_iteration * 1e3 << " ms per iteration. Derivatives per backward pass: " << time_fused * 1e3 << " ms fused, "
+                      << time_separate * 1e3 << " ms with separate fx and fu (" << 100.0 * (time_separate - time_fused) / time_per_iteration << "% of an iteration)";
+            EXPECT_LE(time_fused, time_separate) << config;
+        }
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    int ret = RUN_ALL_TESTS();
+    Setup::Destroy();
+    return ret;
+}
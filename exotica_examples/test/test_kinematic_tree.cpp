@@ -0,0 +1,509 @@
+//
+// Copyright (c) 2018, University of Edinburgh
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <exotica_core/exotica_core.h>
+#include <gtest/gtest.h>
+
+#include <queue>
+
+// Extend testing printout //////////////////////
+
+namespace testing
+{
+namespace internal
+{
+enum GTestColor
+{
+    COLOR_DEFAULT,
+    COLOR_RED,
+    COLOR_GREEN,
+    COLOR_YELLOW
+};
+
+extern void ColoredPrintf(GTestColor color, const char* fmt, ...);
+}
+}
+#define PRINTF(...)                                                                        \
+    do                                                                                     \
+    {                                                                                      \
+        testing::internal::ColoredPrintf(testing::internal::COLOR_GREEN, "[          ] "); \
+        testing::internal::ColoredPrintf(testing::internal::COLOR_YELLOW, __VA_ARGS__);    \
+    } while (0)
+
+// C++ stream interface
+class TestCout : public std::stringstream
+{
+public:
+    ~TestCout()
+    {
+        PRINTF("%s\n", str().c_str());
+    }
+};
+
+#define TEST_COUT TestCout()
+
+//////////////////////////////////////////////
+
+using namespace exotica;
+
+#define NUM_TRIALS 100
+#define NUM_BENCHMARK_ITERATIONS 10000
+
+ScenePtr CreateScene(const std::string& robot, const std::string& joint_group)
+{
+    TEST_COUT << "Creating scene for " << robot << " with joint group " << joint_group;
+    Initializer scene("Scene", {{"Name", std::string("KinematicTreeTestScene")},
+                                {"JointGroup", joint_group},
+                                {"URDF", "{exotica_examples}/resources/robots/" + robot + ".urdf"},
+                                {"SRDF", "{exotica_examples}/resources/robots/" + robot + ".srdf"}});
+    ScenePtr ret = Setup::CreateScene(scene);
+    // An empty request makes KinematicTree::Update only perform the forward pass over the tree.
+    ret->GetKinematicTree().RequestFrames(KinematicsRequest());
+    return ret;
+}
+
+// Queue-based breadth-first traversal of the KinematicElement graph. This is
+// the forward pass KinematicTree::UpdateTree used before the tree was
+// flattened and serves as a reference and benchmark baseline.
+class ReferenceTreeUpdate
+{
+public:
+    ReferenceTreeUpdate(const KinematicTree& tree) : root_(tree.GetTree()[0].lock()), tree_state_(Eigen::VectorXd::Zero(tree.GetTree().size()))
+    {
+    }
+
+    void SetState(const KinematicTree& tree)
+    {
+        const Eigen::VectorXd model_state = tree.GetModelState();
+        const std::vector<std::string>& names = tree.GetModelJointNames();
+        for (int i = 0; i < names.size(); ++i)
+        {
+            tree_state_(tree.GetModelJointsMap().at(names[i]).lock()->id) = model_state(i);
+        }
+    }
+
+    void Update()
+    {
+        std::queue<std::shared_ptr<KinematicElement>> elements;
+        elements.push(root_);
+        root_->RemoveExpiredChildren();
+        while (elements.size() > 0)
+        {
+            auto element = elements.front();
+            elements.pop();
+            if (element->id > -1)
+            {
+                if (element->segment.getJoint().getType() != KDL::Joint::JointType::None)
+                {
+                    element->frame = element->parent.lock()->frame * element->GetPose(tree_state_(element->id));
+                }
+                else
+                {
+                    element->frame = element->parent.lock()->frame * element->GetPose();
+                }
+            }
+            else
+            {
+                element->frame = element->GetPose();
+            }
+            element->RemoveExpiredChildren();
+            for (std::weak_ptr<KinematicElement> child : element->children)
+            {
+                elements.push(child.lock());
+            }
+        }
+    }
+
+    // Jacobian of frame A relative to frame B, walking both chains up to the root.
+    // This is how KinematicTree::ComputeJ used to assemble the Jacobian.
+    Eigen::MatrixXd Jacobian(std::shared_ptr<KinematicElement> frame_A, std::shared_ptr<KinematicElement> frame_B, int num_controlled_joints) const
+    {
+        KDL::Jacobian jacobian(num_controlled_joints);
+        jacobian.data.setZero();
+        std::shared_ptr<KinematicElement> it = frame_A;
+        while (it != nullptr)
+        {
+            if (it->is_controlled)
+            {
+                KDL::Frame segment_reference;
+                if (it->parent.lock() != nullptr) segment_reference = it->parent.lock()->frame;
+                jacobian.setColumn(it->control_id, frame_B->frame.M.Inverse() * (segment_reference.M * it->segment.twist(tree_state_(it->id), 1.0)).RefPoint(frame_A->frame.p - it->frame.p));
+            }
+            it = it->parent.lock();
+        }
+        it = frame_B;
+        while (it != nullptr)
+        {
+            if (it->is_controlled)
+            {
+                KDL::Frame segment_reference;
+                if (it->parent.lock() != nullptr) segment_reference = it->parent.lock()->frame;
+                jacobian.setColumn(it->control_id, jacobian.getColumn(it->control_id) - (frame_B->frame.M.Inverse() * (segment_reference.M * it->segment.twist(tree_state_(it->id), 1.0)).RefPoint(frame_A->frame.p - it->frame.p)));
+            }
+            it = it->parent.lock();
+        }
+        return jacobian.data;
+    }
+
+private:
+    std::shared_ptr<KinematicElement> root_;
+    Eigen::VectorXd tree_state_;
+};
+
+std::vector<KDL::Frame> GetFrames(const KinematicTree& tree)
+{
+    std::vector<KDL::Frame> frames;
+    for (const auto& element : tree.GetTree()) frames.push_back(element.lock()->frame);
+    return frames;
+}
+
+void TestForwardPass(ScenePtr scene, double eps = 1e-10)
+{
+    KinematicTree& tree = scene->GetKinematicTree();
+    ReferenceTreeUpdate reference(tree);
+    for (int trial = 0; trial < NUM_TRIALS; ++trial)
+    {
+        Eigen::VectorXd x = Eigen::VectorXd::Random(tree.GetNumControlledJoints());
+        tree.Update(x);
+        std::vector<KDL::Frame> frames = GetFrames(tree);
+
+        reference.SetState(tree);
+        reference.Update();
+        std::vector<KDL::Frame> expected_frames = GetFrames(tree);
+
+        ASSERT_EQ(frames.size(), expected_frames.size());
+        for (int i = 0; i < frames.size(); ++i)
+        {
+            if (!KDL::Equal(frames[i], expected_frames[i], eps))
+            {
+                ADD_FAILURE() << "Frame of '" << tree.GetTree()[i].lock()->segment.getName() << "' does not match the reference traversal.";
+                return;
+            }
+        }
+    }
+}
+
+void BenchmarkForwardPass(ScenePtr scene)
+{
+    KinematicTree& tree = scene->GetKinematicTree();
+    ReferenceTreeUpdate reference(tree);
+    const Eigen::VectorXd x = Eigen::VectorXd::Random(tree.GetNumControlledJoints());
+    tree.Update(x);
+    reference.SetState(tree);
+
+    Timer timer;
+    for (int i = 0; i < NUM_BENCHMARK_ITERATIONS; ++i) reference.Update();
+    const double reference_time = timer.GetDuration();
+
+    // Alternate between two states, updating with an unchanged state would skip the forward pass.
+    const Eigen::VectorXd x_other = Eigen::VectorXd::Random(tree.GetNumControlledJoints());
+    timer.Reset();
+    for (int i = 0; i < NUM_BENCHMARK_ITERATIONS; ++i) tree.Update(i % 2 == 0 ? x_other : x);
+    const double flat_time = timer.GetDuration();
+
+    TEST_COUT << tree.GetTree().size() << " elements, " << tree.GetNumControlledJoints() << " controlled joints: queue-based traversal " << reference_time / NUM_BENCHMARK_ITERATIONS * 1e6 << "us, flat tree " << flat_time / NUM_BENCHMARK_ITERATIONS * 1e6 << "us (" << reference_time / flat_time << "x)";
+}
+
+// Perturbs one joint at a time and checks that only the affected subtrees and
+// frames are recomputed while the results still match a full update.
+void TestIncrementalUpdate(ScenePtr scene, double eps = 1e-10)
+{
+    KinematicTree& tree = scene->GetKinematicTree();
+    KinematicsRequest request;
+    request.flags = KIN_FK | KIN_J;
+    for (const auto& element : tree.GetModelTree()) request.frames.push_back(KinematicFrameRequest(element->segment.getName()));
+    std::shared_ptr<KinematicResponse> response = tree.RequestFrames(request);
+
+    ReferenceTreeUpdate reference(tree);
+    Eigen::VectorXd x = Eigen::VectorXd::Random(tree.GetNumControlledJoints());
+    tree.Update(x);
+    const std::size_t num_elements = tree.GetTree().size();
+
+    std::size_t recomputed_segments = 0;
+    for (int joint = 0; joint < x.rows(); ++joint)
+    {
+        x(joint) += 0.1;
+        tree.ResetRecomputedSegmentCount();
+        tree.Update(x);
+        ASSERT_LT(tree.GetRecomputedSegmentCount(), num_elements);
+        recomputed_segments += tree.GetRecomputedSegmentCount();
+
+        std::vector<KDL::Frame> frames = GetFrames(tree);
+        reference.SetState(tree);
+        reference.Update();
+        std::vector<KDL::Frame> expected_frames = GetFrames(tree);
+        for (int i = 0; i < frames.size(); ++i)
+        {
+            ASSERT_TRUE(KDL::Equal(frames[i], expected_frames[i], eps)) << "Frame of '" << tree.GetTree()[i].lock()->segment.getName() << "' does not match the reference traversal.";
+        }
+
+        for (int i = 0; i < request.frames.size(); ++i)
+        {
+            ASSERT_TRUE(KDL::Equal(response->Phi(i), tree.FK(request.frames[i].frame_A_link_name, KDL::Frame(), "", KDL::Frame()), eps)) << "FK of '" << request.frames[i].frame_A_link_name << "' is stale.";
+            ASSERT_TRUE(response->jacobian(i).data.isApprox(tree.Jacobian(request.frames[i].frame_A_link_name, KDL::Frame(), "", KDL::Frame()))) << "Jacobian of '" << request.frames[i].frame_A_link_name << "' is stale.";
+        }
+    }
+
+    // Nothing moves if the state does not change.
+    tree.ResetRecomputedSegmentCount();
+    tree.Update(x);
+    EXPECT_EQ(tree.GetRecomputedSegmentCount(), 0);
+
+    TEST_COUT << num_elements << " elements, " << x.rows() << " single joint updates: recomputed " << recomputed_segments << " segments instead of " << num_elements * x.rows() << " (" << 100.0 * recomputed_segments / (num_elements * x.rows()) << "%)";
+}
+
+// Requests Jacobians of random links relative to other random links so that
+// the chains share common ancestors.
+void TestJacobianChains(ScenePtr scene, double eps = 1e-10)
+{
+    KinematicTree& tree = scene->GetKinematicTree();
+    const std::vector<std::shared_ptr<KinematicElement>>& links = tree.GetModelTree();
+    KinematicsRequest request;
+    request.flags = KIN_FK | KIN_J;
+    for (int i = 0; i < NUM_TRIALS; ++i)
+    {
+        request.frames.push_back(KinematicFrameRequest(links[rand() % links.size()]->segment.getName(), KDL::Frame(), links[rand() % links.size()]->segment.getName()));
+    }
+    std::shared_ptr<KinematicResponse> response = tree.RequestFrames(request);
+
+    ReferenceTreeUpdate reference(tree);
+    tree.Update(Eigen::VectorXd::Random(tree.GetNumControlledJoints()));
+    reference.SetState(tree);
+    for (int i = 0; i < request.frames.size(); ++i)
+    {
+        const Eigen::MatrixXd expected_jacobian = reference.Jacobian(tree.GetTreeMap().at(request.frames[i].frame_A_link_name).lock(), tree.GetTreeMap().at(request.frames[i].frame_B_link_name).lock(), tree.GetNumControlledJoints());
+        ASSERT_LT((response->jacobian(i).data - expected_jacobian).norm(), eps) << "Jacobian of '" << request.frames[i].frame_A_link_name << "' relative to '" << request.frames[i].frame_B_link_name << "' does not match the reference.";
+    }
+}
+
+// Times UpdateJ as the difference between updates with and without KIN_J.
+void BenchmarkJacobian(ScenePtr scene, int num_frames)
+{
+    KinematicTree& tree = scene->GetKinematicTree();
+    const std::vector<std::shared_ptr<KinematicElement>>& links = tree.GetModelTree();
+    KinematicsRequest request;
+    for (int i = 0; i < num_frames; ++i) request.frames.push_back(KinematicFrameRequest(links[links.size() - 1 - i % links.size()]->segment.getName()));
+
+    const Eigen::VectorXd x = Eigen::VectorXd::Random(tree.GetNumControlledJoints());
+    const Eigen::VectorXd x_other = Eigen::VectorXd::Random(tree.GetNumControlledJoints());
+    const int iterations = NUM_BENCHMARK_ITERATIONS / num_frames;
+    Timer timer;
+
+    // Alternate between two states so that all frames are updated.
+    request.flags = KIN_FK;
+    tree.RequestFrames(request);
+    timer.Reset();
+    for (int i = 0; i < iterations; ++i) tree.Update(i % 2 == 0 ? x_other : x);
+    const double fk_time = timer.GetDuration();
+
+    request.flags = KIN_FK | KIN_J;
+    tree.RequestFrames(request);
+    timer.Reset();
+    for (int i = 0; i < iterations; ++i) tree.Update(i % 2 == 0 ? x_other : x);
+    const double jacobian_time = timer.GetDuration() - fk_time;
+
+    ReferenceTreeUpdate reference(tree);
+    reference.SetState(tree);
+    std::vector<std::shared_ptr<KinematicElement>> frames;
+    for (const KinematicFrameRequest& frame : request.frames) frames.push_back(tree.GetTreeMap().at(frame.frame_A_link_name).lock());
+    std::shared_ptr<KinematicElement> root = tree.GetTree()[0].lock();
+    timer.Reset();
+    for (int i = 0; i < iterations; ++i)
+    {
+        for (const auto& frame : frames) reference.Jacobian(frame, root, tree.GetNumControlledJoints());
+    }
+    const double reference_time = timer.GetDuration();
+
+    TEST_COUT << num_frames << " frames: UpdateJ " << jacobian_time / iterations * 1e6 << "us, walking the chains " << reference_time / iterations * 1e6 << "us (" << reference_time / jacobian_time << "x)";
+}
+
+TEST(ExoticaKinematicTree, FlatTreeMatchesReferenceTraversal)
+{
+    try
+    {
+        TestForwardPass(CreateScene("lwr_simplified", "arm"));
+        TestForwardPass(CreateScene("valkyrie_sim", "whole_body"));
+        TestForwardPass(CreateScene("talos", "whole_body"));
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaKinematicTree, FlatTreeIsRecompiledWhenTheModelChanges)
+{
+    try
+    {
+        ScenePtr scene = CreateScene("valkyrie_sim", "whole_body");
+        scene->AddObject("TestFrame", KDL::Frame(KDL::Vector(0.1, 0.0, 0.0)), "leftPalm", shapes::ShapeConstPtr(nullptr));
+        TestForwardPass(scene);
+        scene->AttachObjectLocal("TestFrame", "rightPalm", KDL::Frame(KDL::Vector(0.0, 0.1, 0.0)));
+        TestForwardPass(scene);
+        scene->DetachObject("TestFrame");
+        TestForwardPass(scene);
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaKinematicTree, IncrementalUpdateOnlyRecomputesMovedSubtrees)
+{
+    try
+    {
+        TestIncrementalUpdate(CreateScene("valkyrie_sim", "whole_body"));
+        TestIncrementalUpdate(CreateScene("talos", "whole_body"));
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaKinematicTree, JacobianChainsMatchReference)
+{
+    try
+    {
+        TestJacobianChains(CreateScene("lwr_simplified", "arm"));
+        TestJacobianChains(CreateScene("valkyrie_sim", "whole_body"));
+        TestJacobianChains(CreateScene("talos", "whole_body"));
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaKinematicTree, BatchUpdateMatchesSingleUpdates)
+{
+    try
+    {
+        ScenePtr scene = CreateScene("valkyrie_sim", "whole_body");
+        KinematicTree& tree = scene->GetKinematicTree();
+        const int num_joints = tree.GetNumControlledJoints();
+        KinematicsRequest request;
+        request.flags = KIN_FK | KIN_J;
+        for (const auto& element : tree.GetModelTree()) request.frames.push_back(KinematicFrameRequest(element->segment.getName()));
+        std::shared_ptr<KinematicResponse> response = tree.RequestFrames(request);
+
+        const Eigen::VectorXd x_current = Eigen::VectorXd::Random(num_joints);
+        tree.Update(x_current);
+        const Eigen::MatrixXd X = Eigen::MatrixXd::Random(NUM_TRIALS, num_joints);
+        Eigen::MatrixXd frames, jacobians;
+        tree.UpdateBatch(X, frames, jacobians);
+        ASSERT_EQ(frames.rows(), NUM_TRIALS);
+        ASSERT_EQ(frames.cols(), 7 * request.frames.size());
+        ASSERT_EQ(jacobians.cols(), 6 * num_joints * request.frames.size());
+        EXPECT_TRUE(response->x.isApprox(x_current)) << "The tree was not returned to its previous configuration.";
+
+        for (int n = 0; n < NUM_TRIALS; ++n)
+        {
+            tree.Update(X.row(n).transpose());
+            for (int i = 0; i < request.frames.size(); ++i)
+            {
+                const KDL::Frame frame = GetFrame(Eigen::VectorXd(frames.row(n).segment(7 * i, 7).transpose()));
+                ASSERT_TRUE(KDL::Equal(frame, response->Phi(i), 1e-10)) << "Frame of '" << request.frames[i].frame_A_link_name << "' in configuration " << n << " does not match.";
+                const Eigen::RowVectorXd jacobian_data = jacobians.row(n).segment(6 * num_joints * i, 6 * num_joints);
+                const Eigen::Map<const Eigen::MatrixXd> jacobian(jacobian_data.data(), 6, num_joints);
+                ASSERT_LT((jacobian - response->jacobian(i).data).norm(), 1e-10) << "Jacobian of '" << request.frames[i].frame_A_link_name << "' in configuration " << n << " does not match.";
+            }
+        }
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaKinematicTree, BenchmarkForwardPass)
+{
+    try
+    {
+        BenchmarkForwardPass(CreateScene("lwr_simplified", "arm"));
+        BenchmarkForwardPass(CreateScene("valkyrie_sim", "whole_body"));
+        BenchmarkForwardPass(CreateScene("talos", "whole_body"));
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaKinematicTree, BenchmarkUpdateJ)
+{
+    try
+    {
+        ScenePtr scene = CreateScene("valkyrie_sim", "whole_body");
+        BenchmarkJacobian(scene, 1);
+        BenchmarkJacobian(scene, 10);
+        BenchmarkJacobian(scene, 100);
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaKinematicTree, BenchmarkJacobianDerivative)
+{
+    try
+    {
+        ScenePtr scene = CreateScene("valkyrie_sim", "whole_body");
+        KinematicTree& tree = scene->GetKinematicTree();
+        tree.Update(Eigen::VectorXd::Random(tree.GetNumControlledJoints()));
+        KDL::Jacobian jacobian(tree.GetNumControlledJoints());
+        jacobian.data = tree.Jacobian(tree.GetModelTree().back()->segment.getName(), KDL::Frame(), "", KDL::Frame());
+
+        Timer timer;
+        tree.SetJacobianDerivativeMethod(JDOT_PAIRWISE);
+        for (int i = 0; i < NUM_BENCHMARK_ITERATIONS; ++i) tree.Jdot(jacobian);
+        const double pairwise_time = timer.GetDuration();
+
+        timer.Reset();
+        tree.SetJacobianDerivativeMethod(JDOT_PREFIX_SUM);
+        for (int i = 0; i < NUM_BENCHMARK_ITERATIONS; ++i) tree.Jdot(jacobian);
+        const double prefix_sum_time = timer.GetDuration();
+
+        TEST_COUT << tree.GetNumControlledJoints() << " controlled joints: pairwise Jdot " << pairwise_time / NUM_BENCHMARK_ITERATIONS * 1e6 << "us, prefix sum Jdot " << prefix_sum_time / NUM_BENCHMARK_ITERATIONS * 1e6 << "us (" << pairwise_time / prefix_sum_time << "x)";
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    int ret = RUN_ALL_TESTS();
+    Setup::Destroy();
+    return ret;
+}
@@ -0,0 +1,223 @@
+//
+// Copyright (c) 2018, University of Edinburgh
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <exotica_core/exotica_core.h>
+#include <exotica_ompl_solver/ompl_native_solvers.h>
+#include <exotica_ompl_solver/ompl_roadmap.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <set>
+#include <utility>
+
+using namespace exotica;
+
+#define ROADMAP_GROWTH_TIME 1.0
+#define ROADMAP_FILE "/tmp/exotica_test_ompl_roadmap.bin"
+
+// Exposes the roadmap and the state space of the PRM solver.
+class PRMSolverRoadmap : public PRMSolver
+{
+public:
+    void GetRoadmap(ompl::base::PlannerData& data) { ompl_simple_setup_->getPlanner()->getPlannerData(data); }
+    const ompl::base::SpaceInformationPtr& GetSpaceInformation() { return ompl_simple_setup_->getSpaceInformation(); }
+    const std::vector<double>& GetBounds() const { return bounds_; }
+    ScenePtr GetScene() { return prob_->GetScene(); }
+};
+
+std::shared_ptr<PRMSolverRoadmap> CreateRoadmap()
+{
+    Initializer solver_init, problem_init;
+    XMLLoader::Load("{exotica_examples}/resources/configs/example_prm.xml", solver_init, problem_init);
+    PRMSolverInitializer parameters(solver_init);
+    parameters.RandomSeed = 0;
+    std::shared_ptr<PRMSolverRoadmap> solver = std::make_shared<PRMSolverRoadmap>();
+    solver->InstantiateInternal(Initializer(parameters));
+    solver->SpecifyProblem(Setup::CreateProblem(problem_init));
+
+    // Solve once to set up the planner, then grow a roadmap without the query states
+    Eigen::MatrixXd solution;
+    solver->Solve(solution);
+    solver->Clear();
+    solver->GrowRoadmap(ROADMAP_GROWTH_TIME);
+    return solver;
+}
+
+// Undirected edges of the roadmap as ordered pairs of vertex indices
+std::set<std::pair<unsigned int, unsigned int>> GetEdges(const ompl::base::PlannerData& data)
+{
+    std::set<std::pair<unsigned int, unsigned int>> edges;
+    std::vector<unsigned int> neighbors;
+    for (unsigned int i = 0; i < data.numVertices(); ++i)
+    {
+        data.getEdges(i, neighbors);
+        for (const unsigned int j : neighbors) edges.emplace(std::min(i, j), std::max(i, j));
+    }
+    return edges;
+}
+
+TEST(ExoticaOMPLRoadmap, SaveLoadRoundTrip)
+{
+    try
+    {
+        std::shared_ptr<PRMSolverRoadmap> solver = CreateRoadmap();
+        const ompl::base::SpaceInformationPtr& si = solver->GetSpaceInformation();
+        const OMPLStateSpace* space = si->getStateSpace()->as<OMPLStateSpace>();
+
+        ompl::base::PlannerData saved(si);
+        solver->GetRoadmap(saved);
+        ASSERT_GT(saved.numVertices(), 0u);
+        ASSERT_GT(GetEdges(saved).size(), 0u);
+        SaveRoadmap(ROADMAP_FILE, saved, true, solver->GetScene(), solver->GetBounds());
+
+        ompl::base::PlannerData loaded(si);
+        EXPECT_EQ(LoadRoadmap(ROADMAP_FILE, loaded, solver->GetScene(), solver->GetBounds()), 0);
+        ASSERT_EQ(loaded.numVertices(), saved.numVertices());
+        Eigen::VectorXd q_saved, q_loaded;
+        for (unsigned int i = 0; i < saved.numVertices(); ++i)
+        {
+            space->OMPLToExoticaState(saved.getVertex(i).getState(), q_saved);
+            space->OMPLToExoticaState(loaded.getVertex(i).getState(), q_loaded);
+            EXPECT_TRUE(q_saved == q_loaded) << "Vertex " << i << " differs";
+            EXPECT_EQ(saved.getVertex(i).getTag(), loaded.getVertex(i).getTag());
+        }
+        EXPECT_TRUE(GetEdges(saved) == GetEdges(loaded));
+
+        // The solver replaces its planner with the loaded roadmap, which answers queries
+        const int milestones = solver->MilestoneCount();
+        const int edges = solver->EdgeCount();
+        solver->SaveRoadmap(ROADMAP_FILE);
+        EXPECT_EQ(solver->LoadRoadmap(ROADMAP_FILE), 0);
+        EXPECT_EQ(solver->MilestoneCount(), milestones);
+        EXPECT_EQ(solver->EdgeCount(), edges);
+        Eigen::MatrixXd solution;
+        solver->Solve(solution);
+        EXPECT_GT(solution.rows(), 0);
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaOMPLRoadmap, AddedObjectDropsExactlyTheAffectedEdges)
+{
+    try
+    {
+        std::shared_ptr<PRMSolverRoadmap> solver = CreateRoadmap();
+        const ompl::base::SpaceInformationPtr& si = solver->GetSpaceInformation();
+        const OMPLStateSpace* space = si->getStateSpace()->as<OMPLStateSpace>();
+        ScenePtr scene = solver->GetScene();
+
+        ompl::base::PlannerData saved(si);
+        solver->GetRoadmap(saved);
+        SaveRoadmap(ROADMAP_FILE, saved, true, scene, solver->GetBounds());
+
+        // Place a box at the end-effector of the first milestone
+        Eigen::VectorXd q;
+        space->OMPLToExoticaState(saved.getVertex(0).getState(), q);
+        scene->Update(q);
+        const KDL::Frame pose = scene->GetKinematicTree().FK("lwr_arm_7_link", KDL::Frame(), "", KDL::Frame());
+        scene->AddObject("RoadmapObstacle", pose, "", shapes::ShapeConstPtr(new shapes::Box(0.2, 0.2, 0.2)));
+
+        // Reference: the validity checker and motion validator of the planner, which check the whole scene
+        std::vector<int> loaded_index(saved.numVertices(), -1);
+        int num_valid = 0;
+        int expected_dropped = 0;
+        for (unsigned int i = 0; i < saved.numVertices(); ++i)
+        {
+            if (si->isValid(saved.getVertex(i).getState()))
+                loaded_index[i] = num_valid++;
+            else
+                ++expected_dropped;
+        }
+        std::set<std::pair<unsigned int, unsigned int>> expected_edges;
+        for (const std::pair<unsigned int, unsigned int>& edge : GetEdges(saved))
+        {
+            if (loaded_index[edge.first] < 0 || loaded_index[edge.second] < 0) continue;
+            if (si->checkMotion(saved.getVertex(edge.first).getState(), saved.getVertex(edge.second).getState()))
+                expected_edges.emplace(loaded_index[edge.first], loaded_index[edge.second]);
+            else
+                ++expected_dropped;
+        }
+        EXPECT_LT(loaded_index[0], 0) << "The obstacle does not invalidate the roadmap";
+        ASSERT_GT(num_valid, 0);
+
+        ompl::base::PlannerData loaded(si);
+        EXPECT_EQ(LoadRoadmap(ROADMAP_FILE, loaded, scene, solver->GetBounds()), expected_dropped);
+        ASSERT_EQ(loaded.numVertices(), static_cast<unsigned int>(num_valid));
+        EXPECT_TRUE(GetEdges(loaded) == expected_edges);
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaOMPLRoadmap, RobotChangesRejectRoadmap)
+{
+    try
+    {
+        std::shared_ptr<PRMSolverRoadmap> solver = CreateRoadmap();
+        const ompl::base::SpaceInformationPtr& si = solver->GetSpaceInformation();
+        ScenePtr scene = solver->GetScene();
+        const CollisionScenePtr& collision_scene = scene->GetCollisionScene();
+
+        ompl::base::PlannerData saved(si);
+        solver->GetRoadmap(saved);
+        SaveRoadmap(ROADMAP_FILE, saved, true, scene, solver->GetBounds());
+
+        const double padding = collision_scene->GetRobotLinkPadding();
+        collision_scene->SetRobotLinkPadding(padding + 0.05);
+        ompl::base::PlannerData padded(si);
+        EXPECT_THROW(LoadRoadmap(ROADMAP_FILE, padded, scene, solver->GetBounds()), std::exception);
+        collision_scene->SetRobotLinkPadding(padding);
+
+        ompl::base::PlannerData unchanged(si);
+        EXPECT_EQ(LoadRoadmap(ROADMAP_FILE, unchanged, scene, solver->GetBounds()), 0);
+
+        scene->AddObject("RoadmapPayload", KDL::Frame(), "", shapes::ShapeConstPtr(new shapes::Box(0.05, 0.05, 0.05)));
+        scene->AttachObjectLocal("RoadmapPayload", "lwr_arm_7_link", KDL::Frame());
+        scene->UpdateCollisionObjects();
+        ompl::base::PlannerData attached(si);
+        EXPECT_THROW(LoadRoadmap(ROADMAP_FILE, attached, scene, solver->GetBounds()), std::exception);
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    int ret = RUN_ALL_TESTS();
+    Setup::Destroy();
+    return ret;
+}
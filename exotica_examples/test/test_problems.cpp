@@ -70,6 +70,7 @@ public:
 
 using namespace exotica;
 #include <string>
+#include <thread>
 #include <vector>
 
 #define CREATE_PROBLEM(X, I) std::shared_ptr<X> problem = CreateProblem<X>(#X, I);
@@ -592,6 +593,59 @@ TEST(ExoticaProblems, TimeIndexedProblem)
     }
 }
 
+TEST(ExoticaProblems, TimeIndexedProblemParallelUpdate)
+{
+    try
+    {
+        for (int d = 0; d < 3; ++d)
+        {
+            std::shared_ptr<TimeIndexedProblem> serial = CreateProblem<TimeIndexedProblem>("TimeIndexedProblem", d);
+            std::shared_ptr<TimeIndexedProblem> parallel = CreateProblem<TimeIndexedProblem>("TimeIndexedProblem", d);
+            const int T = 23;
+            serial->SetT(T);
+            parallel->SetT(T);
+            parallel->SetNumThreads(4);
+
+            for (int trial = 0; trial < 3; ++trial)
+            {
+                const Eigen::VectorXd x_trajectory = Eigen::VectorXd::Random(serial->N * (T - 1));
+                serial->ResetNumberOfProblemUpdates();
+                parallel->ResetNumberOfProblemUpdates();
+                serial->Update(x_trajectory);
+                parallel->Update(x_trajectory);
+
+                TEST_COUT << "Testing parallel trajectory update with derivatives " << d;
+                for (int t = 1; t < T; ++t)
+                {
+                    if (serial->Phi[t].data != parallel->Phi[t].data) ADD_FAILURE() << "Phi is inconsistent at t=" << t;
+                    if (serial->cost.ydiff[t] != parallel->cost.ydiff[t]) ADD_FAILURE() << "Cost is inconsistent at t=" << t;
+                    if (serial->equality.ydiff[t] != parallel->equality.ydiff[t]) ADD_FAILURE() << "Equality is inconsistent at t=" << t;
+                    if (serial->inequality.ydiff[t] != parallel->inequality.ydiff[t]) ADD_FAILURE() << "Inequality is inconsistent at t=" << t;
+                    if (d > 0 && serial->jacobian[t] != parallel->jacobian[t]) ADD_FAILURE() << "Jacobian is inconsistent at t=" << t;
+                    if (d > 1)
+                    {
+                        for (int i = 0; i < serial->hessian[t].rows(); ++i)
+                        {
+                            if (serial->hessian[t](i) != parallel->hessian[t](i)) ADD_FAILURE() << "Hessian is inconsistent at t=" << t;
+                        }
+                    }
+                }
+                EXPECT_EQ(serial->GetCost(), parallel->GetCost());
+                EXPECT_EQ(serial->GetNumberOfProblemUpdates(), parallel->GetNumberOfProblemUpdates());
+
+                // Single timestep updates after the parallel update use the same previous timestep.
+                serial->Update(x_trajectory.tail(serial->N), T - 1);
+                parallel->Update(x_trajectory.tail(serial->N), T - 1);
+                if (serial->Phi[T - 1].data != parallel->Phi[T - 1].data) ADD_FAILURE() << "Phi is inconsistent after a single timestep update!";
+            }
+        }
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
 TEST(ExoticaProblems, SamplingProblem)
 {
     try
@@ -609,6 +663,133 @@ TEST(ExoticaProblems, SamplingProblem)
     }
 }
 
+TEST(ExoticaProblems, SamplingProblemValidityCascade)
+{
+    try
+    {
+        CREATE_PROBLEM(SamplingProblem, 0);
+        const Eigen::MatrixXd bounds = problem->GetScene()->GetKinematicTree().GetJointLimits();
+        TEST_COUT << "Testing early exit against the full update";
+        for (int i = 0; i < NUM_TRIALS; ++i)
+        {
+            // Half of the states violate the joint limits
+            Eigen::VectorXd x = problem->GetScene()->GetKinematicTree().GetRandomControlledState();
+            if (i % 2 == 0) x(i % problem->N) = bounds(i % problem->N, 1) + 0.1;
+
+            problem->ResetNumberOfProblemUpdates();
+            const bool is_valid = problem->IsValid(x);
+            if (i % 2 == 0 && problem->GetNumberOfProblemUpdates() != 0) ADD_FAILURE() << "The problem was updated for a state outside of the joint limits!";
+
+            problem->Update(x);
+            if (is_valid != problem->IsValid()) ADD_FAILURE() << "Validity is inconsistent with the full update for state " << i;
+        }
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaProblems, SamplingProblemValidityCache)
+{
+    try
+    {
+        TEST_COUT << "Creating SamplingProblem with a validity cache";
+        Initializer dummy;
+        Initializer init;
+        XMLLoader::Load("{exotica_examples}/test/resources/test_problems.xml", dummy, init, "Dummy", "SamplingProblem");
+        init.AddProperty(Property("ValidityCacheSize", false, 2 * NUM_TRIALS));
+        std::shared_ptr<SamplingProblem> problem = std::static_pointer_cast<SamplingProblem>(Setup::CreateProblem(init));
+
+        std::vector<Eigen::VectorXd> states(NUM_TRIALS);
+        std::vector<char> expected(NUM_TRIALS);
+        for (int i = 0; i < NUM_TRIALS; ++i)
+        {
+            states[i] = problem->GetScene()->GetKinematicTree().GetRandomControlledState();
+            expected[i] = problem->IsValid(states[i]);
+        }
+        if (problem->GetValidityCache().GetNumberOfHits() != 0) ADD_FAILURE() << "Unexpected cache hits for new states!";
+
+        TEST_COUT << "Testing cached states";
+        problem->ResetNumberOfProblemUpdates();
+        for (int i = 0; i < NUM_TRIALS; ++i)
+        {
+            if (problem->IsValid(states[i]) != static_cast<bool>(expected[i])) ADD_FAILURE() << "Cached validity is inconsistent for state " << i;
+        }
+        EXPECT_EQ(problem->GetNumberOfProblemUpdates(), 0u);
+        EXPECT_EQ(problem->GetValidityCache().GetNumberOfHits(), static_cast<std::size_t>(NUM_TRIALS));
+
+        TEST_COUT << "Testing invalidation";
+        problem->SetGoalNEQ("Distance", Eigen::VectorXd::Constant(1, 0.6));
+        EXPECT_EQ(problem->GetValidityCache().GetSize(), 0u);
+        problem->IsValid(states[0]);
+        problem->GetScene()->AddObject("CacheTestObject", KDL::Frame(), "", shapes::ShapeConstPtr(new shapes::Sphere(0.1)));
+        problem->ResetNumberOfProblemUpdates();
+        problem->IsValid(states[0]);
+        EXPECT_EQ(problem->GetNumberOfProblemUpdates(), 1u);
+        problem->GetScene()->GetCollisionScene()->SetRobotLinkPadding(0.01);
+        problem->ResetNumberOfProblemUpdates();
+        problem->IsValid(states[0]);
+        EXPECT_EQ(problem->GetNumberOfProblemUpdates(), 1u);
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaProblems, SamplingProblemReplicas)
+{
+    try
+    {
+        CREATE_PROBLEM(SamplingProblem, 0);
+        problem->SetGoalNEQ("Distance", Eigen::VectorXd::Constant(1, 0.6));
+        std::vector<Eigen::VectorXd> states(NUM_TRIALS);
+        std::vector<char> expected(NUM_TRIALS);
+        for (int i = 0; i < NUM_TRIALS; ++i)
+        {
+            states[i] = problem->GetScene()->GetKinematicTree().GetRandomControlledState();
+            expected[i] = problem->IsValid(states[i]);
+        }
+
+        TEST_COUT << "Testing replicas";
+        const int num_replicas = 4;
+        std::vector<std::shared_ptr<SamplingProblem>> replicas;
+        for (int i = 0; i < num_replicas; ++i) replicas.push_back(problem->CreateReplica());
+        for (int i = 0; i < NUM_TRIALS; ++i)
+        {
+            if (replicas[0]->IsValid(states[i]) != static_cast<bool>(expected[i])) ADD_FAILURE() << "Replica is inconsistent for state " << i;
+        }
+
+        TEST_COUT << "Testing concurrent validity checks";
+        std::vector<std::vector<char>> results(num_replicas, std::vector<char>(NUM_TRIALS));
+        std::vector<std::thread> threads;
+        for (int r = 0; r < num_replicas; ++r)
+        {
+            threads.emplace_back([&, r]() {
+                for (int i = 0; i < NUM_TRIALS; ++i) results[r][i] = replicas[r]->IsValid(states[i]);
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+        for (int r = 0; r < num_replicas; ++r)
+        {
+            if (results[r] != expected) ADD_FAILURE() << "Concurrent validity checks of replica " << r << " are inconsistent!";
+        }
+
+        TEST_COUT << "Testing synchronisation";
+        problem->SetGoalNEQ("Distance", Eigen::VectorXd::Constant(1, 0.3));
+        replicas[0]->CopyStateFrom(*problem);
+        for (int i = 0; i < NUM_TRIALS; ++i)
+        {
+            if (replicas[0]->IsValid(states[i]) != problem->IsValid(states[i])) ADD_FAILURE() << "Synchronised replica is inconsistent for state " << i;
+        }
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
 TEST(ExoticaProblems, TimeIndexedSamplingProblem)
 {
     try
@@ -626,6 +807,159 @@ TEST(ExoticaProblems, TimeIndexedSamplingProblem)
     }
 }
 
+TEST(ExoticaProblems, DynamicsSolverAutomaticDifferentiation)
+{
+    try
+    {
+        for (const std::string& type : {std::string("CartpoleDynamicsSolver"), std::string("QuadrotorDynamicsSolver")})
+        {
+            TEST_COUT << "Creating " << type << " with automatic differentiation and finite differences";
+            DynamicsSolverPtr ad = Setup::CreateDynamicsSolver(Initializer("exotica/" + type, {{"Name", type + "AD"}, {"AutomaticDifferentiation", true}}));
+            DynamicsSolverPtr fd = Setup::CreateDynamicsSolver(Initializer("exotica/" + type, {{"Name", type + "FD"}, {"AutomaticDifferentiation", false}}));
+            const int NX = ad->get_num_positions() + ad->get_num_velocities();
+            const int NU = ad->get_num_controls();
+
+            std::vector<Eigen::VectorXd> xs(NUM_TRIALS), us(NUM_TRIALS);
+            for (int i = 0; i < NUM_TRIALS; ++i)
+            {
+                xs[i] = Eigen::VectorXd::Random(NX);
+                us[i] = Eigen::VectorXd::Random(NU);
+            }
+
+            TEST_COUT << "Testing first-order derivatives";
+            for (int i = 0; i < NUM_TRIALS; ++i)
+            {
+                ad->ComputeDerivatives(xs[i], us[i]);
+                fd->ComputeDerivatives(xs[i], us[i]);
+                if (!ad->get_fx().isApprox(fd->get_fx(), 1e-5)) ADD_FAILURE() << "fx mismatch:\n"
+                                                                             << ad->get_fx() << "\n"
+                                                                             << fd->get_fx();
+                if (!ad->get_fu().isApprox(fd->get_fu(), 1e-5)) ADD_FAILURE() << "fu mismatch:\n"
+                                                                             << ad->get_fu() << "\n"
+                                                                             << fd->get_fu();
+            }
+
+            TEST_COUT << "Testing second-order derivatives against finite differences of fx";
+            constexpr double eps = 1e-6;
+            const Eigen::Tensor<double, 3> fxx = ad->fxx(xs[0], us[0]);
+            const Eigen::Tensor<double, 3> fxu = ad->fxu(xs[0], us[0]);
+            for (int k = 0; k < NX; ++k)
+            {
+                Eigen::VectorXd x_high = xs[0], x_low = xs[0];
+                x_high(k) += eps / 2.0;
+                x_low(k) -= eps / 2.0;
+                const Eigen::MatrixXd fx_k = (ad->fx(x_high, us[0]) - ad->fx(x_low, us[0])) / eps;
+                for (int i = 0; i < NX; ++i)
+                    for (int j = 0; j < NX; ++j)
+                        if (std::abs(fx_k(i, j) - fxx(k, i, j)) > 1e-4) ADD_FAILURE() << "fxx(" << k << ", " << i << ", " << j << ") mismatch: " << fxx(k, i, j) << " vs " << fx_k(i, j);
+            }
+            for (int a = 0; a < NU; ++a)
+            {
+                Eigen::VectorXd u_high = us[0], u_low = us[0];
+                u_high(a) += eps / 2.0;
+                u_low(a) -= eps / 2.0;
+                const Eigen::MatrixXd fx_a = (ad->fx(xs[0], u_high) - ad->fx(xs[0], u_low)) / eps;
+                for (int i = 0; i < NX; ++i)
+                    for (int j = 0; j < NX; ++j)
+                        if (std::abs(fx_a(i, j) - fxu(a, i, j)) > 1e-4) ADD_FAILURE() << "fxu(" << a << ", " << i << ", " << j << ") mismatch: " << fxu(a, i, j) << " vs " << fx_a(i, j);
+            }
+
+            TEST_COUT << "Testing contracted second-order derivatives against finite differences";
+            const Eigen::VectorXd v = Eigen::VectorXd::Random(NX);
+            Eigen::MatrixXd v_fxx_ad, v_fuu_ad, v_fxu_ad, v_fxx_fd, v_fuu_fd, v_fxu_fd;
+            ad->ContractedSecondOrderDerivatives(xs[0], us[0], v, v_fxx_ad, v_fuu_ad, v_fxu_ad);
+            fd->ContractedSecondOrderDerivatives(xs[0], us[0], v, v_fxx_fd, v_fuu_fd, v_fxu_fd);
+            if ((v_fxx_ad - v_fxx_fd).cwiseAbs().maxCoeff() > 1e-4) ADD_FAILURE() << "Contracted fxx mismatch:\n"
+                                                                                   << v_fxx_ad << "\n"
+                                                                                   << v_fxx_fd;
+            if ((v_fuu_ad - v_fuu_fd).cwiseAbs().maxCoeff() > 1e-4) ADD_FAILURE() << "Contracted fuu mismatch:\n"
+                                                                                   << v_fuu_ad << "\n"
+                                                                                   << v_fuu_fd;
+            if ((v_fxu_ad - v_fxu_fd).cwiseAbs().maxCoeff() > 1e-4) ADD_FAILURE() << "Contracted fxu mismatch:\n"
+                                                                                   << v_fxu_ad << "\n"
+                                                                                   << v_fxu_fd;
+
+            TEST_COUT << "Benchmarking ComputeDerivatives";
+            Timer timer;
+            for (int i = 0; i < NUM_TRIALS; ++i) ad->ComputeDerivatives(xs[i], us[i]);
+            const double time_ad = timer.GetDuration();
+            timer.Reset();
+            for (int i = 0; i < NUM_TRIALS; ++i) fd->ComputeDerivatives(xs[i], us[i]);
+            const double time_fd = timer.GetDuration();
+            timer.Reset();
+            for (int i = 0; i < NUM_TRIALS; ++i) ad->ComputeDerivatives(xs[i], us[i] + us[i], true);
+            const double time_ad_second_order = timer.GetDuration();
+            TEST_COUT << type << ": automatic differentiation " << time_ad / NUM_TRIALS * 1e6 << " us, finite differences " << time_fd / NUM_TRIALS * 1e6 << " us, automatic differentiation with second order " << time_ad_second_order / NUM_TRIALS * 1e6 << " us";
+        }
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaProblems, SamplingMPCSolverIsReproducible)
+{
+    try
+    {
+        Initializer solver_init, problem_init;
+        XMLLoader::Load("{exotica_examples}/resources/configs/dynamic_time_indexed/19_sampling_mpc_cartpole.xml", solver_init, problem_init);
+        solver_init.SetProperty("Debug", false);
+        solver_init.SetProperty("MaxIterations", 5);
+        solver_init.SetProperty("NumSamples", 64);
+        DynamicTimeIndexedShootingProblemPtr problem = std::static_pointer_cast<DynamicTimeIndexedShootingProblem>(Setup::CreateProblem(problem_init));
+        const Eigen::MatrixXd U_init = problem->get_U();
+
+        std::vector<Eigen::MatrixXd> solutions;
+        for (const std::string& method : {std::string("MPPI"), std::string("CEM")})
+        {
+            for (int num_threads : {1, 3})
+            {
+                TEST_COUT << "Solving with " << method << " on " << num_threads << " threads";
+                solver_init.SetProperty("Method", method);
+                solver_init.SetProperty("NumThreads", num_threads);
+                MotionSolverPtr solver = Setup::CreateSolver(solver_init);
+                problem->set_U(U_init);
+                solver->SpecifyProblem(problem);
+                Eigen::MatrixXd solution;
+                solver->Solve(solution);
+                if (!solution.allFinite()) ADD_FAILURE() << "Solution is not finite!";
+                solutions.push_back(solution);
+            }
+            if (solutions[solutions.size() - 2] != solutions.back()) ADD_FAILURE() << method << " solution depends on the number of threads!";
+        }
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaProblems, SamplingMPCSolverSwingsUpCartpole)
+{
+    try
+    {
+        Initializer solver_init, problem_init;
+        XMLLoader::Load("{exotica_examples}/resources/configs/dynamic_time_indexed/19_sampling_mpc_cartpole.xml", solver_init, problem_init);
+        solver_init.SetProperty("Debug", false);
+        DynamicTimeIndexedShootingProblemPtr problem = std::static_pointer_cast<DynamicTimeIndexedShootingProblem>(Setup::CreateProblem(problem_init));
+        MotionSolverPtr solver = Setup::CreateSolver(solver_init);
+        solver->SpecifyProblem(problem);
+        Eigen::MatrixXd solution;
+        solver->Solve(solution);
+
+        // The best cost never increases by construction, the swing-up has to reduce it substantially from the initial (zero) controls.
+        const double initial_cost = problem->GetCostEvolution(0);
+        const double final_cost = problem->GetCostEvolution(-1);
+        TEST_COUT << "Cost reduced from " << initial_cost << " to " << final_cost;
+        EXPECT_LT(final_cost, 0.5 * initial_cost);
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
 int main(int argc, char** argv)
 {
     testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,191 @@
+//
+// Copyright (c) 2018, University of Edinburgh
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of  nor the names of its contributors may be used to
+//    endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <exotica_core/exotica_core.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+
+// Extend testing printout //////////////////////
+
+namespace testing
+{
+namespace internal
+{
+enum GTestColor
+{
+    COLOR_DEFAULT,
+    COLOR_RED,
+    COLOR_GREEN,
+    COLOR_YELLOW
+};
+
+extern void ColoredPrintf(GTestColor color, const char* fmt, ...);
+}
+}
+#define PRINTF(...)                                                                        \
+    do                                                                                     \
+    {                                                                                      \
+        testing::internal::ColoredPrintf(testing::internal::COLOR_GREEN, "[          ] "); \
+        testing::internal::ColoredPrintf(testing::internal::COLOR_YELLOW, __VA_ARGS__);    \
+    } while (0)
+
+// C++ stream interface
+class TestCout : public std::stringstream
+{
+public:
+    ~TestCout()
+    {
+        PRINTF("%s\n", str().c_str());
+    }
+};
+
+#define TEST_COUT TestCout()
+
+//////////////////////////////////////////////
+
+using namespace exotica;
+
+#define NUM_TRIALS 100
+#define NUM_THREADS 4
+
+ScenePtr CreateScene()
+{
+    Initializer scene("Scene", {{"Name", std::string("SceneTestScene")},
+                                {"JointGroup", std::string("arm")},
+                                {"URDF", std::string("{exotica_examples}/resources/robots/lwr_simplified.urdf")},
+                                {"SRDF", std::string("{exotica_examples}/resources/robots/lwr_simplified.srdf")},
+                                {"LoadScene", std::string("{exotica_examples}/resources/scenes/example_manipulate.scene")}});
+    ScenePtr ret = Setup::CreateScene(scene);
+    ret->AddObject("TestFrame", KDL::Frame(KDL::Vector(0.1, 0.0, 0.0)), "lwr_arm_6_link", shapes::ShapeConstPtr(nullptr));
+    ret->AttachObjectLocal("TestFrame", "lwr_arm_4_link", KDL::Frame(KDL::Vector(0.0, 0.1, 0.0)));
+    ret->AddObject("MovingFrame", KDL::Frame(), "", shapes::ShapeConstPtr(nullptr));
+    ret->AddTrajectoryFromFile("MovingFrame", ParsePath("{exotica_examples}/resources/scenes/figure_eight.traj"));
+    ret->GetKinematicTree().RequestFrames(KinematicsRequest());
+    return ret;
+}
+
+std::map<std::string, KDL::Frame> GetFrames(ScenePtr scene)
+{
+    std::map<std::string, KDL::Frame> frames;
+    for (const auto& element : scene->GetTreeMap()) frames[element.first] = element.second.lock()->frame;
+    return frames;
+}
+
+bool FramesEqual(const std::map<std::string, KDL::Frame>& a, const std::map<std::string, KDL::Frame>& b, double eps = 1e-10)
+{
+    if (a.size() != b.size()) return false;
+    for (const auto& frame : a)
+    {
+        auto it = b.find(frame.first);
+        if (it == b.end() || !KDL::Equal(frame.second, it->second, eps)) return false;
+    }
+    return true;
+}
+
+TEST(ExoticaScene, CloneMatchesOriginal)
+{
+    try
+    {
+        ScenePtr scene = CreateScene();
+        ScenePtr clone = scene->Clone();
+        EXPECT_TRUE(clone->HasAttachedObject("TestFrame"));
+        EXPECT_TRUE(scene->GetModelState() == clone->GetModelState());
+        for (int i = 0; i < NUM_TRIALS; ++i)
+        {
+            const Eigen::VectorXd x = scene->GetKinematicTree().GetRandomControlledState();
+            const double t = 0.1 * i;
+            scene->Update(x, t);
+            clone->Update(x, t);
+            ASSERT_TRUE(FramesEqual(GetFrames(scene), GetFrames(clone))) << "Frames of the clone differ from the original scene.";
+        }
+
+        // Updating the clone does not affect the original.
+        const std::map<std::string, KDL::Frame> frames = GetFrames(scene);
+        clone->Update(clone->GetKinematicTree().GetRandomControlledState(), 1.0);
+        EXPECT_TRUE(FramesEqual(frames, GetFrames(scene)));
+        clone->RemoveObject("TestFrame");
+        EXPECT_TRUE(scene->GetKinematicTree().DoesLinkWithNameExist("TestFrame"));
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+TEST(ExoticaScene, ClonesCanBeUpdatedConcurrently)
+{
+    try
+    {
+        ScenePtr scene = CreateScene();
+        std::vector<Eigen::VectorXd> states;
+        std::vector<std::map<std::string, KDL::Frame>> expected_frames;
+        for (int i = 0; i < NUM_TRIALS * NUM_THREADS; ++i)
+        {
+            states.push_back(scene->GetKinematicTree().GetRandomControlledState());
+            scene->Update(states.back(), 0.01 * i);
+            expected_frames.push_back(GetFrames(scene));
+        }
+
+        std::vector<ScenePtr> clones;
+        for (int i = 0; i < NUM_THREADS; ++i) clones.push_back(scene->Clone());
+
+        // Each thread updates its own clone with interleaved states, failures are collected and checked on the main thread.
+        std::vector<int> num_failures(NUM_THREADS, 0);
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread < NUM_THREADS; ++thread)
+        {
+            threads.emplace_back([&, thread]() {
+                for (int i = thread; i < states.size(); i += NUM_THREADS)
+                {
+                    clones[thread]->Update(states[i], 0.01 * i);
+                    if (!FramesEqual(expected_frames[i], GetFrames(clones[thread]))) ++num_failures[thread];
+                }
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+
+        for (int thread = 0; thread < NUM_THREADS; ++thread)
+        {
+            EXPECT_EQ(num_failures[thread], 0) << "Clone " << thread << " computed wrong frames.";
+        }
+    }
+    catch (...)
+    {
+        ADD_FAILURE() << "Uncaught exception!";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    int ret = RUN_ALL_TESTS();
+    Setup::Destroy();
+    return ret;
+}
@@ -584,6 +584,11 @@ PYBIND11_MODULE(_pyexotica, module)
         .value("Planar", BaseType::PLANAR)
         .export_values();
 
+    py::enum_<JacobianDerivativeMethod>(module, "JacobianDerivativeMethod")
+        .value("Pairwise", JacobianDerivativeMethod::JDOT_PAIRWISE)
+        .value("PrefixSum", JacobianDerivativeMethod::JDOT_PREFIX_SUM)
+        .export_values();
+
     py::class_<KDL::Frame> kdl_frame(module, "KDLFrame");
     kdl_frame.def(py::init());
     kdl_frame.def(py::init([](Eigen::MatrixXd other) { return GetFrameFromMatrix(other); }));
@@ -760,6 +765,7 @@ PYBIND11_MODULE(_pyexotica, module)
     unconstrained_time_indexed_problem.def("get_goal", &UnconstrainedTimeIndexedProblem::GetGoal);
     unconstrained_time_indexed_problem.def("get_rho", &UnconstrainedTimeIndexedProblem::GetRho);
     unconstrained_time_indexed_problem.def_property("tau", &UnconstrainedTimeIndexedProblem::GetTau, &UnconstrainedTimeIndexedProblem::SetTau);
+    unconstrained_time_indexed_problem.def_property("num_threads", &UnconstrainedTimeIndexedProblem::GetNumThreads, &UnconstrainedTimeIndexedProblem::SetNumThreads);
     unconstrained_time_indexed_problem.def_readwrite("W", &UnconstrainedTimeIndexedProblem::W);
     unconstrained_time_indexed_problem.def_property("initial_trajectory", &UnconstrainedTimeIndexedProblem::GetInitialTrajectory, &UnconstrainedTimeIndexedProblem::SetInitialTrajectory);
     unconstrained_time_indexed_problem.def_property("T", &UnconstrainedTimeIndexedProblem::GetT, &UnconstrainedTimeIndexedProblem::SetT);
@@ -791,6 +797,7 @@ PYBIND11_MODULE(_pyexotica, module)
     time_indexed_problem.def("get_goal_neq", &TimeIndexedProblem::GetGoalNEQ);
     time_indexed_problem.def("get_rho_neq", &TimeIndexedProblem::GetRhoNEQ);
     time_indexed_problem.def_property("tau", &TimeIndexedProblem::GetTau, &TimeIndexedProblem::SetTau);
+    time_indexed_problem.def_property("num_threads", &TimeIndexedProblem::GetNumThreads, &TimeIndexedProblem::SetNumThreads);
     time_indexed_problem.def_property("q_dot_max", &TimeIndexedProblem::GetJointVelocityLimits, &TimeIndexedProblem::SetJointVelocityLimits);
     time_indexed_problem.def_readwrite("W", &TimeIndexedProblem::W);
     time_indexed_problem.def_readwrite("use_bounds", &TimeIndexedProblem::use_bounds);
@@ -830,6 +837,7 @@ PYBIND11_MODULE(_pyexotica, module)
     bounded_time_indexed_problem.def("get_goal", &BoundedTimeIndexedProblem::GetGoal);
     bounded_time_indexed_problem.def("get_rho", &BoundedTimeIndexedProblem::GetRho);
     bounded_time_indexed_problem.def_property("tau", &BoundedTimeIndexedProblem::GetTau, &BoundedTimeIndexedProblem::SetTau);
+    bounded_time_indexed_problem.def_property("num_threads", &BoundedTimeIndexedProblem::GetNumThreads, &BoundedTimeIndexedProblem::SetNumThreads);
     bounded_time_indexed_problem.def_readwrite("W", &BoundedTimeIndexedProblem::W);
     bounded_time_indexed_problem.def_property("initial_trajectory", &BoundedTimeIndexedProblem::GetInitialTrajectory, &BoundedTimeIndexedProblem::SetInitialTrajectory);
     bounded_time_indexed_problem.def_property("T", &BoundedTimeIndexedProblem::GetT, &BoundedTimeIndexedProblem::SetT);
@@ -916,6 +924,15 @@ PYBIND11_MODULE(_pyexotica, module)
     bounded_end_pose_problem.def("get_bounds", &BoundedEndPoseProblem::GetBounds);
     bounded_end_pose_problem.def_readonly("cost", &BoundedEndPoseProblem::cost);
 
+    py::class_<ValidityCache> validity_cache(prob, "ValidityCache");
+    validity_cache.def_property_readonly("enabled", &ValidityCache::IsEnabled);
+    validity_cache.def_property_readonly("size", &ValidityCache::GetSize);
+    validity_cache.def_property_readonly("capacity", &ValidityCache::GetCapacity);
+    validity_cache.def_property_readonly("resolution", &ValidityCache::GetResolution);
+    validity_cache.def_property_readonly("hits", &ValidityCache::GetNumberOfHits);
+    validity_cache.def_property_readonly("misses", &ValidityCache::GetNumberOfMisses);
+    validity_cache.def_property_readonly("hit_rate", &ValidityCache::GetHitRate);
+
     py::class_<SamplingProblem, std::shared_ptr<SamplingProblem>, PlanningProblem> sampling_problem(prob, "SamplingProblem");
     sampling_problem.def("update", &SamplingProblem::Update);
     sampling_problem.def_property("goal_state", &SamplingProblem::GetGoalState, &SamplingProblem::SetGoalState);
@@ -933,6 +950,8 @@ PYBIND11_MODULE(_pyexotica, module)
     sampling_problem.def("set_rho_neq", &SamplingProblem::SetRhoNEQ);
     sampling_problem.def("get_goal_neq", &SamplingProblem::GetGoalNEQ);
     sampling_problem.def("get_rho_neq", &SamplingProblem::GetRhoNEQ);
+    sampling_problem.def_property_readonly("validity_cache", &SamplingProblem::GetValidityCache, py::return_value_policy::reference_internal);
+    sampling_problem.def("clear_validity_cache", &SamplingProblem::ClearValidityCache);
 
     py::class_<TimeIndexedSamplingProblem, std::shared_ptr<TimeIndexedSamplingProblem>, PlanningProblem> time_indexed_sampling_problem(prob, "TimeIndexedSamplingProblem");
     time_indexed_sampling_problem.def("update", &TimeIndexedSamplingProblem::Update);
@@ -952,10 +971,12 @@ PYBIND11_MODULE(_pyexotica, module)
     time_indexed_sampling_problem.def("set_rho_neq", &TimeIndexedSamplingProblem::SetRhoNEQ);
     time_indexed_sampling_problem.def("get_goal_neq", &TimeIndexedSamplingProblem::GetGoalNEQ);
     time_indexed_sampling_problem.def("get_rho_neq", &TimeIndexedSamplingProblem::GetRhoNEQ);
+    time_indexed_sampling_problem.def_property_readonly("validity_cache", &TimeIndexedSamplingProblem::GetValidityCache, py::return_value_policy::reference_internal);
+    time_indexed_sampling_problem.def("clear_validity_cache", &TimeIndexedSamplingProblem::ClearValidityCache);
 
     py::class_<DynamicTimeIndexedShootingProblem, std::shared_ptr<DynamicTimeIndexedShootingProblem>, PlanningProblem>(prob, "DynamicTimeIndexedShootingProblem")
         .def("update", &DynamicTimeIndexedShootingProblem::Update)
-        .def_property("X", static_cast<const Eigen::MatrixXd& (DynamicTimeIndexedShootingProblem::*)(void)const>(&DynamicTimeIndexedShootingProblem::get_X), &DynamicTimeIndexedShootingProblem::set_X)
+        .def_property("X", static_cast<const Eigen::MatrixXd& (DynamicTimeIndexedShootingProblem::*)(void)const>(&DynamicTimeIndexedShootingProblem::get_X), static_cast<void (DynamicTimeIndexedShootingProblem::*)(Eigen::MatrixXdRefConst)>(&DynamicTimeIndexedShootingProblem::set_X))
         .def_property("U", static_cast<const Eigen::MatrixXd& (DynamicTimeIndexedShootingProblem::*)(void)const>(&DynamicTimeIndexedShootingProblem::get_U), &DynamicTimeIndexedShootingProblem::set_U)
         .def_property("X_star", &DynamicTimeIndexedShootingProblem::get_X_star, &DynamicTimeIndexedShootingProblem::set_X_star)
         .def_property_readonly("tau", &DynamicTimeIndexedShootingProblem::get_tau)
@@ -968,9 +989,9 @@ PYBIND11_MODULE(_pyexotica, module)
         .def_readonly("jacobian", &DynamicTimeIndexedShootingProblem::jacobian)
         .def_readonly("cost", &DynamicTimeIndexedShootingProblem::cost)
         .def("get_state_cost", &DynamicTimeIndexedShootingProblem::GetStateCost)
-        .def("get_state_cost_jacobian", &DynamicTimeIndexedShootingProblem::GetStateCostJacobian)
+        .def("get_state_cost_jacobian", static_cast<Eigen::VectorXd (DynamicTimeIndexedShootingProblem::*)(int) const>(&DynamicTimeIndexedShootingProblem::GetStateCostJacobian))
         .def("get_control_cost", &DynamicTimeIndexedShootingProblem::GetControlCost)
-        .def("get_control_cost_jacobian", &DynamicTimeIndexedShootingProblem::GetControlCostJacobian);
+        .def("get_control_cost_jacobian", static_cast<Eigen::VectorXd (DynamicTimeIndexedShootingProblem::*)(int) const>(&DynamicTimeIndexedShootingProblem::GetControlCostJacobian));
 
     py::class_<CollisionProxy, std::shared_ptr<CollisionProxy>> collision_proxy(module, "CollisionProxy");
     collision_proxy.def(py::init());
@@ -999,6 +1020,13 @@ PYBIND11_MODULE(_pyexotica, module)
 
     py::class_<Scene, std::shared_ptr<Scene>, Object> scene(module, "Scene");
     scene.def("update", &Scene::Update, py::arg("x"), py::arg("t") = 0.0);
+    scene.def("clone", &Scene::Clone);
+    scene.def("update_batch", [](Scene* instance, Eigen::MatrixXdRefConst X, double t) {
+        Eigen::MatrixXd frames, jacobians;
+        instance->UpdateBatch(X, frames, jacobians, t);
+        return std::make_pair(std::move(frames), std::move(jacobians));
+    },
+              py::arg("X"), py::arg("t") = 0.0);
     scene.def("get_controlled_joint_names", (std::vector<std::string>(Scene::*)()) & Scene::GetControlledJointNames);
     scene.def("get_controlled_link_names", &Scene::GetControlledLinkNames);
     scene.def("get_model_link_names", &Scene::GetModelLinkNames);
@@ -1113,6 +1141,7 @@ PYBIND11_MODULE(_pyexotica, module)
     collision_scene.def_property("world_link_padding", &CollisionScene::GetWorldLinkPadding, &CollisionScene::SetWorldLinkPadding);
     collision_scene.def("update_collision_object_transforms", &CollisionScene::UpdateCollisionObjectTransforms);
     collision_scene.def("continuous_collision_check", &CollisionScene::ContinuousCollisionCheck);
+    collision_scene.def("continuous_collision_check_trajectory", &CollisionScene::ContinuousCollisionCheckTrajectory, py::arg("trajectory"), py::arg("self") = true);
     collision_scene.def("get_robot_to_robot_collision_distance", &CollisionScene::GetRobotToRobotCollisionDistance);
     collision_scene.def("get_robot_to_world_collision_distance", &CollisionScene::GetRobotToWorldCollisionDistance);
 
@@ -1168,6 +1197,15 @@ PYBIND11_MODULE(_pyexotica, module)
     kinematic_tree.def("set_floating_base_limits_pos_xyz_euler_zyx", &KinematicTree::SetFloatingBaseLimitsPosXYZEulerZYX);
     kinematic_tree.def("set_planar_base_limits_pos_xy_euler_z", &KinematicTree::SetPlanarBaseLimitsPosXYEulerZ);
     kinematic_tree.def("get_used_joint_limits", &KinematicTree::GetUsedJointLimits);
+    kinematic_tree.def("update_batch", [](KinematicTree* instance, Eigen::MatrixXdRefConst X) {
+        Eigen::MatrixXd frames, jacobians;
+        instance->UpdateBatch(X, frames, jacobians);
+        return std::make_pair(std::move(frames), std::move(jacobians));
+    });
+    kinematic_tree.def("set_jacobian_derivative_method", &KinematicTree::SetJacobianDerivativeMethod);
+    kinematic_tree.def("get_jacobian_derivative_method", &KinematicTree::GetJacobianDerivativeMethod);
+    kinematic_tree.def("get_recomputed_segment_count", &KinematicTree::GetRecomputedSegmentCount);
+    kinematic_tree.def("reset_recomputed_segment_count", &KinematicTree::ResetRecomputedSegmentCount);
 
     // Get full tree
     kinematic_tree.def("get_model_tree", &KinematicTree::GetModelTree);
@@ -1212,6 +1250,11 @@ PYBIND11_MODULE(_pyexotica, module)
         .def("f", &DynamicsSolver::f)
         .def("fx", &DynamicsSolver::fx)
         .def("fu", &DynamicsSolver::fu)
+        .def("compute_derivatives", &DynamicsSolver::ComputeDerivatives, py::arg("x"), py::arg("u"), py::arg("second_order") = false)
+        .def("get_state_derivative", &DynamicsSolver::get_state_derivative)
+        .def("get_fx", &DynamicsSolver::get_fx)
+        .def("get_fu", &DynamicsSolver::get_fu)
+        .def("clear_derivative_cache", &DynamicsSolver::ClearDerivativeCache)
         .def("get_position", &DynamicsSolver::GetPosition)
         .def("simulate", &DynamicsSolver::Simulate)
         .def_property_readonly("dt", &DynamicsSolver::get_dt, "dt");